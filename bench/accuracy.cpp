@@ -0,0 +1,617 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "accuracy.h"
+#include "samples.h"
+#include "scalar_backend.h"
+#include "matrix_chain.h"
+#include "plane.h"
+#include "segment.h"
+#include "sphere.h"
+#include "wide.h"
+
+/// The operations compared with 'bench::scalar', built with the backend of this build.
+namespace native {
+#include "backend_ops.h"
+}
+
+/// Distance kept from the boundaries of the classifications, far above their epsilon.
+static const double CLASSIFY_MARGIN = 1e-3;
+
+/// Double precision 4 by 4 matrix, row major like 'math::Matrix4D'.
+class ReferenceMatrix
+{
+public:
+    ReferenceMatrix()
+    {
+        for (unsigned int i = 0; i < 4; ++i) {
+            for (unsigned int j = 0; j < 4; ++j)
+                m[i][j] = (i == j)? 1.0: 0.0;
+        }
+    }
+
+    explicit ReferenceMatrix(const math::Matrix4D &matrix)
+    {
+        const float *elements = &matrix.m00;
+        for (unsigned int i = 0; i < 16; ++i)
+            m[i / 4][i % 4] = elements[i];
+    }
+
+    ReferenceMatrix operator *(const ReferenceMatrix &right) const
+    {
+        ReferenceMatrix result;
+        for (unsigned int i = 0; i < 4; ++i) {
+            for (unsigned int j = 0; j < 4; ++j) {
+                result.m[i][j] = 0.0;
+                for (unsigned int k = 0; k < 4; ++k)
+                    result.m[i][j] += m[i][k] * right.m[k][j];
+            }
+        }
+        return result;
+    }
+
+    /// Gauss-Jordan elimination with partial pivoting.
+    ReferenceMatrix Inverse(void) const
+    {
+        ReferenceMatrix a = *this, inverse;
+        for (unsigned int column = 0; column < 4; ++column) {
+            unsigned int pivot = column;
+            for (unsigned int i = column + 1; i < 4; ++i) {
+                if (fabs(a.m[i][column]) > fabs(a.m[pivot][column]))
+                    pivot = i;
+            }
+            for (unsigned int j = 0; j < 4; ++j) {
+                std::swap(a.m[column][j], a.m[pivot][j]);
+                std::swap(inverse.m[column][j], inverse.m[pivot][j]);
+            }
+
+            double scale = 1.0 / a.m[column][column];
+            for (unsigned int j = 0; j < 4; ++j) {
+                a.m[column][j] *= scale;
+                inverse.m[column][j] *= scale;
+            }
+            for (unsigned int i = 0; i < 4; ++i) {
+                double factor = a.m[i][column];
+                if (i == column || factor == 0.0)
+                    continue;
+                for (unsigned int j = 0; j < 4; ++j) {
+                    a.m[i][j] -= factor * a.m[column][j];
+                    inverse.m[i][j] -= factor * inverse.m[column][j];
+                }
+            }
+        }
+        return inverse;
+    }
+
+    /// Returns the largest absolute element.
+    double GetMagnitude(void) const
+    {
+        double magnitude = 0.0;
+        for (unsigned int i = 0; i < 16; ++i)
+            magnitude = std::max(magnitude, fabs(m[i / 4][i % 4]));
+        return magnitude;
+    }
+
+    /// Returns the largest absolute difference with @a matrix.
+    double GetDistance(const math::Matrix4D &matrix) const
+    {
+        const float *elements = &matrix.m00;
+        double distance = 0.0;
+        for (unsigned int i = 0; i < 16; ++i)
+            distance = std::max(distance, fabs(elements[i] - m[i / 4][i % 4]));
+        return distance;
+    }
+
+public:
+    double m[4][4];
+};
+
+/// Double precision quaternion.
+class ReferenceQuat
+{
+public:
+    explicit ReferenceQuat(const math::Quat &quat): s(quat.s), x(quat.x), y(quat.y), z(quat.z) {}
+
+    ReferenceQuat Normalized(void) const
+    {
+        ReferenceQuat quat = *this;
+        double length = sqrt(s * s + x * x + y * y + z * z);
+        quat.s /= length;
+        quat.x /= length;
+        quat.y /= length;
+        quat.z /= length;
+        return quat;
+    }
+
+    /// Same convention as 'math::Quat::ToMatrix4D'.
+    ReferenceMatrix ToMatrix(void) const
+    {
+        ReferenceMatrix matrix;
+        matrix.m[0][0] = 1 - 2 * y * y - 2 * z * z;
+        matrix.m[0][1] = 2 * x * y - 2 * s * z;
+        matrix.m[0][2] = 2 * x * z + 2 * s * y;
+        matrix.m[1][0] = 2 * x * y + 2 * s * z;
+        matrix.m[1][1] = 1 - 2 * x * x - 2 * z * z;
+        matrix.m[1][2] = 2 * y * z - 2 * s * x;
+        matrix.m[2][0] = 2 * x * z - 2 * s * y;
+        matrix.m[2][1] = 2 * y * z + 2 * s * x;
+        matrix.m[2][2] = 1 - 2 * x * x - 2 * y * y;
+        return matrix;
+    }
+
+    /// Returns the largest absolute difference with @a quat, q and -q are the same rotation.
+    double GetDistance(const math::Quat &quat) const
+    {
+        double same = std::max(std::max(fabs(quat.s - s), fabs(quat.x - x)),
+                               std::max(fabs(quat.y - y), fabs(quat.z - z)));
+        double opposite = std::max(std::max(fabs(quat.s + s), fabs(quat.x + x)),
+                                   std::max(fabs(quat.y + y), fabs(quat.z + z)));
+        return std::min(same, opposite);
+    }
+
+public:
+    double s, x, y, z;
+};
+
+/// Double precision vector.
+class ReferenceVector
+{
+public:
+    ReferenceVector(double _x, double _y, double _z): x(_x), y(_y), z(_z) {}
+    ReferenceVector(const math::Point3D &A, const math::Point3D &B):
+        x((double)B.x - A.x), y((double)B.y - A.y), z((double)B.z - A.z) {}
+    explicit ReferenceVector(const math::Vector3D &vec): x(vec.x), y(vec.y), z(vec.z) {}
+
+    double DotProduct(const ReferenceVector &vec) const
+    {
+        return x * vec.x + y * vec.y + z * vec.z;
+    }
+
+    ReferenceVector CrossProduct(const ReferenceVector &vec) const
+    {
+        return ReferenceVector(y * vec.z - z * vec.y, z * vec.x - x * vec.z, x * vec.y - y * vec.x);
+    }
+
+    double Length(void) const
+    {
+        return sqrt(DotProduct(*this));
+    }
+
+public:
+    double x, y, z;
+};
+
+/// Returns a random point in [-@a extent, @a extent].
+static math::Point3D RandomPoint(float extent)
+{
+    return math::Point3D(bench::Random() * extent, bench::Random() * extent, bench::Random() * extent);
+}
+
+/// Returns a random direction with a length of at least 0.1.
+static math::Vector3D RandomDirection(void)
+{
+    math::Vector3D direction;
+    do {
+        direction = math::Vector3D(bench::Random(), bench::Random(), bench::Random());
+    } while (direction.LengthSquared() < 0.01f);
+    return direction;
+}
+
+/// Products and inverses, errors relative to the operands.
+static void CheckMatrices(bench::Results &results, unsigned int samples)
+{
+    double multiply = 0.0, chain = 0.0, inverse = 0.0, affine_inverse = 0.0, rigid_inverse = 0.0;
+    for (unsigned int i = 0; i < samples; ++i) {
+        math::Matrix4D a = bench::RandomMatrix(), b = bench::RandomMatrix(), c = bench::RandomMatrix();
+        ReferenceMatrix product = ReferenceMatrix(a) * ReferenceMatrix(b);
+        math::Matrix4D result = a * b;
+
+        // Rounding is bounded by the sum of the absolute products, not by the result.
+        const float *left = &a.m00, *right = &b.m00, *elements = &result.m00;
+        for (unsigned int j = 0; j < 16; ++j) {
+            double magnitude = 0.0;
+            for (unsigned int k = 0; k < 4; ++k)
+                magnitude += fabs((double)left[(j / 4) * 4 + k] * right[k * 4 + j % 4]);
+            if (magnitude > 0.0)
+                multiply = std::max(multiply, fabs(elements[j] - product.m[j / 4][j % 4]) / magnitude);
+        }
+
+        // Evaluating a chain must give the eager product exactly.
+        math::Matrix4D eager = a * b * c, lazy = math::Chain(a) * b * c;
+        if (memcmp(&eager, &lazy, sizeof(eager)))
+            chain = std::max(chain, ReferenceMatrix(eager).GetDistance(lazy));
+
+        math::Matrix4D placement = bench::RandomPlacement();
+        ReferenceMatrix expected = ReferenceMatrix(placement).Inverse();
+        inverse = std::max(inverse, expected.GetDistance(placement.Inverse()) / expected.GetMagnitude());
+        affine_inverse = std::max(affine_inverse, expected.GetDistance(placement.AffineInverse()) / expected.GetMagnitude());
+
+        math::Matrix4D rigid = math::Transform(math::Vector3D(bench::Random(-10.f, 10.f), bench::Random(-10.f, 10.f),
+                                                              bench::Random(-10.f, 10.f)),
+                                               bench::RandomRotation(), math::Vector3D(1.f, 1.f, 1.f)).ToMatrix4D();
+        expected = ReferenceMatrix(rigid).Inverse();
+        rigid_inverse = std::max(rigid_inverse, expected.GetDistance(rigid.RigidInverse()) / expected.GetMagnitude());
+    }
+
+    results.AddAccuracy("Matrix4D * Matrix4D", samples, multiply, 2.0 * FLT_EPSILON);
+    results.AddAccuracy("Chain(a) * b * c == a * b * c", samples, chain, 0.0);
+    results.AddAccuracy("Matrix4D::Inverse", samples, inverse, 16.0 * FLT_EPSILON);
+    results.AddAccuracy("Matrix4D::AffineInverse", samples, affine_inverse, 16.0 * FLT_EPSILON);
+    results.AddAccuracy("Matrix4D::RigidInverse", samples, rigid_inverse, 32.0 * FLT_EPSILON);
+}
+
+/// Rotations, absolute errors on elements of magnitude 1.
+static void CheckRotations(bench::Results &results, unsigned int samples)
+{
+    double axis_angle = 0.0, to_quaternion = 0.0, to_matrix = 0.0;
+    for (unsigned int i = 0; i < samples; ++i) {
+        // The axis is normalized by 'AxisAngle', the reference normalizes it in double.
+        math::Vector3D axis = RandomDirection();
+        float degrees = bench::Random(-180.f, 180.f);
+        ReferenceVector w(axis);
+        double length = w.Length(), radians = degrees / 180.0 * 3.14159265358979323846;
+        w = ReferenceVector(w.x / length, w.y / length, w.z / length);
+
+        // I + S sin + S^2 (1 - cos), S the cross product matrix of the axis.
+        double S[3][3] = { { 0.0, -w.z, w.y }, { w.z, 0.0, -w.x }, { -w.y, w.x, 0.0 } };
+        ReferenceMatrix expected;
+        for (unsigned int r = 0; r < 3; ++r) {
+            for (unsigned int c = 0; c < 3; ++c) {
+                double square = 0.0;
+                for (unsigned int k = 0; k < 3; ++k)
+                    square += S[r][k] * S[k][c];
+                expected.m[r][c] += S[r][c] * sin(radians) + square * (1.0 - cos(radians));
+            }
+        }
+        axis_angle = std::max(axis_angle, expected.GetDistance(math::Matrix4D::AxisAngle(axis, degrees)));
+
+        // 'ToQuaternion' reads the transpose of what 'ToMatrix4D' writes.
+        math::Quat quat = bench::RandomRotation();
+        ReferenceQuat reference = ReferenceQuat(quat).Normalized();
+        ReferenceMatrix rotation = reference.ToMatrix();
+        math::Matrix4D transposed;
+        float *elements = &transposed.m00;
+        for (unsigned int j = 0; j < 16; ++j)
+            elements[j] = (float)rotation.m[j % 4][j / 4];
+        to_quaternion = std::max(to_quaternion, reference.GetDistance(math::Quat::ToQuaternion(transposed)));
+
+        // The float quaternion as given, only the conversion is measured.
+        to_matrix = std::max(to_matrix, ReferenceQuat(quat).ToMatrix().GetDistance(quat.ToMatrix4D()));
+    }
+
+    results.AddAccuracy("Matrix4D::AxisAngle", samples, axis_angle, 16.0 * FLT_EPSILON);
+    results.AddAccuracy("Quat::ToQuaternion(Matrix4D)", samples, to_quaternion, 8.0 * FLT_EPSILON);
+    results.AddAccuracy("Quat::ToMatrix4D", samples, to_matrix, 4.0 * FLT_EPSILON);
+}
+
+/// Lengths and normalization, relative errors.
+static void CheckVectors(bench::Results &results, unsigned int samples)
+{
+    double normalize = 0.0, normalize_fast = 0.0, length_fast = 0.0;
+    for (unsigned int i = 0; i < samples; ++i) {
+        // Lengths over 6 orders of magnitude.
+        math::Vector3D vec = powf(10.f, bench::Random(-3.f, 3.f)) * RandomDirection();
+        ReferenceVector reference(vec);
+        double length = reference.Length();
+
+        math::Vector3D precise = vec, fast = vec;
+        precise.Normalize(math::PRECISE);
+        fast.Normalize(math::FAST);
+        for (unsigned int k = 0; k < 3; ++k) {
+            double expected = (&reference.x)[k] / length;
+            normalize = std::max(normalize, fabs((&precise.x)[k] - expected));
+            normalize_fast = std::max(normalize_fast, fabs((&fast.x)[k] - expected));
+        }
+        length_fast = std::max(length_fast, fabs(vec.Length(math::FAST) - length) / length);
+    }
+
+    results.AddAccuracy("Vector3D::Normalize(PRECISE)", samples, normalize, 2.0 * FLT_EPSILON);
+    results.AddAccuracy("Vector3D::Normalize(FAST)", samples, normalize_fast, 1.0 / (1 << 20));
+    results.AddAccuracy("Vector3D::Length(FAST)", samples, length_fast, 1.0 / (1 << 20));
+}
+
+/// Plane and sphere classifications, the errors are the number of wrong answers.
+static void CheckPlanesAndSpheres(bench::Results &results, unsigned int samples)
+{
+    unsigned int plane_tested = 0, plane_wrong = 0, point_tested = 0, point_wrong = 0;
+    unsigned int sphere_tested = 0, sphere_wrong = 0, line_tested = 0, line_wrong = 0;
+    double line_points = 0.0;
+    for (unsigned int i = 0; i < samples; ++i) {
+        math::Point3D pt = RandomPoint(2.f);
+
+        math::Plane plane(RandomPoint(1.f), RandomDirection());
+        ReferenceVector normal(plane.normal);
+        double distance = ReferenceVector(plane.position, pt).DotProduct(normal) / normal.Length();
+        if (fabs(distance) > CLASSIFY_MARGIN) {
+            ++plane_tested;
+            plane_wrong += plane.ClassifyToPlane(pt) != ((distance > 0.0)? math::FRONT: math::BACK);
+        }
+
+        math::Sphere sphere(RandomPoint(1.f), bench::Random(0.1f, 1.f));
+        distance = ReferenceVector(sphere.center, pt).Length();
+        if (fabs(distance - sphere.radius) > CLASSIFY_MARGIN) {
+            ++point_tested;
+            point_wrong += sphere.ClassifyToSphere(pt) != ((distance < sphere.radius)? math::INSIDE: math::OUTSIDE);
+        }
+
+        // In the order the spheres are tested, containment is reported as INTERSECT.
+        math::Sphere other(RandomPoint(1.f), bench::Random(0.1f, 1.f));
+        distance = ReferenceVector(sphere.center, other.center).Length();
+        double radii = (double)sphere.radius + other.radius, difference = fabs((double)sphere.radius - other.radius);
+        if (fabs(distance - radii) > CLASSIFY_MARGIN && fabs(distance - difference) > CLASSIFY_MARGIN) {
+            ++sphere_tested;
+            sphere_wrong += sphere.ClassifyToSphere(other) != ((distance < radii)? math::INTERSECT: math::DISJOINT);
+        }
+
+        // Distance from the center to the line, and the intersection points must be on the sphere.
+        math::Line3D line(RandomPoint(2.f), RandomDirection());
+        ReferenceVector direction(line.direction);
+        distance = ReferenceVector(line.position, sphere.center).CrossProduct(direction).Length() / direction.Length();
+        if (fabs(distance - sphere.radius) > CLASSIFY_MARGIN) {
+            math::Point3D p0, p1;
+            math::Classify classify = sphere.ClassifyToSphere(line, p0, p1);
+            ++line_tested;
+            line_wrong += classify != ((distance < sphere.radius)? math::INTERSECT: math::NOINTERSECT);
+            if (classify == math::INTERSECT) {
+                line_points = std::max(line_points, fabs(ReferenceVector(sphere.center, p0).Length() - sphere.radius));
+                line_points = std::max(line_points, fabs(ReferenceVector(sphere.center, p1).Length() - sphere.radius));
+            }
+        }
+    }
+
+    results.AddAccuracy("Plane::ClassifyToPlane(pt) wrong", plane_tested, plane_wrong, 0.0);
+    results.AddAccuracy("Sphere::ClassifyToSphere(pt) wrong", point_tested, point_wrong, 0.0);
+    results.AddAccuracy("Sphere::ClassifyToSphere(sphere) wrong", sphere_tested, sphere_wrong, 0.0);
+    results.AddAccuracy("Sphere::ClassifyToSphere(line) wrong", line_tested, line_wrong, 0.0);
+    // Close to tangency the roots of the quadratic lose digits.
+    results.AddAccuracy("Sphere::ClassifyToSphere(line) points", line_tested, line_points, 256.0 * FLT_EPSILON);
+}
+
+/// Segment classifications and intersections.
+static void CheckSegments(bench::Results &results, unsigned int samples)
+{
+    unsigned int classify_tested = 0, classify_wrong = 0, intersect_tested = 0, intersect_missed = 0;
+    double intersect_points = 0.0;
+    for (unsigned int i = 0; i < samples; ++i) {
+        // Segments in a plane of constant z are exactly coplanar.
+        float z = bench::Random();
+        math::LineSegment3D AB(math::Point3D(bench::Random(), bench::Random(), z),
+                               math::Point3D(bench::Random(), bench::Random(), z));
+        math::LineSegment3D CD(math::Point3D(bench::Random(), bench::Random(), z),
+                               math::Point3D(bench::Random(), bench::Random(), z));
+        ReferenceVector ab(AB.pointA, AB.pointB), cd(CD.pointA, CD.pointB);
+        if (ab.CrossProduct(cd).Length() > 0.1) {
+            ++classify_tested;
+            classify_wrong += AB.ClassifyToLineSegment(CD) != math::COPLANAR;
+        }
+
+        // Parallel: on a grid of 1/1024 the end points and the doubled direction are exact.
+        math::Vector3D direction = RandomDirection();
+        math::Point3D A = RandomPoint(1.f), C = RandomPoint(1.f);
+        for (unsigned int k = 0; k < 3; ++k) {
+            (&direction.x)[k] = floorf((&direction.x)[k] * 1024.f) / 1024.f;
+            (&A.x)[k] = floorf((&A.x)[k] * 1024.f) / 1024.f;
+            (&C.x)[k] = floorf((&C.x)[k] * 1024.f) / 1024.f;
+        }
+        ReferenceVector ac(A, C), d(direction);
+        if (ac.CrossProduct(d).Length() / d.Length() > CLASSIFY_MARGIN) {
+            ++classify_tested;
+            classify_wrong += math::LineSegment3D(A, A + direction).ClassifyToLineSegment(
+                math::LineSegment3D(C, C + 2.f * direction)) != math::PARALLEL;
+        }
+
+        // Skew: the lines are far apart and far from parallel.
+        math::LineSegment3D EF(RandomPoint(1.f), RandomPoint(1.f)), GH(RandomPoint(1.f), RandomPoint(1.f));
+        ReferenceVector normal = ReferenceVector(EF.pointA, EF.pointB).CrossProduct(ReferenceVector(GH.pointA, GH.pointB));
+        double distance = fabs(ReferenceVector(EF.pointA, GH.pointA).DotProduct(normal)) / normal.Length();
+        if (normal.Length() > 0.1 && distance > 0.01) {
+            ++classify_tested;
+            classify_wrong += EF.ClassifyToLineSegment(GH) != math::DISJOINT;
+        }
+
+        // Crossing segments, the times are measured along x and need some extent on it.
+        if (fabs(ab.x) < 0.1 || fabs(cd.x) < 0.1 || ab.CrossProduct(cd).Length() < 0.1)
+            continue;
+        double denominator = ab.x * cd.y - ab.y * cd.x;
+        double t = (((double)CD.pointA.x - AB.pointA.x) * cd.y - ((double)CD.pointA.y - AB.pointA.y) * cd.x) / denominator;
+        double u = (((double)CD.pointA.x - AB.pointA.x) * ab.y - ((double)CD.pointA.y - AB.pointA.y) * ab.x) / denominator;
+        if (t < 0.01 || t > 0.99 || u < 0.01 || u > 0.99)
+            continue;
+
+        math::Point3D point;
+        ++intersect_tested;
+        if (!AB.IntersectLineSegmentAt(CD, point)) {
+            ++intersect_missed;
+            continue;
+        }
+        ReferenceVector error(point.x - (AB.pointA.x + t * ab.x), point.y - (AB.pointA.y + t * ab.y), point.z - z);
+        intersect_points = std::max(intersect_points, error.Length());
+    }
+
+    results.AddAccuracy("LineSegment3D::ClassifyToLineSegment wrong", classify_tested, classify_wrong, 0.0);
+    results.AddAccuracy("LineSegment3D::IntersectLineSegmentAt missed", intersect_tested, intersect_missed, 0.0);
+    results.AddAccuracy("LineSegment3D::IntersectLineSegmentAt points", intersect_tested, intersect_points, 1e-5);
+}
+
+/// Returns the number of the @a count floats of @a a and @a b that differ, bit wise.
+static unsigned int CountDifferences(const float *a, const float *b, unsigned int count)
+{
+    unsigned int differences = 0;
+    for (unsigned int i = 0; i < count; ++i)
+        differences += memcmp(&a[i], &b[i], sizeof(float)) != 0;
+    return differences;
+}
+
+/**
+ * @brief The backend of this build against the portable one, the errors are the number of results
+ * that differ: the backends must agree bit for bit (see 'math::simd').
+ */
+static void CheckBackends(bench::Results &results, unsigned int samples)
+{
+    unsigned int vector_wrong = 0, quat_wrong = 0, matrix_wrong = 0;
+    for (unsigned int i = 0; i < samples; ++i) {
+        float a[16], b[16], t = bench::Random(0.f, 1.f);
+        for (unsigned int k = 0; k < 4; ++k) {
+            a[k] = bench::Random(-100.f, 100.f);
+            b[k] = bench::Random(-100.f, 100.f);
+        }
+        float native_results[BACKEND_VECTOR_RESULTS], scalar_results[BACKEND_VECTOR_RESULTS];
+        native::VectorOperations(a, b, native_results);
+        bench::scalar::VectorOperations(a, b, scalar_results);
+        vector_wrong += CountDifferences(native_results, scalar_results, BACKEND_VECTOR_RESULTS);
+
+        // Unit quaternions for the interpolations, with some rounding left in.
+        math::Quat p = bench::RandomRotation(), q = bench::RandomRotation();
+        memcpy(a, &p.s, sizeof(float) * 4);
+        memcpy(b, &q.s, sizeof(float) * 4);
+        float native_quat[BACKEND_QUAT_RESULTS], scalar_quat[BACKEND_QUAT_RESULTS];
+        native::QuatOperations(a, b, t, native_quat);
+        bench::scalar::QuatOperations(a, b, t, scalar_quat);
+        quat_wrong += CountDifferences(native_quat, scalar_quat, BACKEND_QUAT_RESULTS);
+
+        math::Matrix4D m = bench::RandomPlacement(), n = bench::RandomMatrix();
+        memcpy(a, &m.m00, sizeof(float) * 16);
+        memcpy(b, &n.m00, sizeof(float) * 16);
+        float native_matrix[BACKEND_MATRIX_RESULTS], scalar_matrix[BACKEND_MATRIX_RESULTS];
+        native::MatrixOperations(a, b, native_matrix);
+        bench::scalar::MatrixOperations(a, b, scalar_matrix);
+        matrix_wrong += CountDifferences(native_matrix, scalar_matrix, BACKEND_MATRIX_RESULTS);
+    }
+
+    results.AddAccuracy("Vector3D " MATH_SIMD_BACKEND " != scalar", samples * BACKEND_VECTOR_RESULTS, vector_wrong, 0.0);
+    results.AddAccuracy("Quat " MATH_SIMD_BACKEND " != scalar", samples * BACKEND_QUAT_RESULTS, quat_wrong, 0.0);
+    results.AddAccuracy("Matrix4D " MATH_SIMD_BACKEND " != scalar", samples * BACKEND_MATRIX_RESULTS, matrix_wrong, 0.0);
+}
+
+/**
+ * @brief Each lane of the wide types against the scalar operation on the same inputs, the errors
+ * are the number of results that differ: the lanes must round like the scalar code.
+ */
+template <int N>
+static void CheckWideLanes(bench::Results &results, unsigned int samples)
+{
+    unsigned int vector_tested = 0, vector_wrong = 0, matrix_tested = 0, matrix_wrong = 0;
+    unsigned int quat_tested = 0, quat_wrong = 0, float_tested = 0, float_wrong = 0;
+    for (unsigned int i = 0; i < samples; i += N) {
+        math::Vector3D u[N], v[N];
+        math::Matrix4D a[N], b[N];
+        math::Quat p[N], q[N];
+        float f[N], g[N];
+        for (int k = 0; k < N; ++k) {
+            u[k] = math::Vector3D(bench::Random(-100.f, 100.f), bench::Random(-100.f, 100.f), bench::Random(-100.f, 100.f));
+            v[k] = math::Vector3D(bench::Random(-100.f, 100.f), bench::Random(-100.f, 100.f), bench::Random(-100.f, 100.f));
+            a[k] = bench::RandomPlacement();
+            b[k] = bench::RandomMatrix();
+            p[k] = bench::RandomRotation();
+            q[k] = bench::RandomRotation();
+            f[k] = bench::Random(-100.f, 100.f);
+            // Some equal lanes for the comparisons.
+            g[k] = (k % 3)? bench::Random(-100.f, 100.f): f[k];
+        }
+
+        float u_values[N * 3], v_values[N * 3];
+        for (int k = 0; k < N; ++k) {
+            memcpy(&u_values[k * 3], &u[k].x, sizeof(float) * 3);
+            memcpy(&v_values[k * 3], &v[k].x, sizeof(float) * 3);
+        }
+        math::Vec3xN<N> wide_u = math::Vec3xN<N>::LoadAoS(u_values, 3), wide_v = math::Vec3xN<N>::LoadAoS(v_values, 3);
+        math::Mat4xN<N> wide_a = math::Mat4xN<N>::LoadAoS(a), wide_b = math::Mat4xN<N>::LoadAoS(b);
+        math::QuatxN<N> wide_p = math::QuatxN<N>::LoadAoS(p), wide_q = math::QuatxN<N>::LoadAoS(q);
+        math::FloatxN<N> wide_f = math::FloatxN<N>::Load(f), wide_g = math::FloatxN<N>::Load(g);
+
+        math::Vec3xN<N> vectors[] = { wide_u + wide_v, wide_u - wide_v, wide_u * wide_f, wide_u.CrossProduct(wide_v),
+                                      wide_a.TransformPoint(wide_u), wide_a.TransformVector(wide_u) };
+        math::FloatxN<N> dot = wide_u.DotProduct(wide_v), length = wide_u.Length();
+        math::Vec3xN<N> normalized = wide_u;
+        normalized.Normalize();
+        math::Mat4xN<N> product = wide_a * wide_b, transposed = wide_a.Transpose();
+        math::QuatxN<N> quats[] = { wide_p * wide_q, wide_p + wide_q, wide_p.Conjugate(), wide_p.Inverse() };
+        math::FloatxN<N> quat_dot = wide_p.DotProduct(wide_q);
+        math::FloatxN<N> floats[] = { math::FloatxN<N>::Min(wide_f, wide_g), math::FloatxN<N>::Max(wide_f, wide_g),
+                                      math::FloatxN<N>::Select(wide_f < wide_g, wide_f, wide_g) };
+        unsigned int less = (wide_f < wide_g).GetBits(), less_equal = (wide_f <= wide_g).GetBits();
+        unsigned int equal = (wide_f == wide_g).GetBits();
+
+        float sum = f[0], minimum = f[0], maximum = f[0];
+        for (int k = 0; k < N; ++k) {
+            math::Point3D point = a[k] * math::Point3D(u[k].x, u[k].y, u[k].z);
+            math::Vector3D direction = a[k] * u[k];
+            math::Vector3D expected_vectors[] = { u[k] + v[k], u[k] - v[k], u[k] * f[k], u[k].CrossProduct(v[k]),
+                                                  math::Vector3D(point.x, point.y, point.z), direction };
+            for (unsigned int j = 0; j < sizeof(vectors) / sizeof(vectors[0]); ++j) {
+                math::Vector3D lane = vectors[j].GetLane(k);
+                vector_wrong += CountDifferences(&lane.x, &expected_vectors[j].x, 3);
+                vector_tested += 3;
+            }
+            float dot_lane = dot.GetLane(k), length_lane = length.GetLane(k);
+            float expected_dot = u[k].DotProduct(v[k]), expected_length = u[k].Length(math::PRECISE);
+            vector_wrong += CountDifferences(&dot_lane, &expected_dot, 1) + CountDifferences(&length_lane, &expected_length, 1);
+            math::Vector3D expected_normalized = u[k], normalized_lane = normalized.GetLane(k);
+            expected_normalized.Normalize(math::PRECISE);
+            vector_wrong += CountDifferences(&normalized_lane.x, &expected_normalized.x, 3);
+            vector_tested += 5;
+
+            math::Matrix4D expected_product = a[k] * b[k], expected_transposed = a[k].Transpose();
+            math::Matrix4D product_lane = product.GetLane(k), transposed_lane = transposed.GetLane(k);
+            matrix_wrong += CountDifferences(&product_lane.m00, &expected_product.m00, 16) +
+                            CountDifferences(&transposed_lane.m00, &expected_transposed.m00, 16);
+            matrix_tested += 32;
+
+            math::Quat expected_quats[] = { p[k] * q[k], p[k] + q[k], p[k].Conjugate(), p[k].Inverse() };
+            for (unsigned int j = 0; j < sizeof(quats) / sizeof(quats[0]); ++j) {
+                math::Quat lane = quats[j].GetLane(k);
+                quat_wrong += CountDifferences(&lane.s, &expected_quats[j].s, 4);
+                quat_tested += 4;
+            }
+            float quat_dot_lane = quat_dot.GetLane(k), expected_quat_dot = p[k].DotProduct(q[k]);
+            quat_wrong += CountDifferences(&quat_dot_lane, &expected_quat_dot, 1);
+            quat_tested += 1;
+
+            float expected_floats[] = { (f[k] < g[k])? f[k]: g[k], (f[k] > g[k])? f[k]: g[k], (f[k] < g[k])? f[k]: g[k] };
+            for (unsigned int j = 0; j < sizeof(floats) / sizeof(floats[0]); ++j) {
+                float lane = floats[j].GetLane(k);
+                float_wrong += CountDifferences(&lane, &expected_floats[j], 1);
+            }
+            float_wrong += (((less >> k) & 1) != (f[k] < g[k])) + (((less_equal >> k) & 1) != (f[k] <= g[k])) +
+                           (((equal >> k) & 1) != (f[k] == g[k]));
+            float_tested += 6;
+
+            if (k) {
+                sum += f[k];
+                minimum = (f[k] < minimum)? f[k]: minimum;
+                maximum = (f[k] > maximum)? f[k]: maximum;
+            }
+        }
+        float reductions[] = { wide_f.ReduceAdd(), wide_f.ReduceMin(), wide_f.ReduceMax() }, expected_reductions[] = { sum, minimum, maximum };
+        float_wrong += CountDifferences(reductions, expected_reductions, 3);
+        float_tested += 3;
+    }
+
+    char name[64];
+    sprintf(name, "Vec3xN<%d> lanes != Vector3D", N);
+    results.AddAccuracy(name, vector_tested, vector_wrong, 0.0);
+    sprintf(name, "Mat4xN<%d> lanes != Matrix4D", N);
+    results.AddAccuracy(name, matrix_tested, matrix_wrong, 0.0);
+    sprintf(name, "QuatxN<%d> lanes != Quat", N);
+    results.AddAccuracy(name, quat_tested, quat_wrong, 0.0);
+    sprintf(name, "FloatxN<%d> lanes != float", N);
+    results.AddAccuracy(name, float_tested, float_wrong, 0.0);
+}
+
+void bench::CheckAccuracy(Results &results, unsigned int samples)
+{
+    CheckMatrices(results, samples);
+    CheckRotations(results, samples);
+    CheckVectors(results, samples);
+    CheckPlanesAndSpheres(results, samples);
+    CheckSegments(results, samples);
+    CheckBackends(results, samples);
+    // The SSE and AVX specializations, or the portable loops, and the widest of the target.
+    CheckWideLanes<4>(results, samples);
+    CheckWideLanes<8>(results, samples);
+#if MATH_WIDE_LANES > 8
+    CheckWideLanes<MATH_WIDE_LANES>(results, samples);
+#endif
+}
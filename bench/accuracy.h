@@ -0,0 +1,22 @@
+/**
+ * @file accuracy.h
+ * @brief Accuracy of the math library against double precision references.
+ */
+#ifndef ACCURACY_H_INCLUDED
+#define ACCURACY_H_INCLUDED
+
+#include "results.h"
+
+namespace bench {
+
+    /**
+     * @brief Runs every accuracy check on @a samples random inputs and adds them to @a results.
+     * @remarks The errors are absolute on results of magnitude 1 (rotations, unit vectors), and
+     * relative to the magnitude of the operands otherwise. The classifications are checked away
+     * from their epsilon bands, where the answer is not a matter of rounding: any disagreement
+     * with the reference is an error.
+     */
+    void CheckAccuracy(Results &results, unsigned int samples);
+}
+
+#endif // ACCURACY_H_INCLUDED
@@ -0,0 +1,70 @@
+/**
+ * @file backend_ops.h
+ * @brief Math operations compared across SIMD backends.
+ * @remarks Read once per backend, in a namespace of its own (see scalar_backend.cpp and
+ * accuracy.cpp), hence no include guard. The declarations and the result counts are in
+ * scalar_backend.h.
+ */
+
+/// Copies the @a count floats at @a values to @a results, returns the end of the copy.
+static float *WriteResults(float *results, const float *values, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+        results[i] = values[i];
+    return results + count;
+}
+
+static float *WriteResults(float *results, const math::Vector3D &vec)
+{
+    return WriteResults(results, &vec.x, 3);
+}
+
+static float *WriteResults(float *results, const math::Quat &quat)
+{
+    return WriteResults(results, &quat.s, 4);
+}
+
+static float *WriteResults(float *results, const math::Matrix4D &matrix)
+{
+    return WriteResults(results, &matrix.m00, 16);
+}
+
+/// Sum, difference, scale, cross product, dot product, length and normalization.
+void VectorOperations(const float *a, const float *b, float *results)
+{
+    math::Vector3D u(a[0], a[1], a[2]), v(b[0], b[1], b[2]);
+    results = WriteResults(results, u + v);
+    results = WriteResults(results, u - v);
+    results = WriteResults(results, u * b[3]);
+    results = WriteResults(results, u.CrossProduct(v));
+    *results++ = u.DotProduct(v);
+    *results++ = u.Length(math::PRECISE);
+    u.Normalize(math::PRECISE);
+    WriteResults(results, u);
+}
+
+/// Product, normalization, interpolations, conversion to a matrix and rotation of a vector.
+void QuatOperations(const float *a, const float *b, float t, float *results)
+{
+    math::Quat p(a[0], a[1], a[2], a[3]), q(b[0], b[1], b[2], b[3]);
+    results = WriteResults(results, p * q);
+    results = WriteResults(results, p.Normalized());
+    results = WriteResults(results, math::Quat::Nlerp(p, q, t));
+    results = WriteResults(results, math::Quat::Slerp(p, q, t));
+    results = WriteResults(results, p.ToMatrix4D());
+    WriteResults(results, p.Rotate(math::Vector3D(b[1], b[2], b[3])));
+}
+
+/// Product, inverses, determinant and transformation of a point.
+void MatrixOperations(const float *a, const float *b, float *results)
+{
+    math::Matrix4D m, n;
+    WriteResults(&m.m00, a, 16);
+    WriteResults(&n.m00, b, 16);
+    results = WriteResults(results, m * n);
+    results = WriteResults(results, m.Inverse());
+    results = WriteResults(results, m.AffineInverse());
+    *results++ = m.determinant();
+    math::Point3D point = m * math::Point3D(b[0], b[1], b[2]);
+    WriteResults(results, &point.x, 4);
+}
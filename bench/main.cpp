@@ -0,0 +1,400 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "accuracy.h"
+#include "results.h"
+#include "samples.h"
+#include "matrix_chain.h"
+#include "mesh_codec.h"
+#include "plane.h"
+#include "segment.h"
+#include "sphere.h"
+#include "transform_batch.h"
+#include "wide.h"
+
+// Constant transformations are folded by the compiler, nothing is left to run.
+static constexpr math::Matrix4D PLACEMENT = math::Matrix4D::Translation(0.f, 0.f, -300.f);
+static constexpr math::Matrix4D GRID_SCALE = math::Matrix4D::Scale(10.f, 1.f, 10.f);
+static_assert(PLACEMENT.m23 == -300.f && GRID_SCALE.m00 == 10.f, "constant matrices are built at compile time");
+
+/// Inputs the timings cycle through, unknown to the compiler and small enough to stay in cache.
+static const unsigned int SAMPLE_COUNT = 1024;
+
+/// Keeps the optimizer from dropping the benchmarked work.
+static volatile float sink;
+
+/// Runs @a body on the samples @a rounds times, returns nanoseconds per call.
+template <class Body>
+static double Measure(unsigned int rounds, Body body)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    for (unsigned int r = 0; r < rounds; ++r) {
+        for (unsigned int i = 0; i < SAMPLE_COUNT; ++i)
+            body(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double)rounds * SAMPLE_COUNT);
+}
+
+/// Calls @a body @a calls times, returns nanoseconds per call.
+template <class Body>
+static double MeasureCalls(unsigned int calls, Body body)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    for (unsigned int i = 0; i < calls; ++i)
+        body();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+}
+
+/**
+ * @brief Times decoding a compressed height field of 256x256 vertices, against copying the
+ * decoded data.
+ * @remarks The triangles are emitted row by row, the order of a cache optimized index buffer.
+ */
+static void MeasureMeshCodec(bench::Results &results, unsigned int rounds)
+{
+    const unsigned int side = 256;
+    core::Mesh mesh;
+    mesh.Allocate(side * side, 1, (side - 1) * (side - 1) * 6, false);
+    for (unsigned int y = 0; y < side; ++y) {
+        for (unsigned int x = 0; x < side; ++x) {
+            unsigned int v = y * side + x;
+            float height = sinf(x * 0.1f) * cosf(y * 0.07f) * 20.f + bench::Random();
+            float position[4] = { x * 10.f, height, y * 10.f, 1.f };
+            float normal[3] = { -cosf(x * 0.1f) * 0.2f, 1.f, sinf(y * 0.07f) * 0.14f };
+            float uv[3] = { x / (float)side, y / (float)side, 0.f };
+            memcpy(mesh.vertices + v * 4, position, sizeof(position));
+            memcpy(mesh.normals + v * 3, normal, sizeof(normal));
+            memcpy(mesh.tangents[0] + v * 3, normal, sizeof(normal));
+            memcpy(mesh.binormals[0] + v * 3, normal, sizeof(normal));
+            memcpy(mesh.uv_coordinates[0] + v * 3, uv, sizeof(uv));
+        }
+    }
+    unsigned short *index = mesh.index_array;
+    for (unsigned int y = 0; y + 1 < side; ++y) {
+        for (unsigned int x = 0; x + 1 < side; ++x) {
+            unsigned short v = (unsigned short)(y * side + x);
+            unsigned short quad[6] = { v, (unsigned short)(v + side), (unsigned short)(v + 1),
+                                       (unsigned short)(v + 1), (unsigned short)(v + side), (unsigned short)(v + side + 1) };
+            memcpy(index, quad, sizeof(quad));
+            index += 6;
+        }
+    }
+
+    unsigned int vertex_count = mesh.vertex_number, index_count = mesh.index_array_size;
+    std::vector<unsigned char> indices(core::MeshCodec::GetIndexBufferBound(index_count));
+    indices.resize(core::MeshCodec::EncodeIndexBuffer(&indices[0], indices.size(), mesh.index_array, index_count));
+    std::vector<unsigned char> vertices(core::MeshCodec::GetVertexBufferBound(vertex_count, 16));
+    vertices.resize(core::MeshCodec::EncodeVertexBuffer(&vertices[0], vertices.size(), mesh.vertices, vertex_count, 16));
+
+    std::vector<unsigned short> decoded_indices(index_count);
+    std::vector<float> decoded_vertices(vertex_count * 4);
+    double index_bytes = index_count * sizeof(unsigned short), vertex_bytes = vertex_count * 16.0;
+    char name[64];
+    unsigned int calls = rounds / 20 + 1;
+
+    results.AddTiming("index decode", "memcpy", MeasureCalls(calls, [&]() {
+        memcpy(&decoded_indices[0], mesh.index_array, (size_t)index_bytes);
+        sink = decoded_indices[calls % index_count];
+    }), index_bytes);
+    sprintf(name, "DecodeIndexBuffer (%.2f bytes/index)", indices.size() / (double)index_count);
+    results.AddTiming("index decode", name, MeasureCalls(calls, [&]() {
+        core::MeshCodec::DecodeIndexBuffer(&decoded_indices[0], index_count, &indices[0], indices.size());
+        sink = decoded_indices[calls % index_count];
+    }), index_bytes);
+
+    results.AddTiming("vertex decode", "memcpy", MeasureCalls(calls, [&]() {
+        memcpy(&decoded_vertices[0], mesh.vertices, (size_t)vertex_bytes);
+        sink = decoded_vertices[calls % vertex_count];
+    }), vertex_bytes);
+    sprintf(name, "DecodeVertexBuffer (%.1f%% of the size)", 100.0 * vertices.size() / vertex_bytes);
+    results.AddTiming("vertex decode", name, MeasureCalls(calls, [&]() {
+        core::MeshCodec::DecodeVertexBuffer(&decoded_vertices[0], vertex_count, 16, &vertices[0], vertices.size());
+        sink = decoded_vertices[calls % vertex_count];
+    }), vertex_bytes);
+
+    // Every array of the mesh, as 'Mesh::EnsureResident' gets them from a cold mesh.
+    double mesh_bytes = (double)mesh.GetGeometry()->GetSize();
+    results.AddTiming("mesh decode", "GeometryBuffer::Clone", MeasureCalls(calls, [&]() {
+        core::GeometryBuffer *buffer = mesh.GetGeometry()->Clone();
+        sink = (float)buffer->GetData()[calls % buffer->GetSize()];
+        buffer->Release();
+    }), mesh_bytes);
+    core::CompressedPayloadSource *source = new core::CompressedPayloadSource();
+    core::MeshCodec::CompressToSource(mesh, *source);
+    source->Release();
+    sprintf(name, "CompressedPayloadSource (%.1f%%)", 100.0 * source->GetCompressedSize() / mesh_bytes);
+    results.AddTiming("mesh decode", name, MeasureCalls(calls, [&]() {
+        core::Mesh cold(mesh);
+        cold.EnsureResident();
+        sink = cold.vertices[calls % vertex_count];
+    }), mesh_bytes);
+}
+
+/// Times the hot operations of the math library, each group against its first line.
+static void MeasureTimings(bench::Results &results, unsigned int rounds)
+{
+    std::vector<math::Matrix4D> a(SAMPLE_COUNT), b(SAMPLE_COUNT), c(SAMPLE_COUNT), placements(SAMPLE_COUNT);
+    std::vector<math::Vector3D> v(SAMPLE_COUNT);
+    std::vector<math::Quat> rotations(SAMPLE_COUNT);
+    std::vector<math::Transform> parents(SAMPLE_COUNT), children(SAMPLE_COUNT), poses(SAMPLE_COUNT);
+    std::vector<math::Matrix4D> parent_matrices(SAMPLE_COUNT), child_matrices(SAMPLE_COUNT);
+    std::vector<math::Point3D> points(SAMPLE_COUNT);
+    std::vector<math::Sphere> spheres(SAMPLE_COUNT);
+    std::vector<math::Plane> planes(SAMPLE_COUNT);
+    std::vector<math::Line3D> lines(SAMPLE_COUNT);
+    std::vector<math::LineSegment3D> segments(SAMPLE_COUNT);
+    std::vector<float> angles(SAMPLE_COUNT), normals(SAMPLE_COUNT * 3), transformed_normals(SAMPLE_COUNT * 3);
+    for (unsigned int i = 0; i < SAMPLE_COUNT; ++i) {
+        a[i] = bench::RandomMatrix();
+        b[i] = bench::RandomMatrix();
+        c[i] = bench::RandomMatrix();
+        placements[i] = bench::RandomPlacement();
+        v[i] = math::Vector3D(bench::Random(), bench::Random(), bench::Random());
+        rotations[i] = bench::RandomRotation();
+        angles[i] = bench::Random(-180.f, 180.f);
+        parents[i] = bench::RandomTransform();
+        children[i] = bench::RandomTransform();
+        parent_matrices[i] = parents[i].ToMatrix4D();
+        child_matrices[i] = children[i].ToMatrix4D();
+        points[i] = math::Point3D(bench::Random(), bench::Random(), bench::Random());
+        spheres[i] = math::Sphere(math::Point3D(bench::Random(), bench::Random(), bench::Random()), bench::Random() + 1.f);
+        planes[i] = math::Plane(math::Point3D(bench::Random(), bench::Random(), bench::Random()),
+                                math::Vector3D(bench::Random(), bench::Random(), bench::Random()));
+        lines[i] = math::Line3D(points[i], v[i]);
+        // Every other pair of segments lies in the plane z = 0 and is coplanar, the others are skew.
+        bool coplanar = (i / 2) % 2 == 0;
+        segments[i] = math::LineSegment3D(math::Point3D(bench::Random(), bench::Random(), coplanar? 0.f: bench::Random()),
+                                          math::Point3D(bench::Random(), bench::Random(), coplanar? 0.f: bench::Random()));
+        for (unsigned int j = 0; j < 3; ++j)
+            normals[i * 3 + j] = bench::Random();
+    }
+    std::vector<math::Matrix4D> rotation_matrices(SAMPLE_COUNT);
+    for (unsigned int i = 0; i < SAMPLE_COUNT; ++i)
+        rotation_matrices[i] = rotations[i].ToMatrix4D().Transpose();
+
+    results.AddTiming("products", "a * b", Measure(rounds, [&](unsigned int i) { sink = (a[i] * b[i]).m23; }));
+    results.AddTiming("products", "a * v", Measure(rounds, [&](unsigned int i) { sink = (a[i] * v[i]).x; }));
+    results.AddTiming("products", "a * pt", Measure(rounds, [&](unsigned int i) { sink = (a[i] * points[i]).x; }));
+
+    // The wide types work on MATH_WIDE_LANES values per call, the times are per value. The points
+    // are read from and written to arrays of structures, as the vertices of a mesh.
+    const unsigned int lanes = MATH_WIDE_LANES;
+    std::vector<float> point_values(SAMPLE_COUNT * 4), transformed_points(SAMPLE_COUNT * 4);
+    for (unsigned int i = 0; i < SAMPLE_COUNT; ++i)
+        memcpy(&point_values[i * 4], &points[i].x, sizeof(float) * 4);
+    math::Mat4xW wide_placement(placements[0]);
+    results.AddTiming("wide points", "Matrix4D * Point3D", Measure(rounds, [&](unsigned int i) {
+        math::Point3D point = placements[0] * points[i];
+        memcpy(&transformed_points[i * 4], &point.x, sizeof(float) * 4);
+        sink = transformed_points[i * 4];
+    }));
+    results.AddTiming("wide points", "Mat4xW::TransformPoint", Measure(rounds, [&](unsigned int i) {
+        unsigned int first = (i * lanes) % SAMPLE_COUNT;
+        math::Vec3xW point = wide_placement.TransformPoint(math::Vec3xW::LoadAoS(&point_values[first * 4], 4));
+        point.StoreAoS(&transformed_points[first * 4], 4);
+        sink = transformed_points[first * 4];
+    }) / lanes);
+
+    // Matrices kept in wide form, then the same loaded from arrays of 'Matrix4D' on every call.
+    std::vector<math::Mat4xW> wide_a(SAMPLE_COUNT / lanes), wide_b(SAMPLE_COUNT / lanes);
+    for (unsigned int i = 0; i < SAMPLE_COUNT / lanes; ++i) {
+        wide_a[i] = math::Mat4xW::LoadAoS(&a[i * lanes]);
+        wide_b[i] = math::Mat4xW::LoadAoS(&b[i * lanes]);
+    }
+    results.AddTiming("wide products", "Matrix4D a * b", Measure(rounds, [&](unsigned int i) { sink = (a[i] * b[i]).m23; }));
+    results.AddTiming("wide products", "Mat4xW a * b", Measure(rounds, [&](unsigned int i) {
+        unsigned int block = i % (SAMPLE_COUNT / lanes);
+        sink = (wide_a[block] * wide_b[block]).m[2][3].ReduceAdd();
+    }) / lanes);
+    results.AddTiming("wide products", "Mat4xW::LoadAoS, a * b", Measure(rounds, [&](unsigned int i) {
+        unsigned int first = (i * lanes) % SAMPLE_COUNT;
+        sink = (math::Mat4xW::LoadAoS(&a[first]) * math::Mat4xW::LoadAoS(&b[first])).m[2][3].ReduceAdd();
+    }) / lanes);
+
+    results.AddTiming("chain * vector", "a * b * c * v", Measure(rounds, [&](unsigned int i) {
+        sink = (a[i] * b[i] * c[i] * v[i]).x;
+    }));
+    results.AddTiming("chain * vector", "Chain(a) * b * c * v", Measure(rounds, [&](unsigned int i) {
+        sink = (math::Chain(a[i]) * b[i] * c[i] * v[i]).x;
+    }));
+    results.AddTiming("chain * matrix", "a * b * c", Measure(rounds, [&](unsigned int i) {
+        math::Matrix4D m = a[i] * b[i] * c[i];
+        sink = m.m23;
+    }));
+    results.AddTiming("chain * matrix", "Chain(a) * b * c", Measure(rounds, [&](unsigned int i) {
+        math::Matrix4D m = math::Chain(a[i]) * b[i] * c[i];
+        sink = m.m23;
+    }));
+    results.AddTiming("constant matrices", "a * Translation() * Scale()", Measure(rounds, [&](unsigned int i) {
+        sink = (a[i] * math::Matrix4D::Translation(0.f, 0.f, -300.f) * math::Matrix4D::Scale(10.f, 1.f, 10.f)).m23;
+    }));
+    results.AddTiming("constant matrices", "a * PLACEMENT * GRID_SCALE", Measure(rounds, [&](unsigned int i) {
+        sink = (a[i] * PLACEMENT * GRID_SCALE).m23;
+    }));
+
+    results.AddTiming("inverses", "Matrix4D::Inverse", Measure(rounds, [&](unsigned int i) {
+        sink = placements[i].Inverse().m23;
+    }));
+    results.AddTiming("inverses", "Matrix4D::AffineInverse", Measure(rounds, [&](unsigned int i) {
+        sink = placements[i].AffineInverse().m23;
+    }));
+    results.AddTiming("inverses", "Matrix4D::RigidInverse", Measure(rounds, [&](unsigned int i) {
+        sink = parent_matrices[i].RigidInverse().m23;
+    }));
+
+    results.AddTiming("rotations", "Matrix4D::AxisAngle", Measure(rounds, [&](unsigned int i) {
+        sink = math::Matrix4D::AxisAngle(v[i], angles[i]).m01;
+    }));
+    results.AddTiming("rotations", "Quat::ToQuaternion(axis, angle)", Measure(rounds, [&](unsigned int i) {
+        sink = math::Quat::ToQuaternion(v[i], angles[i]).x;
+    }));
+    results.AddTiming("rotations", "Quat::ToQuaternion(Matrix4D)", Measure(rounds, [&](unsigned int i) {
+        sink = math::Quat::ToQuaternion(rotation_matrices[i]).x;
+    }));
+    results.AddTiming("rotations", "Quat::ToMatrix4D", Measure(rounds, [&](unsigned int i) {
+        sink = rotations[i].ToMatrix4D().m01;
+    }));
+
+    // The whole results are stored, reading a single element lets the compiler drop the rest.
+    std::vector<math::Matrix4D> composed_matrices(SAMPLE_COUNT);
+    std::vector<math::Transform> composed(SAMPLE_COUNT);
+    results.AddTiming("transforms", "Matrix4D parent * child", Measure(rounds, [&](unsigned int i) {
+        composed_matrices[i] = parent_matrices[i] * child_matrices[i];
+        sink = composed_matrices[(i + 1) % SAMPLE_COUNT].m23;
+    }));
+    results.AddTiming("transforms", "Transform parent * child", Measure(rounds, [&](unsigned int i) {
+        composed[i] = parents[i] * children[i];
+        sink = composed[(i + 1) % SAMPLE_COUNT].translation.z;
+    }));
+    results.AddTiming("transforms", "Transform parent * child, ToMatrix4D", Measure(rounds, [&](unsigned int i) {
+        composed_matrices[i] = (parents[i] * children[i]).ToMatrix4D();
+        sink = composed_matrices[(i + 1) % SAMPLE_COUNT].m23;
+    }));
+
+    // Whole poses are interpolated per call, the times are per transform.
+    results.AddTiming("poses", "Transform::Nlerp", Measure(rounds / 8 + 1, [&](unsigned int i) {
+        math::Transform::Nlerp(&parents[0], &children[0], (float)i / SAMPLE_COUNT, &poses[0], SAMPLE_COUNT);
+        sink = poses[i].translation.z;
+    }) / SAMPLE_COUNT);
+    results.AddTiming("poses", "Transform::Slerp", Measure(rounds / 8 + 1, [&](unsigned int i) {
+        math::Transform::Slerp(&parents[0], &children[0], (float)i / SAMPLE_COUNT, &poses[0], SAMPLE_COUNT);
+        sink = poses[i].translation.z;
+    }) / SAMPLE_COUNT);
+
+    results.AddTiming("normalize", "Normalize(PRECISE)", Measure(rounds, [&](unsigned int i) {
+        math::Vector3D n = v[i];
+        n.Normalize(math::PRECISE);
+        sink = n.x;
+    }));
+    results.AddTiming("normalize", "Normalize(FAST)", Measure(rounds, [&](unsigned int i) {
+        math::Vector3D n = v[i];
+        n.Normalize(math::FAST);
+        sink = n.x;
+    }));
+
+    // Normals of a mesh, the times are per normal.
+    results.AddTiming("normals", "TransformDirections(PRECISE)", Measure(rounds / 8 + 1, [&](unsigned int i) {
+        math::TransformDirections(a[i], &normals[0], &transformed_normals[0], SAMPLE_COUNT, true, math::PRECISE);
+        sink = transformed_normals[i];
+    }) / SAMPLE_COUNT);
+    results.AddTiming("normals", "TransformDirections(FAST)", Measure(rounds / 8 + 1, [&](unsigned int i) {
+        math::TransformDirections(a[i], &normals[0], &transformed_normals[0], SAMPLE_COUNT, true, math::FAST);
+        sink = transformed_normals[i];
+    }) / SAMPLE_COUNT);
+
+    // Culling: the points inside the spheres, by distance then by squared distance.
+    results.AddTiming("culling", "Length() < radius", Measure(rounds, [&](unsigned int i) {
+        sink = (math::Vector3D(points[i], spheres[i].center).Length(math::PRECISE) < spheres[i].radius)? 1.f: 0.f;
+    }));
+    results.AddTiming("culling", "Length(FAST) < radius", Measure(rounds, [&](unsigned int i) {
+        sink = (math::Vector3D(points[i], spheres[i].center).Length(math::FAST) < spheres[i].radius)? 1.f: 0.f;
+    }));
+    results.AddTiming("culling", "Sphere::ClassifyToSphere(pt)", Measure(rounds, [&](unsigned int i) {
+        sink = (float)spheres[i].ClassifyToSphere(points[i]);
+    }));
+
+    results.AddTiming("planes", "DistanceToPlane(PRECISE)", Measure(rounds, [&](unsigned int i) {
+        sink = planes[i].DistanceToPlane(points[i], math::PRECISE);
+    }));
+    results.AddTiming("planes", "DistanceToPlane(FAST)", Measure(rounds, [&](unsigned int i) {
+        sink = planes[i].DistanceToPlane(points[i], math::FAST);
+    }));
+    results.AddTiming("planes", "Plane::ClassifyToPlane(pt)", Measure(rounds, [&](unsigned int i) {
+        sink = (float)planes[i].ClassifyToPlane(points[i]);
+    }));
+
+    results.AddTiming("spheres", "Sphere::ClassifyToSphere(sphere)", Measure(rounds, [&](unsigned int i) {
+        sink = (float)spheres[i].ClassifyToSphere(spheres[(i + 1) % SAMPLE_COUNT]);
+    }));
+    results.AddTiming("spheres", "Sphere::ClassifyToSphere(line)", Measure(rounds, [&](unsigned int i) {
+        math::Point3D p0, p1;
+        sink = (float)spheres[i].ClassifyToSphere(lines[i], p0, p1) + p0.x;
+    }));
+
+    results.AddTiming("segments", "ClassifyToLineSegment", Measure(rounds, [&](unsigned int i) {
+        sink = (float)segments[i].ClassifyToLineSegment(segments[(i + 1) % SAMPLE_COUNT]);
+    }));
+    results.AddTiming("segments", "IntersectLineSegmentAt", Measure(rounds, [&](unsigned int i) {
+        math::Point3D point;
+        sink = segments[i].IntersectLineSegmentAt(segments[(i + 1) % SAMPLE_COUNT], point)? point.x: 0.f;
+    }));
+}
+
+/// Prints the command line usage.
+static void PrintUsage(void)
+{
+    std::cout << "Usage: bench [options]" << std::endl
+              << "  --rounds <n>    Rounds over the timing samples, 0 to skip the timings (default 2000)." << std::endl
+              << "  --samples <n>   Random inputs of each accuracy check (default 65536)." << std::endl
+              << "  --seed <n>      Seed of the random inputs (default 1)." << std::endl
+              << "  --json <file>   Also writes the results to a JSON file." << std::endl;
+}
+
+/**
+ * @brief Times the math library and checks its accuracy against double precision references.
+ * @return 0 if every accuracy check is within its bound, 1 otherwise.
+ * @remarks The inputs only depend on the seed: JSON results of different commits or compilers
+ * can be compared line by line.
+ */
+int main(int argc, char *argv[])
+{
+    unsigned int rounds = 2000, samples = 65536, seed = 1;
+    std::string json_path;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--rounds") && has_value)
+            rounds = (unsigned int)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--samples") && has_value)
+            samples = (unsigned int)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && has_value)
+            seed = (unsigned int)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && has_value)
+            json_path = argv[++i];
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    bench::Results results(rounds, samples);
+    bench::SetSeed(seed);
+    if (rounds) {
+        MeasureTimings(results, rounds);
+        MeasureMeshCodec(results, rounds);
+    }
+    bench::SetSeed(seed);
+    bench::CheckAccuracy(results, samples);
+
+    results.Print();
+    if (!json_path.empty() && !results.WriteJson(json_path)) {
+        std::cout << "Cannot write " << json_path << std::endl;
+        return 1;
+    }
+    return results.IsPassed()? 0: 1;
+}
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <fstream>
+#include "results.h"
+#include "simd.h"
+
+/// Returns @a text as a JSON string.
+static std::string Quote(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (unsigned int i = 0; i < text.size(); ++i) {
+        if (text[i] == '"' || text[i] == '\\')
+            quoted += '\\';
+        quoted += text[i];
+    }
+    return quoted + "\"";
+}
+
+/// Returns @a value as a JSON number, 6 significant digits.
+static std::string Number(double value)
+{
+    char number[32];
+    sprintf(number, "%.6g", value);
+    return number;
+}
+
+void bench::Results::AddTiming(const std::string &group, const std::string &name, double nanoseconds, double bytes)
+{
+    double reference = nanoseconds;
+    for (unsigned int i = 0; i < timings.size(); ++i) {
+        if (timings[i].group == group) {
+            reference = timings[i].nanoseconds;
+            break;
+        }
+    }
+    timings.push_back(Timing(group, name, nanoseconds, reference, bytes));
+}
+
+void bench::Results::AddAccuracy(const std::string &name, unsigned int samples, double max_error, double bound)
+{
+    accuracies.push_back(Accuracy(name, samples, max_error, bound));
+}
+
+bool bench::Results::IsPassed(void) const
+{
+    for (unsigned int i = 0; i < accuracies.size(); ++i) {
+        if (!accuracies[i].IsPassed())
+            return false;
+    }
+    return true;
+}
+
+void bench::Results::Print(void) const
+{
+    printf("%s, %s, %u rounds, %u accuracy samples\n", MATH_SIMD_BACKEND, GetCompiler().c_str(), rounds, samples);
+
+    for (unsigned int i = 0; i < timings.size(); ++i) {
+        const Timing &timing = timings[i];
+        if (!i || timing.group != timings[i - 1].group)
+            printf("\n[%s]\n", timing.group.c_str());
+        printf("%-40s %8.2f ns  x%.2f", timing.name.c_str(), timing.nanoseconds, timing.reference / timing.nanoseconds);
+        // Bytes per nanosecond are GB/s.
+        if (timing.bytes)
+            printf("  %.2f GB/s", timing.bytes / timing.nanoseconds);
+        printf("\n");
+    }
+
+    printf("\n%-40s %10s %10s\n", "[accuracy]", "error", "bound");
+    for (unsigned int i = 0; i < accuracies.size(); ++i) {
+        const Accuracy &accuracy = accuracies[i];
+        printf("%-40s %10.3g %10.3g  %s\n", accuracy.name.c_str(), accuracy.max_error, accuracy.bound,
+               accuracy.IsPassed()? "ok": "FAILED");
+    }
+}
+
+bool bench::Results::WriteJson(const std::string &path) const
+{
+    std::ofstream file(path.c_str(), std::ios_base::out | std::ios_base::trunc);
+    if (!file)
+        return false;
+
+    file << "{\n    \"backend\": " << Quote(MATH_SIMD_BACKEND) << ",\n    \"compiler\": " << Quote(GetCompiler())
+         << ",\n    \"rounds\": " << rounds << ",\n    \"samples\": " << samples << ",\n";
+
+    file << "    \"timings\": [";
+    for (unsigned int i = 0; i < timings.size(); ++i) {
+        const Timing &timing = timings[i];
+        file << (i? ",": "") << "\n        { \"group\": " << Quote(timing.group) << ", \"name\": " << Quote(timing.name)
+             << ", \"ns\": " << Number(timing.nanoseconds) << ", \"speedup\": "
+             << Number(timing.reference / timing.nanoseconds);
+        if (timing.bytes)
+            file << ", \"gbps\": " << Number(timing.bytes / timing.nanoseconds);
+        file << " }";
+    }
+
+    file << "\n    ],\n    \"accuracy\": [";
+    for (unsigned int i = 0; i < accuracies.size(); ++i) {
+        const Accuracy &accuracy = accuracies[i];
+        file << (i? ",": "") << "\n        { \"name\": " << Quote(accuracy.name) << ", \"samples\": " << accuracy.samples
+             << ", \"max_error\": " << Number(accuracy.max_error) << ", \"bound\": " << Number(accuracy.bound)
+             << ", \"passed\": " << (accuracy.IsPassed()? "true": "false") << " }";
+    }
+    file << "\n    ]\n}\n";
+
+    return file.good();
+}
+
+std::string bench::GetCompiler(void)
+{
+    char compiler[64];
+#if defined(_MSC_VER)
+    sprintf(compiler, "msvc %d", _MSC_VER);
+#elif defined(__clang__)
+    sprintf(compiler, "clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+    sprintf(compiler, "gcc %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#else
+    sprintf(compiler, "unknown");
+#endif
+    return compiler;
+}
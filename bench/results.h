@@ -0,0 +1,94 @@
+/**
+ * @file results.h
+ * @brief Timings and accuracy measurements of a benchmark run.
+ */
+#ifndef RESULTS_H_INCLUDED
+#define RESULTS_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /// Time per call of an operation.
+    class Timing
+    {
+    public:
+        Timing(const std::string &_group, const std::string &_name, double _nanoseconds, double _reference, double _bytes):
+            group(_group), name(_name), nanoseconds(_nanoseconds), reference(_reference), bytes(_bytes) {}
+
+    public:
+        /// Operations of a group are alternatives, compared to the first one of the group.
+        std::string group;
+        std::string name;
+        double nanoseconds;
+        /// Time of the first operation of the group.
+        double reference;
+        /// Bytes produced per call by throughput measurements, 0 otherwise.
+        double bytes;
+    };
+
+    /// Worst error of an operation against a double precision reference.
+    class Accuracy
+    {
+    public:
+        Accuracy(const std::string &_name, unsigned int _samples, double _max_error, double _bound):
+            name(_name), samples(_samples), max_error(_max_error), bound(_bound) {}
+
+        bool IsPassed(void) const
+        {
+            return max_error <= bound;
+        }
+
+    public:
+        std::string name;
+        unsigned int samples;
+        double max_error;
+        /// Largest error accepted, what the documentation of the operation promises.
+        double bound;
+    };
+
+    /**
+     * @brief Collects the measurements of a run, prints them and writes them as JSON.
+     * @remarks The JSON file is meant to be kept and compared across commits and compilers:
+     * {
+     *     "backend": "sse", "compiler": "msvc 1914", "rounds": 2000, "samples": 65536,
+     *     "timings": [{ "group": "...", "name": "...", "ns": 1.5, "speedup": 1.0 }, ...],
+     *     (throughput timings also have "gbps": 2.5)
+     *     "accuracy": [{ "name": "...", "samples": 65536, "max_error": 1e-7, "bound": 2e-7, "passed": true }, ...]
+     * }
+     */
+    class Results
+    {
+    public:
+        Results(unsigned int _rounds, unsigned int _samples): rounds(_rounds), samples(_samples) {}
+
+        /**
+         * @brief Records the time per call of @a name, the first timing of @a group is the
+         * reference. A call producing @a bytes also reports its throughput.
+         */
+        void AddTiming(const std::string &group, const std::string &name, double nanoseconds, double bytes = 0.0);
+
+        void AddAccuracy(const std::string &name, unsigned int samples, double max_error, double bound);
+
+        /// Returns whether every accuracy check is within its bound.
+        bool IsPassed(void) const;
+
+        /// Prints the results as tables.
+        void Print(void) const;
+
+        /// Writes the results to @a path, returns false if it cannot be written.
+        bool WriteJson(const std::string &path) const;
+
+    private:
+        unsigned int rounds;
+        unsigned int samples;
+        std::vector<Timing> timings;
+        std::vector<Accuracy> accuracies;
+    };
+
+    /// Returns the name and version of the compiler.
+    std::string GetCompiler(void);
+}
+
+#endif // RESULTS_H_INCLUDED
@@ -0,0 +1,55 @@
+#include "samples.h"
+
+/// State of the xorshift generator, never 0.
+static unsigned int state = 2463534242u;
+
+void bench::SetSeed(unsigned int seed)
+{
+    state = seed? seed: 2463534242u;
+}
+
+float bench::Random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (float)(state >> 8) / (float)(1 << 24) * 2.f - 1.f;
+}
+
+float bench::Random(float minimum, float maximum)
+{
+    return minimum + (Random() + 1.f) / 2.f * (maximum - minimum);
+}
+
+math::Quat bench::RandomRotation(void)
+{
+    math::Quat rotation;
+    do {
+        rotation = math::Quat(Random(), Random(), Random(), Random());
+    } while (rotation.Length() < 0.1f);
+    return rotation.Normalized();
+}
+
+math::Matrix4D bench::RandomMatrix(void)
+{
+    math::Matrix4D m;
+    float *elements = &m.m00;
+    for (unsigned int i = 0; i < 12; ++i)
+        elements[i] = Random();
+    return m;
+}
+
+math::Matrix4D bench::RandomPlacement(void)
+{
+    math::Transform placement(math::Vector3D(Random(-10.f, 10.f), Random(-10.f, 10.f), Random(-10.f, 10.f)),
+                              RandomRotation(),
+                              math::Vector3D(Random(0.5f, 2.f), Random(0.5f, 2.f), Random(0.5f, 2.f)));
+    return placement.ToMatrix4D();
+}
+
+math::Transform bench::RandomTransform(void)
+{
+    float scale = Random() + 2.f;
+    return math::Transform(math::Vector3D(Random(), Random(), Random()), RandomRotation(),
+                           math::Vector3D(scale, scale, scale));
+}
@@ -0,0 +1,43 @@
+/**
+ * @file samples.h
+ * @brief Random inputs of the benchmarks and accuracy checks.
+ */
+#ifndef SAMPLES_H_INCLUDED
+#define SAMPLES_H_INCLUDED
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "transform.h"
+
+namespace bench {
+
+    /**
+     * @brief Restarts the random sequence.
+     * @remarks The generator is not the C library one, the inputs are the same whatever the
+     * compiler so that results can be compared across compilers.
+     */
+    void SetSeed(unsigned int seed);
+
+    /// Returns a random float in [-1, 1].
+    float Random(void);
+
+    /// Returns a random float in [@a minimum, @a maximum].
+    float Random(float minimum, float maximum);
+
+    /// Returns a random unit quaternion.
+    math::Quat RandomRotation(void);
+
+    /// Returns a random affine matrix, elements in [-1, 1].
+    math::Matrix4D RandomMatrix(void);
+
+    /**
+     * @brief Returns a random rotation, scale (0.5 to 2 per axis) and translation (-10 to 10), the
+     * well conditioned matrices of a scene.
+     */
+    math::Matrix4D RandomPlacement(void);
+
+    /// Returns a random transform with a uniform scale.
+    math::Transform RandomTransform(void);
+}
+
+#endif // SAMPLES_H_INCLUDED
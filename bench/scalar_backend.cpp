@@ -0,0 +1,16 @@
+// The portable backend, whatever the target.
+#define MATH_SIMD_SCALAR
+
+// Read before the math headers, so that the standard library stays in the global namespace.
+#include <limits>
+#include <math.h>
+#include "scalar_backend.h"
+
+namespace bench {
+    namespace scalar {
+        // The math types and their inline functions are declared in this namespace: they cannot
+        // be merged by the linker with those the other files build with the SIMD backend.
+#include "transform.h"
+#include "backend_ops.h"
+    }
+}
@@ -0,0 +1,34 @@
+/**
+ * @file scalar_backend.h
+ * @brief The math operations built with the portable backend, to check the SIMD one against.
+ */
+#ifndef SCALAR_BACKEND_H_INCLUDED
+#define SCALAR_BACKEND_H_INCLUDED
+
+/// Floats written by 'VectorOperations', 'QuatOperations' and 'MatrixOperations' (see backend_ops.h).
+#define BACKEND_VECTOR_RESULTS 17
+#define BACKEND_QUAT_RESULTS 35
+#define BACKEND_MATRIX_RESULTS 53
+
+namespace bench {
+
+    /**
+     * @brief The operations of backend_ops.h compiled with MATH_SIMD_SCALAR, whatever the backend
+     * of the other files.
+     * @remarks The math types of this build are distinct types (see scalar_backend.cpp), the
+     * inputs and results are passed as floats.
+     */
+    namespace scalar {
+
+        /// Vector3D operations on @a a and @a b (x, y, z, then a scale factor each).
+        void VectorOperations(const float *a, const float *b, float *results);
+
+        /// Quat operations on @a a and @a b (s, x, y, z each), interpolated by @a t.
+        void QuatOperations(const float *a, const float *b, float t, float *results);
+
+        /// Matrix4D operations on @a a and @a b (16 floats each, row major).
+        void MatrixOperations(const float *a, const float *b, float *results);
+    }
+}
+
+#endif // SCALAR_BACKEND_H_INCLUDED
@@ -0,0 +1,411 @@
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "asset_cooker.h"
+#include "job_system.h"
+#include "pak_archive.h"
+#include "JsonUtility.h"
+
+/// Name of the files written in the output directory.
+#define COOK_CACHE_FILE "cook_cache.txt"
+#define COOK_STATISTICS_FILE "cook_stats.csv"
+
+typedef std::chrono::steady_clock CookClock;
+
+/// Returns the milliseconds elapsed since @a start.
+static double GetElapsedMilliseconds(const CookClock::time_point &start)
+{
+    return std::chrono::duration<double, std::milli>(CookClock::now() - start).count();
+}
+
+/// Reads a whole file, returns false if it cannot be opened.
+static bool ReadFileContent(const std::string &file_path, std::vector<char> &content)
+{
+    std::ifstream file(file_path.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!file.is_open())
+        return false;
+
+    file.seekg(0, std::ios_base::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios_base::beg);
+    content.resize((size_t)size);
+    if (size)
+        file.read(&content[0], size);
+    return file.good() || file.eof();
+}
+
+/// Returns the size of a file, or -1 if it does not exist.
+static long long GetExistingFileSize(const std::string &file_path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesEx(file_path.c_str(), GetFileExInfoStandard, &data) || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        return -1;
+    return ((long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+}
+
+/// Creates the directories leading to @a file_path.
+static void CreateParentDirectories(const std::string &file_path)
+{
+    for (std::string::size_type i = file_path.find_first_of("\\/"); i != std::string::npos; i = file_path.find_first_of("\\/", i + 1)) {
+        if (i)
+            CreateDirectory(file_path.substr(0, i).c_str(), NULL);
+    }
+}
+
+/// Folds @a value in @a hash.
+static unsigned long long CombineHash(unsigned long long hash, unsigned long long value)
+{
+    unsigned long long values[2] = { hash, value };
+    return core::PakArchive::Hash((const char *)values, sizeof(values));
+}
+
+bool cooker::AssetCooker::Run(void)
+{
+    CookClock::time_point start = CookClock::now();
+
+    std::vector<std::string> directories;
+    if (!ReadConfig(directories))
+        return false;
+
+    for (unsigned int i = 0; i < directories.size(); ++i)
+        Scan(directories[i]);
+    BuildGraph();
+    LoadCache();
+
+    CookAll();
+    SaveCache();
+
+    bool result = true;
+    for (unsigned int i = 0; i < assets.size() && result; ++i)
+        result = assets[i].status == COOK_DONE || assets[i].status == COOK_CACHED;
+
+    // A failed asset would be missing from the archive, the previous archive is kept instead.
+    double pack_milliseconds = 0.0;
+    if (result && !options.archive_path.empty())
+        result = Pack(pack_milliseconds);
+
+    WriteStatistics(pack_milliseconds, GetElapsedMilliseconds(start));
+    return result;
+}
+
+bool cooker::AssetCooker::ReadConfig(std::vector<std::string> &directories) const
+{
+    utils::json::Object config;
+    utils::json::Api::ParseJsonFile(config, options.config_path.c_str());
+    if (!config.json.IsObject() || !config.json.HasMember("PROJECT_DIRECTORIES") ||
+        !config.json["PROJECT_DIRECTORIES"].IsObject()) {
+        std::cout << "Error: " << options.config_path << " does not declare PROJECT_DIRECTORIES." << std::endl;
+        return false;
+    }
+
+    const rapidjson::Value &entries = config.json["PROJECT_DIRECTORIES"];
+    for (rapidjson::Value::ConstMemberIterator iter = entries.MemberBegin(); iter != entries.MemberEnd(); ++iter) {
+        if (!iter->value.IsString())
+            continue;
+
+        std::string directory = iter->value.GetString();
+        while (!directory.empty() && (directory[directory.size() - 1] == '/' || directory[directory.size() - 1] == '\\'))
+            directory.erase(directory.size() - 1);
+        if (directory.empty())
+            continue;
+
+        DWORD attributes = GetFileAttributes(directory.c_str());
+        if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            std::cout << "Warning: " << iter->name.GetString() << " (" << directory << ") does not exist." << std::endl;
+            continue;
+        }
+        directories.push_back(directory);
+    }
+
+    return true;
+}
+
+void cooker::AssetCooker::Scan(const std::string &directory)
+{
+    WIN32_FIND_DATA data;
+    HANDLE find = FindFirstFile((directory + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return;
+
+    do {
+        std::string name = data.cFileName;
+        if (name == "." || name == "..")
+            continue;
+
+        std::string path = directory + "/" + name;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            Scan(path);
+            continue;
+        }
+
+        // Declared directories may nest, each file is only added once.
+        std::string normalized = core::PakArchive::NormalizePath(path);
+        if (asset_indices.find(normalized) != asset_indices.end())
+            continue;
+
+        CookAsset asset;
+        asset.source = path;
+        asset.rule = CookRules::Select(path);
+        asset.cooked_path = CookRules::GetCookedPath(asset.rule, path);
+        asset_indices[normalized] = (unsigned int)assets.size();
+        assets.push_back(asset);
+    } while (FindNextFile(find, &data));
+
+    FindClose(find);
+}
+
+int cooker::AssetCooker::Resolve(const std::string &reference) const
+{
+    std::map<std::string, unsigned int>::const_iterator iter = asset_indices.find(core::PakArchive::NormalizePath(reference));
+    if (iter != asset_indices.end())
+        return (int)iter->second;
+
+    // Same fallback as the renderer: the file name in the default textures directory.
+    std::string::size_type indicator = reference.find_last_of("\\/") + 1;
+    iter = asset_indices.find(core::PakArchive::NormalizePath("assets/textures/textures/" + reference.substr(indicator)));
+    return (iter != asset_indices.end())? (int)iter->second: -1;
+}
+
+void cooker::AssetCooker::BuildGraph(void)
+{
+    std::vector<char> content;
+    std::vector<std::string> references;
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        references.clear();
+        if (assets[i].rule == COOK_SCENE && ReadFileContent(assets[i].source, content))
+            CookRules::FindReferences(assets[i].rule, content, references);
+
+        for (unsigned int j = 0; j < references.size(); ++j) {
+            int dependency = Resolve(references[j]);
+            if (dependency < 0) {
+                std::cout << "Warning: " << assets[i].source << " refers to missing " << references[j] << "." << std::endl;
+                continue;
+            }
+            if (dependency == (int)i || assets[i].references.count(references[j]))
+                continue;
+
+            assets[i].references[references[j]] = assets[dependency].cooked_path;
+            if (std::find(assets[i].dependencies.begin(), assets[i].dependencies.end(), (unsigned int)dependency) == assets[i].dependencies.end()) {
+                assets[i].dependencies.push_back(dependency);
+                assets[dependency].dependents.push_back(i);
+            }
+        }
+    }
+
+    // Kahn's algorithm, whatever is left unordered sits on or behind a cycle and cannot be cooked.
+    std::vector<unsigned int> pending(assets.size());
+    std::vector<unsigned int> order;
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        pending[i] = (unsigned int)assets[i].dependencies.size();
+        if (!pending[i])
+            order.push_back(i);
+    }
+    for (unsigned int i = 0; i < order.size(); ++i) {
+        const std::vector<unsigned int> &dependents = assets[order[i]].dependents;
+        for (unsigned int j = 0; j < dependents.size(); ++j) {
+            if (!--pending[dependents[j]])
+                order.push_back(dependents[j]);
+        }
+    }
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        if (pending[i]) {
+            std::cout << "Error: " << assets[i].source << " is part of a dependency cycle." << std::endl;
+            assets[i].status = COOK_FAILED;
+        }
+    }
+}
+
+std::string cooker::AssetCooker::GetOutputPath(const CookAsset &asset) const
+{
+    return options.output_directory + "/" + asset.cooked_path;
+}
+
+void cooker::AssetCooker::CookAll(void)
+{
+    std::vector<core::JobCounter *> pending_dependencies(assets.size());
+    for (unsigned int i = 0; i < assets.size(); ++i)
+        pending_dependencies[i] = new core::JobCounter((int)assets[i].dependencies.size());
+
+    // Assets failed while building the graph (cycles) would never be ready, they are only completed.
+    core::JobCounter done;
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        core::JobCounter *dependency = (assets[i].status == COOK_PENDING)? pending_dependencies[i]: NULL;
+        core::JobSystem::Schedule([this, i, &pending_dependencies]() {
+            Process(i);
+            const std::vector<unsigned int> &dependents = assets[i].dependents;
+            for (unsigned int j = 0; j < dependents.size(); ++j)
+                pending_dependencies[dependents[j]]->Decrement();
+        }, &done, dependency);
+    }
+    core::JobSystem::Wait(done);
+
+    for (unsigned int i = 0; i < pending_dependencies.size(); ++i)
+        delete pending_dependencies[i];
+}
+
+void cooker::AssetCooker::Process(unsigned int index)
+{
+    // Assets failed while building the graph are only completed.
+    CookAsset &asset = assets[index];
+    if (asset.status != COOK_PENDING)
+        return;
+
+    CookClock::time_point start = CookClock::now();
+    for (unsigned int i = 0; i < asset.dependencies.size(); ++i) {
+        CookStatus status = assets[asset.dependencies[i]].status;
+        if (status != COOK_DONE && status != COOK_CACHED) {
+            asset.status = COOK_SKIPPED;
+            return;
+        }
+    }
+
+    std::vector<char> content;
+    if (!ReadFileContent(asset.source, content)) {
+        asset.status = COOK_FAILED;
+        asset.milliseconds = GetElapsedMilliseconds(start);
+        return;
+    }
+    asset.input_size = content.size();
+
+    // The dependencies are complete, their keys are final.
+    asset.key = core::PakArchive::Hash(content.empty()? NULL: &content[0], content.size());
+    asset.key = CombineHash(asset.key, ((unsigned long long)COOKER_VERSION << 32) | CookRules::GetVersion(asset.rule));
+    for (unsigned int i = 0; i < asset.dependencies.size(); ++i)
+        asset.key = CombineHash(asset.key, assets[asset.dependencies[i]].key);
+
+    std::string output = GetOutputPath(asset);
+    long long output_size = GetExistingFileSize(output);
+    std::map<std::string, unsigned long long>::const_iterator cached = cache.find(asset.cooked_path);
+    if (!options.force && output_size >= 0 && cached != cache.end() && cached->second == asset.key) {
+        asset.status = COOK_CACHED;
+        asset.output_size = (size_t)output_size;
+        asset.milliseconds = GetElapsedMilliseconds(start);
+        return;
+    }
+
+    CreateParentDirectories(output);
+    if (CookRules::Cook(asset.rule, asset.source, content, asset.references, output)) {
+        asset.status = COOK_DONE;
+        output_size = GetExistingFileSize(output);
+        asset.output_size = (output_size > 0)? (size_t)output_size: 0;
+    }
+    else {
+        // A partial output must not be picked up by the archive.
+        DeleteFile(output.c_str());
+        asset.status = COOK_FAILED;
+    }
+    asset.milliseconds = GetElapsedMilliseconds(start);
+}
+
+void cooker::AssetCooker::LoadCache(void)
+{
+    // One asset per line: the key in hexadecimal, a tab, the cooked path.
+    std::ifstream file((options.output_directory + "/" COOK_CACHE_FILE).c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string::size_type tab = line.find('\t');
+        if (tab == std::string::npos)
+            continue;
+
+        unsigned long long key = 0;
+        if (sscanf(line.substr(0, tab).c_str(), "%llx", &key) == 1)
+            cache[line.substr(tab + 1)] = key;
+    }
+}
+
+void cooker::AssetCooker::SaveCache(void) const
+{
+    std::string file_path = options.output_directory + "/" COOK_CACHE_FILE;
+    CreateParentDirectories(file_path);
+    std::ofstream file(file_path.c_str(), std::ios_base::out | std::ios_base::trunc);
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        if (assets[i].status != COOK_DONE && assets[i].status != COOK_CACHED)
+            continue;
+
+        char key[32];
+        sprintf(key, "%016llx", assets[i].key);
+        file << key << '\t' << assets[i].cooked_path << '\n';
+    }
+}
+
+bool cooker::AssetCooker::Pack(double &milliseconds) const
+{
+    CookClock::time_point start = CookClock::now();
+
+    // Nothing changed since the archive was written: same assets, none cooked in this run.
+    bool changed = GetExistingFileSize(options.archive_path) < 0 || cache.size() != assets.size();
+    std::vector<core::PakSource> sources;
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        changed = changed || assets[i].status == COOK_DONE || !cache.count(assets[i].cooked_path);
+        sources.push_back(core::PakSource(assets[i].cooked_path, GetOutputPath(assets[i])));
+    }
+
+    bool result = !changed || core::PakArchive::Write(options.archive_path, sources);
+    if (!result) {
+        // A partial archive would be taken as up to date by the next run.
+        DeleteFile(options.archive_path.c_str());
+        std::cout << "Error: " << options.archive_path << " cannot be written." << std::endl;
+    }
+    milliseconds = GetElapsedMilliseconds(start);
+    return result;
+}
+
+/// Orders assets by decreasing cooking time.
+class SlowerAsset
+{
+public:
+    SlowerAsset(const std::vector<cooker::CookAsset> &_assets): assets(_assets) {}
+
+    bool operator ()(unsigned int a, unsigned int b) const
+    {
+        return assets[a].milliseconds > assets[b].milliseconds;
+    }
+
+private:
+    const std::vector<cooker::CookAsset> &assets;
+};
+
+void cooker::AssetCooker::WriteStatistics(double pack_milliseconds, double total_milliseconds) const
+{
+    static const char *status_names[] = { "pending", "cooked", "cached", "failed", "skipped" };
+
+    std::vector<unsigned int> order(assets.size());
+    unsigned int counts[COOK_SKIPPED + 1] = {};
+    double cooking_milliseconds = 0.0;
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        order[i] = i;
+        ++counts[assets[i].status];
+        cooking_milliseconds += assets[i].milliseconds;
+    }
+    std::sort(order.begin(), order.end(), SlowerAsset(assets));
+
+    std::string file_path = options.output_directory + "/" COOK_STATISTICS_FILE;
+    CreateParentDirectories(file_path);
+    std::ofstream file(file_path.c_str(), std::ios_base::out | std::ios_base::trunc);
+    file << "asset,rule,status,milliseconds,input_bytes,output_bytes\n";
+    for (unsigned int i = 0; i < order.size(); ++i) {
+        const CookAsset &asset = assets[order[i]];
+        file << '"' << asset.source << "\"," << CookRules::GetName(asset.rule) << ',' << status_names[asset.status] << ','
+             << asset.milliseconds << ',' << asset.input_size << ',' << asset.output_size << '\n';
+    }
+    file << '"' << options.archive_path << "\",pack,," << pack_milliseconds << ",,\n";
+
+    for (unsigned int i = 0; i < assets.size(); ++i) {
+        if (assets[i].status == COOK_FAILED)
+            std::cout << "Error: " << assets[i].source << " failed to cook." << std::endl;
+        else if (assets[i].status == COOK_SKIPPED)
+            std::cout << "Error: " << assets[i].source << " skipped, a dependency failed." << std::endl;
+    }
+
+    std::cout << assets.size() << " assets: " << counts[COOK_DONE] << " cooked, " << counts[COOK_CACHED] << " cached, "
+              << counts[COOK_FAILED] << " failed, " << counts[COOK_SKIPPED] << " skipped." << std::endl;
+    std::cout << "Total " << total_milliseconds << " ms (" << cooking_milliseconds << " ms of asset work, "
+              << pack_milliseconds << " ms packing)." << std::endl;
+    for (unsigned int i = 0; i < order.size() && i < 5 && assets[order[i]].milliseconds > 0.0; ++i) {
+        const CookAsset &asset = assets[order[i]];
+        std::cout << "  " << asset.milliseconds << " ms  " << asset.source << " (" << CookRules::GetName(asset.rule) << ")" << std::endl;
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ * @file asset_cooker.h
+ * @brief Incremental, parallel build of the runtime assets.
+ */
+#ifndef ASSET_COOKER_H_INCLUDED
+#define ASSET_COOKER_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+#include "cook_rules.h"
+
+/// Bumped whenever the cooker changes in a way that affects every asset, everything is re-cooked.
+#define COOKER_VERSION 1
+
+namespace cooker {
+
+    /// Settings of a cook, filled from the command line.
+    class CookerOptions
+    {
+    public:
+        CookerOptions(): config_path("config.json"), output_directory("cooked"), archive_path("assets.pak"),
+                         thread_count(0), force(false) {}
+
+    public:
+        /// The project configuration, its PROJECT_DIRECTORIES are scanned.
+        std::string config_path;
+        /// Receives the cooked assets, the cache and the statistics.
+        std::string output_directory;
+        /// The archive packing the cooked assets, empty to skip packing.
+        std::string archive_path;
+        /// Number of job system workers, 0 for one per core minus the main thread.
+        unsigned int thread_count;
+        /// Whether the cache is ignored and every asset cooked.
+        bool force;
+    };
+
+    /// Outcome of an asset.
+    enum CookStatus
+    {
+        COOK_PENDING,
+        /// Converted in this run.
+        COOK_DONE,
+        /// Unchanged since the last run, the previous output is kept.
+        COOK_CACHED,
+        /// The conversion failed.
+        COOK_FAILED,
+        /// Not cooked because a dependency failed.
+        COOK_SKIPPED
+    };
+
+    /// An asset, node of the dependency graph.
+    class CookAsset
+    {
+    public:
+        CookAsset(): rule(COOK_COPY), key(0), status(COOK_PENDING), milliseconds(0.0),
+                     input_size(0), output_size(0) {}
+
+    public:
+        /// The path of the source file, relative to the working directory.
+        std::string source;
+        /// The path of the cooked asset, relative to the output directory and in the archive.
+        std::string cooked_path;
+        CookRule rule;
+        /// The references found in the source, mapped to the cooked path they resolved to.
+        std::map<std::string, std::string> references;
+        /// Indices of the assets this one refers to, and of the assets referring to this one.
+        std::vector<unsigned int> dependencies;
+        std::vector<unsigned int> dependents;
+        /**
+         * @brief Identifies the cooked output: hash of the source content, the keys of the
+         * dependencies, the rule version and the cooker version.
+         */
+        unsigned long long key;
+        CookStatus status;
+        /// Time spent on the asset (hashing included) and the sizes in bytes.
+        double milliseconds;
+        size_t input_size;
+        size_t output_size;
+    };
+
+    /**
+     * @brief Converts the assets of the project to their runtime form and packs them in an
+     * archive (see 'core::PakArchive').
+     * @remarks The directories declared in the project configuration are scanned and every file
+     * becomes a node of a dependency graph, with an edge to each file it references (the texture
+     * maps of a scene). Assets are processed once their dependencies are, independent assets in
+     * parallel on the job system workers (see 'core::JobSystem').
+     * @remarks Builds are incremental: an asset is only cooked when its key (see 'CookAsset::key')
+     * differs from the one recorded in the cache of the previous run or its output is missing. A
+     * change in a texture thus re-cooks the scenes using it, a cooker update re-cooks everything.
+     * @remarks The time spent on each asset is written to cook_stats.csv in the output directory.
+     */
+    class AssetCooker
+    {
+    public:
+        AssetCooker(const CookerOptions &_options): options(_options) {}
+
+        /// Runs the whole build, returns false if any asset failed or the archive was not written.
+        bool Run(void);
+
+    private:
+        /// Reads the directories to scan from the project configuration.
+        bool ReadConfig(std::vector<std::string> &directories) const;
+
+        /// Adds every file under @a directory to the graph, recursively.
+        void Scan(const std::string &directory);
+
+        /// Finds the references of every asset and links the graph.
+        void BuildGraph(void);
+
+        /// Resolves a reference the way the renderer does, returns the asset index or -1.
+        int Resolve(const std::string &reference) const;
+
+        /**
+         * @brief Processes every asset in dependency order: each asset is a job depending on a
+         * counter of its unprocessed dependencies.
+         */
+        void CookAll(void);
+
+        /// Hashes, checks the cache and cooks the asset at @a index.
+        void Process(unsigned int index);
+
+        /// Returns the path of the cooked output of @a asset.
+        std::string GetOutputPath(const CookAsset &asset) const;
+
+        void LoadCache(void);
+        void SaveCache(void) const;
+        bool Pack(double &milliseconds) const;
+        void WriteStatistics(double pack_milliseconds, double total_milliseconds) const;
+
+    private:
+        CookerOptions options;
+        std::vector<CookAsset> assets;
+        /// Maps the normalized source paths to the asset indices.
+        std::map<std::string, unsigned int> asset_indices;
+        /// Keys of the previous run, by cooked path.
+        std::map<std::string, unsigned long long> cache;
+    };
+}
+
+#endif // ASSET_COOKER_H_INCLUDED
@@ -0,0 +1,220 @@
+#include <windows.h>
+#include <gdiplus.h>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include "cook_rules.h"
+#include "ase_serializer.h"
+#include "binary_serializer.h"
+#include "hull_generator.h"
+#include "model.h"
+#include "static_batcher.h"
+#include "texture_codec.h"
+#include "externalLibs/rapidjson/document.h"
+#include "externalLibs/rapidjson/stringbuffer.h"
+#include "externalLibs/rapidjson/writer.h"
+
+/// Returns the lower case extension of @a path, without the dot.
+static std::string GetExtension(const std::string &path)
+{
+    std::string::size_type dot = path.find_last_of('.');
+    std::string::size_type slash = path.find_last_of("\\/");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return std::string();
+
+    std::string extension = path.substr(dot + 1);
+    for (unsigned int i = 0; i < extension.size(); ++i)
+        extension[i] = (char)tolower((unsigned char)extension[i]);
+    return extension;
+}
+
+/// Writes @a size bytes to @a output, replacing it.
+static bool WriteOutput(const std::string &output, const char *data, size_t size)
+{
+    std::ofstream file(output.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!file.is_open())
+        return false;
+
+    if (size)
+        file.write(data, size);
+    return file.good();
+}
+
+/// Points the texture maps of @a model and its sub models to the cooked textures.
+static void RemapTextures(core::Model *model, const std::map<std::string, std::string> &references)
+{
+    for (unsigned int i = 0; i < model->meshes.size(); ++i) {
+        std::vector<core::Material> &materials = model->meshes[i]->materials;
+        for (unsigned int j = 0; j < materials.size(); ++j) {
+            for (unsigned int k = 0; k < materials[j].textures.size(); ++k) {
+                std::map<std::string, std::string>::const_iterator iter = references.find(materials[j].textures[k].path);
+                if (iter != references.end())
+                    materials[j].textures[k].path = iter->second;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < model->sub_models.size(); ++i)
+        RemapTextures(model->sub_models[i], references);
+}
+
+cooker::CookRule cooker::CookRules::Select(const std::string &path)
+{
+    std::string extension = GetExtension(path);
+    if (extension == "ase")
+        return COOK_SCENE;
+    if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" || extension == "gif" ||
+        extension == "tif" || extension == "tiff")
+        return COOK_TEXTURE;
+    if (extension == "json")
+        return COOK_DATA;
+    return COOK_COPY;
+}
+
+const char *cooker::CookRules::GetName(CookRule rule)
+{
+    switch (rule) {
+    case COOK_SCENE:
+        return "scene";
+    case COOK_TEXTURE:
+        return "texture";
+    case COOK_DATA:
+        return "data";
+    default:
+        return "copy";
+    }
+}
+
+unsigned int cooker::CookRules::GetVersion(CookRule rule)
+{
+    // The output formats carry their own versions, a format change re-cooks what uses it. The low
+    // byte is the version of the rule itself (scenes: 3 since they are batched).
+    switch (rule) {
+    case COOK_SCENE:
+        return 3 + (BINARY_SCENE_VERSION << 8);
+    case COOK_TEXTURE:
+        return 1 + (COOKED_TEXTURE_VERSION << 8);
+    default:
+        return 1;
+    }
+}
+
+std::string cooker::CookRules::GetCookedPath(CookRule rule, const std::string &source)
+{
+    // Textures and data keep their path, the renderer and the game look them up by it.
+    if (rule != COOK_SCENE)
+        return source;
+
+    std::string::size_type dot = source.find_last_of('.');
+    return source.substr(0, dot) + ".scene";
+}
+
+void cooker::CookRules::FindReferences(CookRule rule, const std::vector<char> &content, std::vector<std::string> &references)
+{
+    if (rule != COOK_SCENE || content.empty())
+        return;
+
+    // The texture maps are the only external files of a scene: *BITMAP "path".
+    std::string text(content.begin(), content.end());
+    std::string::size_type index = 0;
+    while ((index = text.find("*BITMAP", index)) != std::string::npos) {
+        index += strlen("*BITMAP");
+        std::string::size_type start = index;
+        while (start < text.size() && (text[start] == ' ' || text[start] == '\t'))
+            ++start;
+        if (start >= text.size() || text[start] != '"')
+            continue;
+
+        std::string::size_type end = text.find('"', start + 1);
+        if (end == std::string::npos)
+            break;
+        if (end > start + 1)
+            references.push_back(text.substr(start + 1, end - start - 1));
+        index = end + 1;
+    }
+}
+
+bool cooker::CookRules::Cook(CookRule rule, const std::string &source, const std::vector<char> &content,
+                             const std::map<std::string, std::string> &references, const std::string &output)
+{
+    switch (rule) {
+    case COOK_SCENE:
+        return CookScene(source, references, output);
+    case COOK_TEXTURE:
+        return CookTexture(content, output);
+    case COOK_DATA:
+        return CookData(content, output);
+    default:
+        return WriteOutput(output, content.empty()? NULL: &content[0], content.size());
+    }
+}
+
+bool cooker::CookRules::CookScene(const std::string &source, const std::map<std::string, std::string> &references,
+                                  const std::string &output)
+{
+    core::ASESerializer reader;
+    core::Model *scene = reader.LoadSceneFromFile(source);
+    if (!scene)
+        return false;
+
+    RemapTextures(scene, references);
+
+    // The collision proxies are cooked with the geometry, the engine never builds them at load.
+    core::HullGenerator::BuildModelHulls(*scene);
+
+    // Batched once here instead of at every load, the merged meshes carry the hulls of their sources.
+    core::Model *batched = core::StaticBatcher::Build(*scene);
+    delete scene;
+
+    core::BinarySerializer writer;
+    bool result = writer.WriteSceneToFile(batched, output);
+    delete batched;
+    return result;
+}
+
+bool cooker::CookRules::CookTexture(const std::vector<char> &content, const std::string &output)
+{
+    if (content.empty())
+        return false;
+
+    int width = 0, height = 0;
+    unsigned char *pixels = core::TextureCodec::Decode(&content[0], content.size(), width, height);
+    if (!pixels)
+        return false;
+    if (width <= 0 || height <= 0) {
+        delete [] pixels;
+        return false;
+    }
+
+    core::CookedTextureHeader header;
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.width = (unsigned int)width;
+    header.height = (unsigned int)height;
+
+    std::ofstream file(output.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    bool result = file.is_open();
+    if (result) {
+        file.write((const char *)&header, sizeof(header));
+        file.write((const char *)pixels, (std::streamsize)width * height * 4);
+        result = file.good();
+    }
+
+    delete [] pixels;
+    return result;
+}
+
+bool cooker::CookRules::CookData(const std::vector<char> &content, const std::string &output)
+{
+    if (content.empty())
+        return false;
+
+    rapidjson::Document document;
+    if (document.Parse(&content[0], content.size()).HasParseError())
+        return false;
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    document.Accept(writer);
+    return WriteOutput(output, buffer.GetString(), buffer.GetSize());
+}
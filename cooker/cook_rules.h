@@ -0,0 +1,76 @@
+/**
+ * @file cook_rules.h
+ * @brief The conversions applied to each kind of asset by the cooker.
+ */
+#ifndef COOK_RULES_H_INCLUDED
+#define COOK_RULES_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cooker {
+
+    /// How an asset is turned into its runtime form.
+    enum CookRule
+    {
+        /// ASE scene to the binary scene format (see 'core::BinarySerializer').
+        COOK_SCENE,
+        /// Image file to a decoded, upload ready texture (see 'core::CookedTextureHeader').
+        COOK_TEXTURE,
+        /// JSON file validated and stripped of whitespace.
+        COOK_DATA,
+        /// Anything else, copied as is.
+        COOK_COPY
+    };
+
+    /**
+     * @brief Picks the rule of an asset, the name and output path of the cooked asset, and applies
+     * the conversions.
+     * @remarks Every rule has a version, bumped whenever its output changes, so that a cooker
+     * update re-cooks the assets it affects and only those.
+     */
+    class CookRules
+    {
+    public:
+        /// Returns the rule for @a path, chosen by its extension.
+        static CookRule Select(const std::string &path);
+
+        /// Returns the name of @a rule, as written in the statistics.
+        static const char *GetName(CookRule rule);
+
+        /// Returns the version of the output of @a rule.
+        static unsigned int GetVersion(CookRule rule);
+
+        /// Returns the path the asset at @a source is stored under once cooked.
+        static std::string GetCookedPath(CookRule rule, const std::string &source);
+
+        /**
+         * @brief Lists the files an asset refers to, as written in the asset (a scene lists its
+         * texture maps).
+         * @param [out] references The referenced paths, appended.
+         */
+        static void FindReferences(CookRule rule, const std::vector<char> &content, std::vector<std::string> &references);
+
+        /**
+         * @brief Cooks an asset.
+         * @param rule The rule of the asset.
+         * @param source The path of the asset.
+         * @param content The content of @a source.
+         * @param references Maps the references of the asset to the cooked path of the asset they
+         * resolved to, the cooked asset refers to the latter.
+         * @param output The file to write.
+         * @return False if the asset is invalid or the output cannot be written.
+         */
+        static bool Cook(CookRule rule, const std::string &source, const std::vector<char> &content,
+                         const std::map<std::string, std::string> &references, const std::string &output);
+
+    private:
+        static bool CookScene(const std::string &source, const std::map<std::string, std::string> &references,
+                              const std::string &output);
+        static bool CookTexture(const std::vector<char> &content, const std::string &output);
+        static bool CookData(const std::vector<char> &content, const std::string &output);
+    };
+}
+
+#endif // COOK_RULES_H_INCLUDED
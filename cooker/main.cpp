@@ -0,0 +1,62 @@
+#include <windows.h>
+#include <gdiplus.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "asset_cooker.h"
+#include "job_system.h"
+
+using namespace Gdiplus;
+
+/// Prints the command line usage.
+static void PrintUsage(void)
+{
+    std::cout << "Usage: cooker [options]" << std::endl
+              << "  --config <file>   Project configuration (default config.json)." << std::endl
+              << "  --output <dir>    Cooked assets, cache and statistics (default cooked)." << std::endl
+              << "  --archive <file>  Archive of the cooked assets, \"\" to skip (default assets.pak)." << std::endl
+              << "  --jobs <n>        Worker threads besides the main one (default one per core minus one)." << std::endl
+              << "  --force           Ignore the cache and cook everything." << std::endl;
+}
+
+/**
+ * @brief Cooks the assets of the project, run from the project directory (where config.json is).
+ * @return 0 if every asset was cooked and packed, 1 otherwise.
+ */
+int main(int argc, char *argv[])
+{
+    cooker::CookerOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--config") && has_value)
+            options.config_path = argv[++i];
+        else if (!strcmp(argv[i], "--output") && has_value)
+            options.output_directory = argv[++i];
+        else if (!strcmp(argv[i], "--archive") && has_value)
+            options.archive_path = argv[++i];
+        else if (!strcmp(argv[i], "--jobs") && has_value)
+            options.thread_count = (unsigned int)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--force"))
+            options.force = true;
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // Textures are decoded with GDI plus.
+    GdiplusStartupInput gdiplusStartupInput;
+    ULONG_PTR gdiplusToken;
+    GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
+    core::JobSystem::Initialize(options.thread_count);
+
+    bool result;
+    {
+        cooker::AssetCooker asset_cooker(options);
+        result = asset_cooker.Run();
+    }
+
+    core::JobSystem::Cleanup();
+    GdiplusShutdown(gdiplusToken);
+    return result? 0: 1;
+}
@@ -5,6 +5,7 @@
 #include <Shlwapi.h>
 #include "ase_serializer.h"
 #include "gvector.h"
+#include "geometry_deduplicator.h"
 
 using namespace math;
 
@@ -215,20 +216,15 @@ public:
 
     /**
      * @brief Converts an intermediate mesh to a final mesh independent of file format.
+     * @param arena The arena the mesh arrays are allocated from (can be NULL).
      * @return A mesh.
      */
-    core::Mesh *ConvertToMesh()
+    core::Mesh *ConvertToMesh(core::MeshArena *arena)
     {
         core::Mesh *targetmodel = new core::Mesh();
         targetmodel->name = this->name;
-        targetmodel->vertex_number = this->vertices_number;
-        targetmodel->vertices = new float[this->vertices_number * 4];
-        targetmodel->normals = new float[this->vertices_number * 3];
-        // Setting the tangents, binormals and uvs.
-        targetmodel->uv_layer_count = 1;
-        targetmodel->tangents[0] = new float[this->vertices_number * 3];
-        targetmodel->binormals[0] = new float[this->vertices_number * 3];
-        targetmodel->uv_coordinates[0] = new float[this->vertices_number * 3];
+        // One uv layer (tangents, binormals and uvs), no colors.
+        targetmodel->Allocate(this->vertices_number, 1, this->faces_number * 3, false, arena);
         targetmodel->materials.push_back(this->material);
 
         // Deep copy of the vertex array.
@@ -289,8 +285,6 @@ public:
         }
 
         // Filling the index array.
-        targetmodel->index_array_size = this->faces_number * 3;
-        targetmodel->index_array = new unsigned short[this->faces_number * 3];
         for (unsigned int i = 0; i < this->faces_number; ++i) {
             targetmodel->index_array[i * 3 + 0] = this->faces[i].v0;
             targetmodel->index_array[i * 3 + 1] = this->faces[i].v1;
@@ -533,6 +527,11 @@ core::Model *core::ASESerializer::ReadSceneFromFileContent(std::string file)
     std::vector<core::Material> materiallist = ReadSceneMaterialListFromFileContent(file);
 	std::string text, subtext;
 
+	// Copies of the same prop share the mesh of the first one, placed by their model transform.
+	core::GeometryDeduplicator deduplicator;
+	std::vector<core::Mesh *> unique_meshes;
+	std::vector<std::pair<core::Model *, const core::Mesh *> > duplicates;
+
 	// Reading the models.
 	std::basic_string<char>::size_type geomobject_index = 0;
 	geomobject_index = file.find("*GEOMOBJECT", 0);
@@ -730,16 +729,44 @@ core::Model *core::ASESerializer::ReadSceneFromFileContent(std::string file)
 			mesh->material = defaultmat;
 		}
 
-		core::Mesh *core_mesh = mesh->ConvertToMesh();
+		// Converted on the heap, only the unique meshes end up in the scene arena.
+		core::Mesh *core_mesh = mesh->ConvertToMesh(NULL);
+		core_mesh->ComputeBounds();
 		delete mesh;
 		mesh = NULL;
 
-		model->meshes.push_back(core_mesh);
+		math::Matrix4D placement;
+		const core::Mesh *original = deduplicator.Find(*core_mesh, placement);
+		if (original) {
+			model->transform = math::Transform::FromMatrix4D(placement);
+			duplicates.push_back(std::make_pair(model, original));
+			delete core_mesh;
+		} else {
+			deduplicator.Add(core_mesh);
+			unique_meshes.push_back(core_mesh);
+			model->meshes.push_back(core_mesh);
+		}
 		scene->sub_models.push_back(model);
 
 		// Find the next object in the list.
 		geomobject_index = file.find("*GEOMOBJECT", geomobject_index);
 	}
 
+	// All the unique mesh arrays of the scene live in a single block owned by the scene.
+	size_t storage_size = 0;
+	for (unsigned int i = 0; i < unique_meshes.size(); ++i)
+		storage_size += core::GeometryBuffer::GetAllocationSize(unique_meshes[i]->GetGeometry()->GetSize());
+	scene->arena = new core::MeshArena();
+	scene->arena->Reserve(storage_size);
+	for (unsigned int i = 0; i < unique_meshes.size(); ++i)
+		unique_meshes[i]->Relocate(scene->arena);
+
+	// The duplicates reference the relocated geometry.
+	for (unsigned int i = 0; i < duplicates.size(); ++i) {
+		core::Mesh *copy = new core::Mesh(*duplicates[i].second);
+		copy->name = duplicates[i].first->name + "_mesh";
+		duplicates[i].first->meshes.push_back(copy);
+	}
+
 	return scene;
 }
@@ -31,6 +31,8 @@ namespace core {
     private:
         /**
          * @brief Given the ASE file content as a string, parses the content for the scene.
+         * @remarks Objects that are copies of an earlier object (up to a rigid transformation) share
+         * its geometry, their model transform places it.
          * @param file Content of the ASE file.
          * @return A model hierarchy if successful, otherwise NULL.
          */
@@ -1,9 +1,852 @@
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include "binary_serializer.h"
+#include "job_system.h"
+#include "mapped_file.h"
+#include "mesh_payload_source.h"
 
-core::Model *core::BinarySerializer::LoadSceneFromFile(std::string file_path)
+/// Alignment of the chunks and geometry blobs in the file.
+#define BINARY_SCENE_ALIGNMENT 16
+/// Marks a model without parent (the root).
+#define BINARY_SCENE_NO_PARENT 0xFFFFFFFFu
+
+/// Chunk types, each type appears once at most.
+enum BinaryChunkType
+{
+    BINARY_CHUNK_STRINGS = 1,
+    BINARY_CHUNK_MODELS,
+    BINARY_CHUNK_MESHES,
+    BINARY_CHUNK_MATERIALS,
+    BINARY_CHUNK_TEXTURES,
+    BINARY_CHUNK_RANGES,
+    BINARY_CHUNK_BLOBS,
+    BINARY_CHUNK_HULLS,
+    /// Vertices (3 floats each) then planes (4 floats each) of every hull.
+    BINARY_CHUNK_HULL_FLOATS,
+    BINARY_CHUNK_HULL_INDICES,
+    BINARY_CHUNK_TYPE_COUNT
+};
+
+/// Mesh record flags.
+#define BINARY_MESH_USES_COLORS 1u
+/// Model record flags.
+#define BINARY_MODEL_IS_STATIC 1u
+
+struct BinarySceneHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunk_count;
+    uint32_t reserved;
+    uint64_t file_size;
+    uint64_t reserved2;
+};
+
+struct BinaryChunk
+{
+    uint32_t type;
+    /// Number of records in the chunk (bytes for the string table).
+    uint32_t count;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct BinaryModel
+{
+    uint32_t name;
+    uint32_t parent;
+    uint32_t flags;
+    uint32_t first_mesh;
+    uint32_t mesh_count;
+    /// Column major.
+    float transform[16];
+};
+
+struct BinaryMesh
+{
+    uint32_t name;
+    uint32_t blob;
+    uint32_t flags;
+    uint32_t vertex_number;
+    uint32_t uv_layer_count;
+    uint32_t index_array_size;
+    uint32_t first_material;
+    uint32_t material_count;
+    uint32_t first_range;
+    uint32_t range_count;
+    uint32_t first_hull;
+    uint32_t hull_count;
+    float center[3];
+    float extents[3];
+};
+
+struct BinaryMaterial
+{
+    uint32_t name;
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+    float shininess;
+    float opacity;
+    uint32_t first_texture;
+    uint32_t texture_count;
+};
+
+struct BinaryTexture
+{
+    uint32_t name;
+    uint32_t path;
+    uint32_t type;
+    float u_offset, v_offset;
+    float u_scale, v_scale;
+    float angle;
+};
+
+struct BinaryRange
+{
+    uint32_t name;
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t first_vertex;
+    uint32_t vertex_count;
+    /// Relative to the first hull of the mesh.
+    uint32_t first_hull;
+    uint32_t hull_count;
+    float center[3];
+    float extents[3];
+};
+
+struct BinaryHull
+{
+    /// In the hull floats chunk, the vertices come first then the planes.
+    uint32_t first_float;
+    uint32_t vertex_count;
+    uint32_t plane_count;
+    /// In the hull indices chunk.
+    uint32_t first_index;
+    uint32_t index_count;
+};
+
+struct BinaryBlob
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+/// Collects the records of every chunk before they are written.
+class BinarySceneWriter
+{
+public:
+    BinarySceneWriter()
+    {
+        // Offset 0 is the empty string.
+        strings.push_back('\0');
+        string_offsets[std::string()] = 0;
+    }
+
+    uint32_t AddString(const std::string &string)
+    {
+        std::map<std::string, uint32_t>::iterator iter = string_offsets.find(string);
+        if (iter != string_offsets.end())
+            return iter->second;
+
+        uint32_t offset = (uint32_t)strings.size();
+        strings.insert(strings.end(), string.begin(), string.end());
+        strings.push_back('\0');
+        string_offsets[string] = offset;
+        return offset;
+    }
+
+    void AddModel(const core::Model &model, uint32_t parent);
+    uint32_t AddGeometry(const core::Mesh &mesh);
+    bool Write(std::ofstream &file) const;
+
+public:
+    std::vector<char> strings;
+    std::map<std::string, uint32_t> string_offsets;
+    std::vector<BinaryModel> models;
+    std::vector<BinaryMesh> meshes;
+    std::vector<BinaryMaterial> materials;
+    std::vector<BinaryTexture> textures;
+    std::vector<BinaryRange> ranges;
+    std::vector<BinaryHull> hulls;
+    std::vector<float> hull_floats;
+    std::vector<uint32_t> hull_indices;
+    /// The packed geometry of each blob, and the blob of each source array block.
+    std::vector<const core::GeometryBuffer *> blobs;
+    std::map<const float *, uint32_t> blob_indices;
+};
+
+/// Copies @a count floats, or zeros if @a source is NULL.
+static void CopyArray(float *destination, const float *source, size_t count)
 {
-    return NULL;
+    if (source)
+        memcpy(destination, source, count * sizeof(float));
+    else
+        memset(destination, 0, count * sizeof(float));
+}
+
+uint32_t BinarySceneWriter::AddGeometry(const core::Mesh &mesh)
+{
+    mesh.EnsureResident();
+
+    // Meshes sharing their geometry point to the same arrays.
+    std::map<const float *, uint32_t>::iterator iter = blob_indices.find(mesh.vertices);
+    if (iter != blob_indices.end())
+        return iter->second;
+
+    // Repack the arrays in the 'Mesh::Allocate' layout, which the loader maps as is.
+    core::Mesh packed;
+    packed.Allocate(mesh.vertex_number, mesh.uv_layer_count, mesh.index_array_size, mesh.is_using_colors);
+    size_t n = mesh.vertex_number;
+    CopyArray(packed.vertices, mesh.vertices, n * 4);
+    CopyArray(packed.normals, mesh.normals, n * 3);
+    if (packed.colors)
+        CopyArray(packed.colors, mesh.colors, n * 4);
+    for (unsigned int l = 0; l < packed.uv_layer_count; ++l) {
+        CopyArray(packed.tangents[l], mesh.tangents[l], n * 3);
+        CopyArray(packed.binormals[l], mesh.binormals[l], n * 3);
+        CopyArray(packed.uv_coordinates[l], mesh.uv_coordinates[l], n * 3);
+    }
+    if (mesh.index_array_size)
+        memcpy(packed.index_array, mesh.index_array, mesh.index_array_size * sizeof(unsigned short));
+
+    // Keep the buffer alive until the file is written.
+    const core::GeometryBuffer *geometry = packed.GetGeometry();
+    geometry->AddRef();
+    uint32_t index = (uint32_t)blobs.size();
+    blobs.push_back(geometry);
+    blob_indices[mesh.vertices] = index;
+    return index;
+}
+
+void BinarySceneWriter::AddModel(const core::Model &model, uint32_t parent)
+{
+    BinaryModel record;
+    record.name = AddString(model.name);
+    record.parent = parent;
+    record.flags = model.is_static? BINARY_MODEL_IS_STATIC: 0;
+    record.first_mesh = (uint32_t)meshes.size();
+    record.mesh_count = (uint32_t)model.meshes.size();
+    model.transform.ToMatrix4D().ToArrayColumnMajor(record.transform);
+
+    uint32_t index = (uint32_t)models.size();
+    models.push_back(record);
+
+    for (unsigned int i = 0; i < model.meshes.size(); ++i) {
+        const core::Mesh &mesh = *model.meshes[i];
+        BinaryMesh mesh_record;
+        mesh_record.name = AddString(mesh.name);
+        mesh_record.blob = AddGeometry(mesh);
+        mesh_record.flags = mesh.is_using_colors? BINARY_MESH_USES_COLORS: 0;
+        mesh_record.vertex_number = mesh.vertex_number;
+        mesh_record.uv_layer_count = mesh.uv_layer_count;
+        mesh_record.index_array_size = mesh.index_array_size;
+        mesh_record.first_material = (uint32_t)materials.size();
+        mesh_record.material_count = (uint32_t)mesh.materials.size();
+        mesh_record.first_range = (uint32_t)ranges.size();
+        mesh_record.range_count = (uint32_t)mesh.ranges.size();
+        mesh_record.first_hull = (uint32_t)hulls.size();
+        mesh_record.hull_count = (uint32_t)mesh.hulls.size();
+        mesh_record.center[0] = mesh.bounds.center.x;
+        mesh_record.center[1] = mesh.bounds.center.y;
+        mesh_record.center[2] = mesh.bounds.center.z;
+        mesh_record.extents[0] = mesh.bounds.maximumdistanceX;
+        mesh_record.extents[1] = mesh.bounds.maximumdistanceY;
+        mesh_record.extents[2] = mesh.bounds.maximumdistanceZ;
+        meshes.push_back(mesh_record);
+
+        for (unsigned int m = 0; m < mesh.materials.size(); ++m) {
+            const core::Material &material = mesh.materials[m];
+            BinaryMaterial material_record;
+            material_record.name = AddString(material.name);
+            const core::Color *colors[3] = { &material.ambient, &material.diffuse, &material.specular };
+            float *targets[3] = { material_record.ambient, material_record.diffuse, material_record.specular };
+            for (unsigned int c = 0; c < 3; ++c) {
+                targets[c][0] = colors[c]->r;
+                targets[c][1] = colors[c]->g;
+                targets[c][2] = colors[c]->b;
+                targets[c][3] = colors[c]->a;
+            }
+            material_record.shininess = material.shininess;
+            material_record.opacity = material.opacity;
+            material_record.first_texture = (uint32_t)textures.size();
+            material_record.texture_count = (uint32_t)material.textures.size();
+            materials.push_back(material_record);
+
+            for (unsigned int t = 0; t < material.textures.size(); ++t) {
+                const core::TextureMap &map = material.textures[t];
+                BinaryTexture texture;
+                texture.name = AddString(map.name);
+                texture.path = AddString(map.path);
+                texture.type = AddString(map.type);
+                texture.u_offset = map.u_offset;
+                texture.v_offset = map.v_offset;
+                texture.u_scale = map.u_scale;
+                texture.v_scale = map.v_scale;
+                texture.angle = map.angle;
+                textures.push_back(texture);
+            }
+        }
+
+        for (unsigned int r = 0; r < mesh.ranges.size(); ++r) {
+            const core::MeshRange &range = mesh.ranges[r];
+            BinaryRange range_record;
+            range_record.name = AddString(range.name);
+            range_record.first_index = range.first_index;
+            range_record.index_count = range.index_count;
+            range_record.first_vertex = range.first_vertex;
+            range_record.vertex_count = range.vertex_count;
+            range_record.first_hull = range.first_hull;
+            range_record.hull_count = range.hull_count;
+            range_record.center[0] = range.bounds.center.x;
+            range_record.center[1] = range.bounds.center.y;
+            range_record.center[2] = range.bounds.center.z;
+            range_record.extents[0] = range.bounds.maximumdistanceX;
+            range_record.extents[1] = range.bounds.maximumdistanceY;
+            range_record.extents[2] = range.bounds.maximumdistanceZ;
+            ranges.push_back(range_record);
+        }
+
+        for (unsigned int h = 0; h < mesh.hulls.size(); ++h) {
+            const core::ConvexHull &hull = mesh.hulls[h];
+            BinaryHull hull_record;
+            hull_record.first_float = (uint32_t)hull_floats.size();
+            hull_record.vertex_count = hull.GetVertexCount();
+            hull_record.plane_count = hull.GetPlaneCount();
+            hull_record.first_index = (uint32_t)hull_indices.size();
+            hull_record.index_count = (uint32_t)hull.indices.size();
+            hull_floats.insert(hull_floats.end(), hull.vertices.begin(), hull.vertices.begin() + hull_record.vertex_count * 3);
+            hull_floats.insert(hull_floats.end(), hull.planes.begin(), hull.planes.begin() + hull_record.plane_count * 4);
+            hull_indices.insert(hull_indices.end(), hull.indices.begin(), hull.indices.end());
+            hulls.push_back(hull_record);
+        }
+    }
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        AddModel(*model.sub_models[i], index);
+}
+
+/// Writes @a size bytes of @a data followed by zeros up to the next aligned offset.
+static void WriteAligned(std::ofstream &file, const void *data, size_t size, uint64_t &offset)
+{
+    static const char padding[BINARY_SCENE_ALIGNMENT] = {};
+    if (size)
+        file.write((const char *)data, size);
+    offset += size;
+
+    size_t pad = core::MeshArena::AlignSize((size_t)offset, BINARY_SCENE_ALIGNMENT) - (size_t)offset;
+    file.write(padding, pad);
+    offset += pad;
+}
+
+template <typename T>
+static void AddChunk(std::vector<BinaryChunk> &chunks, uint32_t type, const std::vector<T> &records, uint64_t &offset)
+{
+    BinaryChunk chunk;
+    chunk.type = type;
+    chunk.count = (uint32_t)records.size();
+    chunk.offset = offset;
+    chunk.size = records.size() * sizeof(T);
+    chunks.push_back(chunk);
+    offset = core::MeshArena::AlignSize((size_t)(offset + chunk.size), BINARY_SCENE_ALIGNMENT);
+}
+
+bool BinarySceneWriter::Write(std::ofstream &file) const
+{
+    // Place the chunks, then the geometry blobs.
+    std::vector<BinaryChunk> chunks;
+    uint64_t offset = core::MeshArena::AlignSize(sizeof(BinarySceneHeader) + (BINARY_CHUNK_TYPE_COUNT - 1) * sizeof(BinaryChunk),
+                                                 BINARY_SCENE_ALIGNMENT);
+    AddChunk(chunks, BINARY_CHUNK_STRINGS, strings, offset);
+    AddChunk(chunks, BINARY_CHUNK_MODELS, models, offset);
+    AddChunk(chunks, BINARY_CHUNK_MESHES, meshes, offset);
+    AddChunk(chunks, BINARY_CHUNK_MATERIALS, materials, offset);
+    AddChunk(chunks, BINARY_CHUNK_TEXTURES, textures, offset);
+    AddChunk(chunks, BINARY_CHUNK_RANGES, ranges, offset);
+    AddChunk(chunks, BINARY_CHUNK_HULLS, hulls, offset);
+    AddChunk(chunks, BINARY_CHUNK_HULL_FLOATS, hull_floats, offset);
+    AddChunk(chunks, BINARY_CHUNK_HULL_INDICES, hull_indices, offset);
+
+    std::vector<BinaryBlob> blob_table(blobs.size());
+    AddChunk(chunks, BINARY_CHUNK_BLOBS, blob_table, offset);
+    for (unsigned int i = 0; i < blobs.size(); ++i) {
+        blob_table[i].offset = offset;
+        blob_table[i].size = blobs[i]->GetSize();
+        offset = core::MeshArena::AlignSize((size_t)(offset + blob_table[i].size), BINARY_SCENE_ALIGNMENT);
+    }
+
+    BinarySceneHeader header;
+    header.magic = BINARY_SCENE_MAGIC;
+    header.version = BINARY_SCENE_VERSION;
+    header.chunk_count = (uint32_t)chunks.size();
+    header.reserved = 0;
+    header.file_size = offset;
+    header.reserved2 = 0;
+
+    uint64_t written = 0;
+    file.write((const char *)&header, sizeof(header));
+    written += sizeof(header);
+    WriteAligned(file, &chunks[0], chunks.size() * sizeof(BinaryChunk), written);
+    WriteAligned(file, &strings[0], strings.size(), written);
+    WriteAligned(file, models.empty()? NULL: &models[0], models.size() * sizeof(BinaryModel), written);
+    WriteAligned(file, meshes.empty()? NULL: &meshes[0], meshes.size() * sizeof(BinaryMesh), written);
+    WriteAligned(file, materials.empty()? NULL: &materials[0], materials.size() * sizeof(BinaryMaterial), written);
+    WriteAligned(file, textures.empty()? NULL: &textures[0], textures.size() * sizeof(BinaryTexture), written);
+    WriteAligned(file, ranges.empty()? NULL: &ranges[0], ranges.size() * sizeof(BinaryRange), written);
+    WriteAligned(file, hulls.empty()? NULL: &hulls[0], hulls.size() * sizeof(BinaryHull), written);
+    WriteAligned(file, hull_floats.empty()? NULL: &hull_floats[0], hull_floats.size() * sizeof(float), written);
+    WriteAligned(file, hull_indices.empty()? NULL: &hull_indices[0], hull_indices.size() * sizeof(uint32_t), written);
+    WriteAligned(file, blob_table.empty()? NULL: &blob_table[0], blob_table.size() * sizeof(BinaryBlob), written);
+    for (unsigned int i = 0; i < blobs.size(); ++i)
+        WriteAligned(file, blobs[i]->GetData(), blobs[i]->GetSize(), written);
+
+    return file.good() && written == header.file_size;
+}
+
+bool core::BinarySerializer::WriteSceneToFile(const Model *scene, const std::string &file_path) const
+{
+    if (!scene)
+        return false;
+
+    BinarySceneWriter writer;
+    writer.AddModel(*scene, BINARY_SCENE_NO_PARENT);
+
+    std::ofstream file(file_path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    bool result = file.is_open() && writer.Write(file);
+
+    for (unsigned int i = 0; i < writer.blobs.size(); ++i)
+        writer.blobs[i]->Release();
+    return result;
 }
 
 void core::BinarySerializer::WriteSceneToFile(const core::Model *scene) const
-{}
+{
+    WriteSceneToFile(scene, output_path);
+}
+
+/// Validated view of the chunks of a scene file, mapped alone or as an entry of an archive.
+class BinarySceneReader
+{
+public:
+    BinarySceneReader(const char *_data, size_t _size): data(_data), size(_size)
+    {
+        memset(chunks, 0, sizeof(chunks));
+    }
+
+    /// Checks the header and the chunk table.
+    bool Open(void);
+
+    /// Returns the records of a chunk, the count is checked against the chunk size.
+    template <typename T>
+    const T *GetRecords(BinaryChunkType type, uint32_t &count) const
+    {
+        const BinaryChunk &chunk = chunks[type];
+        count = chunk.count;
+        if (chunk.size < (uint64_t)chunk.count * sizeof(T))
+            count = 0;
+        return (const T *)(data + chunk.offset);
+    }
+
+    /// Returns the string at @a offset in the string table, NULL if out of bounds.
+    const char *GetString(uint32_t offset) const
+    {
+        const BinaryChunk &chunk = chunks[BINARY_CHUNK_STRINGS];
+        if (offset >= chunk.size)
+            return NULL;
+
+        // The table ends with a terminator, checked in 'Open'.
+        return data + chunk.offset + offset;
+    }
+
+    /// Returns the start of the scene.
+    const char *GetData(void) const
+    {
+        return data;
+    }
+
+    /// Returns the size of the scene in bytes.
+    size_t GetSize(void) const
+    {
+        return size;
+    }
+
+private:
+    const char *data;
+    size_t size;
+    BinaryChunk chunks[BINARY_CHUNK_TYPE_COUNT];
+};
+
+bool BinarySceneReader::Open(void)
+{
+    if (size < sizeof(BinarySceneHeader))
+        return false;
+
+    const BinarySceneHeader *header = (const BinarySceneHeader *)data;
+    if (header->magic != BINARY_SCENE_MAGIC || header->version != BINARY_SCENE_VERSION || header->file_size != size)
+        return false;
+
+    if ((uint64_t)header->chunk_count * sizeof(BinaryChunk) > size - sizeof(BinarySceneHeader))
+        return false;
+
+    const BinaryChunk *table = (const BinaryChunk *)(data + sizeof(BinarySceneHeader));
+    for (uint32_t i = 0; i < header->chunk_count; ++i) {
+        // Unknown chunks are skipped, so newer writers can add some without breaking the format.
+        const BinaryChunk &chunk = table[i];
+        if (chunk.type == 0 || chunk.type >= BINARY_CHUNK_TYPE_COUNT)
+            continue;
+
+        if (chunk.offset % BINARY_SCENE_ALIGNMENT || chunk.offset > size || chunk.size > size - chunk.offset)
+            return false;
+        chunks[chunk.type] = chunk;
+    }
+
+    const BinaryChunk &strings = chunks[BINARY_CHUNK_STRINGS];
+    return strings.size && data[strings.offset + strings.size - 1] == '\0';
+}
+
+/// Column major to Matrix4D.
+static void MatrixFromArray(const float *m, math::Matrix4D &matrix)
+{
+    matrix.m00 = m[0]; matrix.m01 = m[4]; matrix.m02 = m[8]; matrix.m03 = m[12];
+    matrix.m10 = m[1]; matrix.m11 = m[5]; matrix.m12 = m[9]; matrix.m13 = m[13];
+    matrix.m20 = m[2]; matrix.m21 = m[6]; matrix.m22 = m[10]; matrix.m23 = m[14];
+    matrix.m30 = m[3]; matrix.m31 = m[7]; matrix.m32 = m[11]; matrix.m33 = m[15];
+}
+
+/**
+ * @brief Fetches the geometry blobs of a mapped scene file on first use by copying them to the
+ * heap, so the page faults happen on the thread that fetches. Prefetch requests are served by
+ * jobs, each holding a reference on the source.
+ * @remarks The fetched buffers are cached until the source is destroyed, so meshes that shared
+ * a blob share the fetched buffer too.
+ */
+class BinaryPayloadSource: public core::MeshPayloadSource
+{
+public:
+    /**
+     * @param _data The start of the scene in @a _file.
+     * @param _blobs The blob table, every entry must be within the scene.
+     */
+    BinaryPayloadSource(core::MappedFile *_file, const char *_data, const BinaryBlob *_blobs, uint32_t count):
+        file(_file), data(_data), blobs(_blobs, _blobs + count), cache(count, (core::GeometryBuffer *)NULL), queued(count, false)
+    {
+        file->AddRef();
+    }
+
+    virtual core::GeometryBuffer *Fetch(unsigned int payload);
+    virtual void Prefetch(unsigned int payload);
+
+protected:
+    virtual ~BinaryPayloadSource();
+
+private:
+    /// Copies a blob out of the file.
+    core::GeometryBuffer *Load(unsigned int payload) const
+    {
+        core::GeometryBuffer *buffer = core::GeometryBuffer::Create((size_t)blobs[payload].size);
+        memcpy(buffer->GetData(), data + blobs[payload].offset, (size_t)blobs[payload].size);
+        return buffer;
+    }
+
+    /// Caches @a buffer unless another thread was first, returns the cached buffer.
+    core::GeometryBuffer *Store(unsigned int payload, core::GeometryBuffer *buffer);
+
+private:
+    core::MappedFile *file;
+    const char *data;
+    std::vector<BinaryBlob> blobs;
+    /// Guarded by 'mutex', as are the members below.
+    std::vector<core::GeometryBuffer *> cache;
+    std::vector<bool> queued;
+    std::mutex mutex;
+};
+
+core::GeometryBuffer *BinaryPayloadSource::Store(unsigned int payload, core::GeometryBuffer *buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cache[payload]) {
+        buffer->Release();
+        return cache[payload];
+    }
+
+    cache[payload] = buffer;
+    return buffer;
+}
+
+core::GeometryBuffer *BinaryPayloadSource::Fetch(unsigned int payload)
+{
+    if (payload >= blobs.size())
+        return NULL;
+
+    core::GeometryBuffer *buffer = NULL;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer = cache[payload];
+    }
+
+    // The copy is made outside the lock, a prefetch job may be loading another blob.
+    if (!buffer)
+        buffer = Store(payload, Load(payload));
+
+    // One reference for the cache, one for the caller.
+    buffer->AddRef();
+    return buffer;
+}
+
+void BinaryPayloadSource::Prefetch(unsigned int payload)
+{
+    if (payload >= blobs.size())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cache[payload] || queued[payload])
+            return;
+        queued[payload] = true;
+    }
+
+    // The job keeps the source alive until it ran.
+    AddRef();
+    core::JobSystem::Schedule([this, payload]() {
+        bool cached;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cached = cache[payload] != NULL;
+        }
+        if (!cached)
+            Store(payload, Load(payload));
+        Release();
+    });
+}
+
+BinaryPayloadSource::~BinaryPayloadSource()
+{
+    for (unsigned int i = 0; i < cache.size(); ++i) {
+        if (cache[i])
+            cache[i]->Release();
+    }
+    file->Release();
+}
+
+/**
+ * @brief Builds the hierarchy from the records, returns NULL if any of them is inconsistent.
+ * @param file The mapping holding the scene, referenced by the geometry.
+ * @param lazy Whether the meshes are left without arrays, to be fetched on first use.
+ */
+static core::Model *ReadScene(const BinarySceneReader &reader, core::MappedFile *file, bool lazy)
+{
+    uint32_t model_count, mesh_count, material_count, texture_count, range_count, blob_count;
+    uint32_t hull_count, hull_float_count, hull_index_count;
+    const BinaryModel *models = reader.GetRecords<BinaryModel>(BINARY_CHUNK_MODELS, model_count);
+    const BinaryMesh *meshes = reader.GetRecords<BinaryMesh>(BINARY_CHUNK_MESHES, mesh_count);
+    const BinaryMaterial *materials = reader.GetRecords<BinaryMaterial>(BINARY_CHUNK_MATERIALS, material_count);
+    const BinaryTexture *textures = reader.GetRecords<BinaryTexture>(BINARY_CHUNK_TEXTURES, texture_count);
+    const BinaryRange *ranges = reader.GetRecords<BinaryRange>(BINARY_CHUNK_RANGES, range_count);
+    const BinaryBlob *blobs = reader.GetRecords<BinaryBlob>(BINARY_CHUNK_BLOBS, blob_count);
+    const BinaryHull *hulls = reader.GetRecords<BinaryHull>(BINARY_CHUNK_HULLS, hull_count);
+    const float *hull_floats = reader.GetRecords<float>(BINARY_CHUNK_HULL_FLOATS, hull_float_count);
+    const uint32_t *hull_indices = reader.GetRecords<uint32_t>(BINARY_CHUNK_HULL_INDICES, hull_index_count);
+    if (!model_count || models[0].parent != BINARY_SCENE_NO_PARENT)
+        return NULL;
+
+    for (uint32_t i = 0; i < blob_count; ++i) {
+        if (blobs[i].offset % BINARY_SCENE_ALIGNMENT || blobs[i].offset > reader.GetSize() ||
+            blobs[i].size > reader.GetSize() - blobs[i].offset)
+            return NULL;
+    }
+
+    // One view per blob, shared by the meshes using it. Views hold a reference on the file. Lazy
+    // meshes share a payload source instead.
+    std::vector<core::GeometryBuffer *> buffers(blob_count, (core::GeometryBuffer *)NULL);
+    BinaryPayloadSource *source = NULL;
+    if (lazy) {
+        source = new BinaryPayloadSource(file, reader.GetData(), blobs, blob_count);
+    } else {
+        for (uint32_t i = 0; i < blob_count; ++i)
+            buffers[i] = core::GeometryBuffer::CreateView((char *)reader.GetData() + blobs[i].offset, (size_t)blobs[i].size, file);
+    }
+
+    bool valid = true;
+    std::vector<core::Model *> created(model_count, (core::Model *)NULL);
+    for (uint32_t i = 0; i < model_count && valid; ++i) {
+        const BinaryModel &record = models[i];
+        // Parents always come first.
+        const char *name = reader.GetString(record.name);
+        valid = name && (i == 0 || record.parent < i) && record.first_mesh <= mesh_count &&
+                record.mesh_count <= mesh_count - record.first_mesh;
+        if (!valid)
+            break;
+
+        core::Model *model = new core::Model();
+        created[i] = model;
+        if (i)
+            created[record.parent]->sub_models.push_back(model);
+        model->name = name;
+        model->is_static = (record.flags & BINARY_MODEL_IS_STATIC) != 0;
+        // The writer stores 'Transform::ToMatrix4D', anything a transform cannot hold is corrupt.
+        math::Matrix4D transform;
+        MatrixFromArray(record.transform, transform);
+        valid = math::Transform::TryFromMatrix4D(transform, model->transform);
+        if (!valid)
+            break;
+
+        for (uint32_t m = record.first_mesh; m < record.first_mesh + record.mesh_count && valid; ++m) {
+            const BinaryMesh &mesh_record = meshes[m];
+            const char *mesh_name = reader.GetString(mesh_record.name);
+            valid = mesh_name && mesh_record.blob < blob_count &&
+                    mesh_record.first_material <= material_count && mesh_record.material_count <= material_count - mesh_record.first_material &&
+                    mesh_record.first_range <= range_count && mesh_record.range_count <= range_count - mesh_record.first_range &&
+                    mesh_record.first_hull <= hull_count && mesh_record.hull_count <= hull_count - mesh_record.first_hull;
+            if (!valid)
+                break;
+
+            core::Mesh *mesh = new core::Mesh();
+            model->meshes.push_back(mesh);
+            mesh->name = mesh_name;
+            mesh->bounds.center = math::Point3D(mesh_record.center[0], mesh_record.center[1], mesh_record.center[2]);
+            mesh->bounds.maximumdistanceX = mesh_record.extents[0];
+            mesh->bounds.maximumdistanceY = mesh_record.extents[1];
+            mesh->bounds.maximumdistanceZ = mesh_record.extents[2];
+            if (lazy) {
+                // The blob size is checked by 'Mesh::Map' once fetched.
+                mesh->vertex_number = mesh_record.vertex_number;
+                mesh->uv_layer_count = std::min(mesh_record.uv_layer_count, (uint32_t)MAX_UV_LAYERS);
+                mesh->index_array_size = mesh_record.index_array_size;
+                mesh->is_using_colors = (mesh_record.flags & BINARY_MESH_USES_COLORS) != 0;
+                mesh->SetPayload(source, mesh_record.blob);
+            } else {
+                valid = mesh->Map(buffers[mesh_record.blob], mesh_record.vertex_number, mesh_record.uv_layer_count,
+                                  mesh_record.index_array_size, (mesh_record.flags & BINARY_MESH_USES_COLORS) != 0);
+            }
+
+            for (uint32_t t = mesh_record.first_material; t < mesh_record.first_material + mesh_record.material_count && valid; ++t) {
+                const BinaryMaterial &material_record = materials[t];
+                const char *material_name = reader.GetString(material_record.name);
+                valid = material_name && material_record.first_texture <= texture_count &&
+                        material_record.texture_count <= texture_count - material_record.first_texture;
+                if (!valid)
+                    break;
+
+                core::Material material;
+                material.name = material_name;
+                core::Color *colors[3] = { &material.ambient, &material.diffuse, &material.specular };
+                const float *sources[3] = { material_record.ambient, material_record.diffuse, material_record.specular };
+                for (unsigned int c = 0; c < 3; ++c) {
+                    colors[c]->r = sources[c][0];
+                    colors[c]->g = sources[c][1];
+                    colors[c]->b = sources[c][2];
+                    colors[c]->a = sources[c][3];
+                }
+                material.shininess = material_record.shininess;
+                material.opacity = material_record.opacity;
+
+                for (uint32_t x = material_record.first_texture; x < material_record.first_texture + material_record.texture_count && valid; ++x) {
+                    const BinaryTexture &texture = textures[x];
+                    const char *strings[3] = { reader.GetString(texture.name), reader.GetString(texture.path), reader.GetString(texture.type) };
+                    valid = strings[0] && strings[1] && strings[2];
+                    if (!valid)
+                        break;
+
+                    core::TextureMap map;
+                    map.name = strings[0];
+                    map.path = strings[1];
+                    map.type = strings[2];
+                    map.u_offset = texture.u_offset;
+                    map.v_offset = texture.v_offset;
+                    map.u_scale = texture.u_scale;
+                    map.v_scale = texture.v_scale;
+                    map.angle = texture.angle;
+                    material.textures.push_back(map);
+                }
+                mesh->materials.push_back(material);
+            }
+
+            for (uint32_t r = mesh_record.first_range; r < mesh_record.first_range + mesh_record.range_count && valid; ++r) {
+                // The ranges are drawn straight from the index array, they must stay within the mesh.
+                const BinaryRange &range_record = ranges[r];
+                const char *range_name = reader.GetString(range_record.name);
+                valid = range_name != NULL &&
+                        range_record.first_index <= mesh_record.index_array_size &&
+                        range_record.index_count <= mesh_record.index_array_size - range_record.first_index &&
+                        range_record.first_vertex <= mesh_record.vertex_number &&
+                        range_record.vertex_count <= mesh_record.vertex_number - range_record.first_vertex &&
+                        range_record.first_hull <= mesh_record.hull_count &&
+                        range_record.hull_count <= mesh_record.hull_count - range_record.first_hull;
+                if (!valid)
+                    break;
+
+                core::MeshRange range;
+                range.name = range_name;
+                range.first_index = range_record.first_index;
+                range.index_count = range_record.index_count;
+                range.first_vertex = range_record.first_vertex;
+                range.vertex_count = range_record.vertex_count;
+                range.first_hull = range_record.first_hull;
+                range.hull_count = range_record.hull_count;
+                range.bounds.center = math::Point3D(range_record.center[0], range_record.center[1], range_record.center[2]);
+                range.bounds.maximumdistanceX = range_record.extents[0];
+                range.bounds.maximumdistanceY = range_record.extents[1];
+                range.bounds.maximumdistanceZ = range_record.extents[2];
+                mesh->ranges.push_back(range);
+            }
+
+            for (uint32_t h = mesh_record.first_hull; h < mesh_record.first_hull + mesh_record.hull_count && valid; ++h) {
+                const BinaryHull &hull_record = hulls[h];
+                uint64_t float_count = (uint64_t)hull_record.vertex_count * 3 + (uint64_t)hull_record.plane_count * 4;
+                valid = hull_record.first_float <= hull_float_count && float_count <= hull_float_count - hull_record.first_float &&
+                        hull_record.first_index <= hull_index_count && hull_record.index_count <= hull_index_count - hull_record.first_index;
+                if (!valid)
+                    break;
+
+                core::ConvexHull hull;
+                const float *vertices = hull_floats + hull_record.first_float;
+                const float *planes = vertices + hull_record.vertex_count * 3;
+                hull.vertices.assign(vertices, planes);
+                hull.planes.assign(planes, planes + hull_record.plane_count * 4);
+                hull.indices.assign(hull_indices + hull_record.first_index, hull_indices + hull_record.first_index + hull_record.index_count);
+                for (unsigned int k = 0; k < hull.indices.size() && valid; ++k)
+                    valid = hull.indices[k] < hull_record.vertex_count;
+                mesh->hulls.push_back(hull);
+            }
+        }
+    }
+
+    // The meshes hold their own references on the views and source.
+    for (uint32_t i = 0; i < blob_count; ++i) {
+        if (buffers[i])
+            buffers[i]->Release();
+    }
+    if (source)
+        source->Release();
+
+    if (!valid) {
+        delete created[0];
+        return NULL;
+    }
+
+    return created[0];
+}
+
+core::Model *core::BinarySerializer::LoadSceneFromFile(std::string file_path)
+{
+    MappedFile *file = MappedFile::Open(file_path);
+    if (!file)
+        return NULL;
+
+    Model *scene = LoadSceneFromMemory(file, file->GetData(), file->GetSize());
+
+    // The geometry views (or payload source) keep the mapping alive as long as the scene uses it.
+    file->Release();
+    return scene;
+}
+
+core::Model *core::BinarySerializer::LoadSceneFromMemory(MappedFile *file, const char *data, size_t size)
+{
+    BinarySceneReader reader(data, size);
+    return reader.Open()? ReadScene(reader, file, lazy_payloads): NULL;
+}
@@ -7,23 +7,69 @@
 
 #include "serializer.h"
 
+/// Identifies a binary scene file ('PNDS' read as a little endian integer).
+#define BINARY_SCENE_MAGIC 0x53444E50u
+/// Bumped whenever the layout of the file changes, older files are rejected.
+#define BINARY_SCENE_VERSION 4
+
 namespace core {
 
+    class MappedFile;
+
     /**
-     * @brief Reads and serializes a scene to a binary format.
-     * @todo To be implemented later on.
+     * @brief Reads and serializes a scene to a binary format, meant to be loaded straight from a
+     * memory mapping of the file.
+     * @remarks Layout: a header, a chunk table, then the chunks (strings, models, meshes,
+     * materials, texture maps, mesh ranges, collision hulls, geometry blobs), each starting on a 16
+     * bytes boundary.
+     * Names and paths are offsets in the string table. The models are stored depth first with the
+     * index of their parent, and their transformation as a matrix: a file holding a matrix that
+     * 'math::Transform' cannot hold exactly (a shear) is rejected.
+     * @remarks The geometry of a mesh is a single blob holding every array in the layout of
+     * 'Mesh::Allocate', so on load the mesh arrays point straight into the mapped file: nothing is
+     * parsed or copied, the pages are read from disk when first used. Meshes sharing a geometry
+     * buffer share their blob.
+     * @remarks The loaded geometry is read only, 'Mesh::MakeWritable' copies it before any change.
+     * @remarks With lazy payloads only the hierarchy, materials, counts and bounds are read at
+     * load, the arrays of each mesh are copied out of the file on first use (see
+     * 'Mesh::EnsureResident'), or ahead of time by job system workers with 'Mesh::Prefetch'.
+     * @remarks The collision hulls of the meshes are read at load with the hierarchy, they are
+     * small and queries need them before any payload.
+     * @remarks Little endian only.
      */
     class BinarySerializer: public Serializer
     {
     public:
-        BinarySerializer() {}
+        /**
+         * @param _output_path The file 'WriteSceneToFile' writes to.
+         * @param _lazy_payloads Whether the mesh arrays are loaded on first use.
+         */
+        BinarySerializer(const std::string &_output_path = std::string(), bool _lazy_payloads = false):
+            output_path(_output_path), lazy_payloads(_lazy_payloads) {}
         ~BinarySerializer() {}
 
-        /// Loads a scene from a binary format file.
+        /// Loads a scene from a binary format file, returns NULL if the file is missing or invalid.
         virtual Model *LoadSceneFromFile(std::string file_path);
 
-        /// Write a scene to a file in binary format.
+        /**
+         * @brief Loads a scene stored in a mapping, i.e. an entry of a 'PakArchive' (see
+         * 'PakArchive::Find' and 'PakArchive::GetFile').
+         * @param file The mapping holding the scene, the geometry keeps a reference on it.
+         * @param data The start of the scene in @a file, 16 bytes aligned.
+         * @param size The size of the scene in bytes.
+         * @return The scene, NULL if it is invalid.
+         */
+        Model *LoadSceneFromMemory(MappedFile *file, const char *data, size_t size);
+
+        /// Write a scene to the output file in binary format.
         virtual void WriteSceneToFile(const Model *scene) const;
+
+        /// Writes @a scene to @a file_path, returns false if the file cannot be written.
+        bool WriteSceneToFile(const Model *scene, const std::string &file_path) const;
+
+    private:
+        std::string output_path;
+        bool lazy_payloads;
     };
 }
 
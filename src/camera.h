@@ -39,10 +39,11 @@ namespace core {
          */
         math::Matrix4D GetViewTransformation(void) const
         {
-            math::Matrix4D translation = math::Matrix4D::Translation(-position.x, -position.y, -position.z);
-            math::Matrix4D crossproduct = math::Matrix4D::CrossProduct(upvector);
-            math::Vector3D tmp = -lookatdirection;
-            math::Vector3D result = crossproduct * tmp;
+            // The rows are the camera axes, the translation is the position brought into them:
+            // the same as the rotation times the translation, without the 4 by 4 products.
+            math::Vector3D up = upvector;
+            up.Normalize();
+            math::Vector3D result = up.CrossProduct(-lookatdirection);
             math::Matrix4D camerarotation;
             camerarotation.m00 = result.x;
             camerarotation.m01 = result.y;
@@ -54,7 +55,11 @@ namespace core {
             camerarotation.m21 = -lookatdirection.y;
             camerarotation.m22 = -lookatdirection.z;
 
-            return camerarotation * translation;
+            math::simd::float4 eye = position.GetRegister();
+            camerarotation.m03 = -math::simd::Dot3(camerarotation.GetRow(0), eye);
+            camerarotation.m13 = -math::simd::Dot3(camerarotation.GetRow(1), eye);
+            camerarotation.m23 = -math::simd::Dot3(camerarotation.GetRow(2), eye);
+            return camerarotation;
         }
 
     public:
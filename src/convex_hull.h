@@ -0,0 +1,76 @@
+/**
+ * @file convex_hull.h
+ * @brief Convex collision proxy of a mesh.
+ */
+#ifndef CONVEX_HULL_H_INCLUDED
+#define CONVEX_HULL_H_INCLUDED
+
+#include <vector>
+#include "point.h"
+
+namespace core {
+
+    /**
+     * @brief A convex polyhedron used in place of a render mesh for collision and camera queries.
+     * @remarks The planes are stored as (nx, ny, nz, d) with outward unit normals, a point p is
+     * inside when n.p + d <= 0 for every plane. Coplanar faces share a single plane.
+     * @remarks When the hull was built with a vertex limit, the planes are pushed out so they still
+     * enclose every source point; the vertices are the ones of the (smaller) limited hull.
+     * @see HullGenerator
+     */
+    class ConvexHull
+    {
+    public:
+        ConvexHull() {}
+
+        /// Whether the hull holds no geometry.
+        bool IsEmpty(void) const
+        {
+            return planes.empty();
+        }
+
+        unsigned int GetVertexCount(void) const
+        {
+            return (unsigned int)vertices.size() / 3;
+        }
+
+        unsigned int GetPlaneCount(void) const
+        {
+            return (unsigned int)planes.size() / 4;
+        }
+
+        /**
+         * @brief Returns the largest signed distance of @a point to the planes: negative inside
+         * (the depth to the closest face), positive outside (a lower bound of the distance).
+         */
+        float GetSignedDistance(const math::Point3D &point) const
+        {
+            float distance = -std::numeric_limits<float>::max();
+            for (unsigned int i = 0; i < planes.size(); i += 4) {
+                float d = planes[i] * point.x + planes[i + 1] * point.y + planes[i + 2] * point.z + planes[i + 3];
+                distance = (d > distance)? d: distance;
+            }
+            return distance;
+        }
+
+        /// Whether @a point is inside the hull, inflated by @a margin.
+        bool Contains(const math::Point3D &point, float margin = 0.f) const
+        {
+            for (unsigned int i = 0; i < planes.size(); i += 4) {
+                if (planes[i] * point.x + planes[i + 1] * point.y + planes[i + 2] * point.z + planes[i + 3] > margin)
+                    return false;
+            }
+            return !planes.empty();
+        }
+
+    public:
+        /// Hull vertices, 3 floats each.
+        std::vector<float> vertices;
+        /// Hull triangles, counter clockwise seen from the outside.
+        std::vector<unsigned int> indices;
+        /// Face planes, 4 floats each.
+        std::vector<float> planes;
+    };
+}
+
+#endif // CONVEX_HULL_H_INCLUDED
@@ -0,0 +1,44 @@
+#include "draw_list.h"
+
+void core::DrawList::Record(const Model &model, Pipeline &pipeline)
+{
+    pipeline.SetMatrixMode(Pipeline::MODELVIEW);
+
+    // Apply the model transformation on top of its parent's.
+    pipeline.PushMatrix();
+    pipeline.PreMultiply(model.transform.ToMatrix4D());
+
+    for (unsigned int i = 0; i < model.meshes.size(); ++i) {
+        const Mesh &mesh = *model.meshes[i];
+        if (!pipeline.IsBoxVisible(mesh.bounds))
+            continue;
+
+        // The workers copy the arrays in while the rest is recorded, drawing then finds them ready.
+        mesh.Prefetch();
+
+        if (mesh.ranges.empty()) {
+            Add(mesh, pipeline.GetModelView());
+            continue;
+        }
+
+        // A merged mesh: its sources are culled one by one, consecutive visible ones are merged
+        // back into a single range.
+        bool begun = false;
+        for (unsigned int r = 0; r < mesh.ranges.size(); ++r) {
+            const MeshRange &range = mesh.ranges[r];
+            if (!range.index_count || !pipeline.IsBoxVisible(range.bounds))
+                continue;
+
+            if (!begun) {
+                Begin(mesh, pipeline.GetModelView());
+                begun = true;
+            }
+            AddRange(range.first_index, range.index_count);
+        }
+    }
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        Record(*model.sub_models[i], pipeline);
+
+    pipeline.PopMatrixEmpty();
+}
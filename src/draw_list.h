@@ -0,0 +1,136 @@
+/**
+ * @file draw_list.h
+ * @brief Draws recorded ahead of submission.
+ */
+#ifndef DRAW_LIST_H_INCLUDED
+#define DRAW_LIST_H_INCLUDED
+
+#include <vector>
+#include "model.h"
+#include "mesh.h"
+#include "pipeline.h"
+
+namespace core {
+
+    /// Triangles of a mesh to draw, a part of its 'Mesh::index_array'.
+    class DrawRange
+    {
+    public:
+        DrawRange(): first_index(0), index_count(0) {}
+        DrawRange(unsigned int _first_index, unsigned int _index_count): first_index(_first_index), index_count(_index_count) {}
+
+    public:
+        unsigned int first_index;
+        unsigned int index_count;
+    };
+
+    /**
+     * @brief Holds meshes to draw, each with the modelview it is drawn with, stored contiguously
+     * as column major 4x4 matrices (see 'InstanceBuffer'), and the index ranges drawn.
+     * @remarks Recording only reads the hierarchy, its transformations and the mesh bounds, never
+     * the geometry or the graphics API: several threads can record at once, each with its own list
+     * and pipeline, the lists are then submitted on the main thread (see 'Renderer::DrawCommands').
+     * Meant to be kept around and refilled every frame, clearing keeps the memory.
+     */
+    class DrawList
+    {
+    public:
+        DrawList() {}
+
+        /// Reserves room for @a count draws.
+        void Reserve(unsigned int count)
+        {
+            meshes.reserve(count);
+            modelviews.reserve(count * 16);
+            first_ranges.reserve(count);
+            ranges.reserve(count);
+        }
+
+        /// Removes all draws.
+        void Clear(void)
+        {
+            meshes.clear();
+            modelviews.clear();
+            first_ranges.clear();
+            ranges.clear();
+        }
+
+        /// Appends a draw of all the triangles of @a mesh with @a modelview.
+        void Add(const Mesh &mesh, const math::Matrix4D &modelview)
+        {
+            Begin(mesh, modelview);
+            AddRange(0, mesh.index_array_size);
+        }
+
+        /// Appends a draw of @a mesh with @a modelview, its triangles are added with 'AddRange'.
+        void Begin(const Mesh &mesh, const math::Matrix4D &modelview)
+        {
+            meshes.push_back(&mesh);
+            modelviews.resize(modelviews.size() + 16);
+            modelview.ToArrayColumnMajor(&modelviews[modelviews.size() - 16]);
+            first_ranges.push_back((unsigned int)ranges.size());
+        }
+
+        /**
+         * @brief Adds @a index_count indices from @a first_index to the last draw, merged with its
+         * last range when they follow it.
+         */
+        void AddRange(unsigned int first_index, unsigned int index_count)
+        {
+            if (ranges.size() > first_ranges.back() && ranges.back().first_index + ranges.back().index_count == first_index)
+                ranges.back().index_count += index_count;
+            else
+                ranges.push_back(DrawRange(first_index, index_count));
+        }
+
+        /**
+         * @brief Appends the meshes of @a model and its sub models, each placed by its transformation
+         * pushed on the modelview stack of @a pipeline.
+         * @remarks Meshes whose bounds are outside the view frustum are skipped. Of a merged mesh
+         * (see 'Mesh::ranges') only the sources in the frustum are drawn. The modelview stack is left
+         * as it was.
+         * @remarks The recorded meshes that are not resident are prefetched (see 'Mesh::Prefetch').
+         */
+        void Record(const Model &model, Pipeline &pipeline);
+
+        /// Returns the number of draws.
+        unsigned int GetCount(void) const
+        {
+            return (unsigned int)meshes.size();
+        }
+
+        /// Returns the mesh of the draw @a index.
+        const Mesh &GetMesh(unsigned int index) const
+        {
+            return *meshes[index];
+        }
+
+        /// Returns the modelview of the draw @a index, 16 floats.
+        const float *GetModelView(unsigned int index) const
+        {
+            return &modelviews[index * 16];
+        }
+
+        /// Returns the number of index ranges of the draw @a index.
+        unsigned int GetRangeCount(unsigned int index) const
+        {
+            unsigned int last = index + 1 < first_ranges.size()? first_ranges[index + 1]: (unsigned int)ranges.size();
+            return last - first_ranges[index];
+        }
+
+        /// Returns the index ranges of the draw @a index, 'GetRangeCount' of them.
+        const DrawRange *GetRanges(unsigned int index) const
+        {
+            return ranges.data() + first_ranges[index];
+        }
+
+    private:
+        std::vector<const Mesh *> meshes;
+        std::vector<float> modelviews;
+        /// The ranges of draw i are from first_ranges[i] to the first range of the next draw.
+        std::vector<unsigned int> first_ranges;
+        std::vector<DrawRange> ranges;
+    };
+}
+
+#endif // DRAW_LIST_H_INCLUDED
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstdio>
+#include "frame_graph.h"
+
+typedef std::chrono::steady_clock FrameClock;
+
+/// Returns the milliseconds from @a start to @a end.
+static double GetMilliseconds(const FrameClock::time_point &start, const FrameClock::time_point &end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+core::FrameGraph::~FrameGraph()
+{
+    for (unsigned int i = 0; i < tasks.size(); ++i)
+        delete tasks[i];
+}
+
+unsigned int core::FrameGraph::AddResource(const std::string &name)
+{
+    resources.push_back(FrameResource(name));
+    return (unsigned int)resources.size() - 1;
+}
+
+unsigned int core::FrameGraph::AddTask(const std::string &name, const JobFunction &function,
+                                       const std::vector<unsigned int> &reads, const std::vector<unsigned int> &writes,
+                                       JobAffinity affinity)
+{
+    unsigned int index = (unsigned int)tasks.size();
+    tasks.push_back(new FrameTask(name, function, affinity));
+
+    // Read after write: the task waits for the last writer of everything it touches.
+    for (unsigned int i = 0; i < reads.size(); ++i) {
+        if (resources[reads[i]].last_writer >= 0)
+            AddEdge((unsigned int)resources[reads[i]].last_writer, index);
+    }
+    for (unsigned int i = 0; i < writes.size(); ++i) {
+        FrameResource &resource = resources[writes[i]];
+        if (resource.last_writer >= 0)
+            AddEdge((unsigned int)resource.last_writer, index);
+
+        // Write after read: the readers declared before must see the previous value.
+        for (unsigned int j = 0; j < resource.readers.size(); ++j)
+            AddEdge(resource.readers[j], index);
+    }
+
+    for (unsigned int i = 0; i < reads.size(); ++i) {
+        if (std::find(writes.begin(), writes.end(), reads[i]) == writes.end())
+            resources[reads[i]].readers.push_back(index);
+    }
+    for (unsigned int i = 0; i < writes.size(); ++i) {
+        resources[writes[i]].last_writer = (int)index;
+        resources[writes[i]].readers.clear();
+    }
+
+    return index;
+}
+
+void core::FrameGraph::AddEdge(unsigned int predecessor, unsigned int task)
+{
+    std::vector<unsigned int> &predecessors = tasks[task]->predecessors;
+    if (predecessor == task || std::find(predecessors.begin(), predecessors.end(), predecessor) != predecessors.end())
+        return;
+
+    predecessors.push_back(predecessor);
+    tasks[predecessor]->successors.push_back(task);
+}
+
+void core::FrameGraph::Execute(void)
+{
+    frame_start = FrameClock::now();
+
+    // Every counter is armed before the first task can complete and decrement one.
+    for (unsigned int i = 0; i < tasks.size(); ++i) {
+        for (unsigned int j = 0; j < tasks[i]->predecessors.size(); ++j)
+            tasks[i]->ready.Increment();
+    }
+
+    JobCounter done;
+    for (unsigned int i = 0; i < tasks.size(); ++i)
+        JobSystem::Schedule(std::bind(&FrameGraph::Run, this, i), &done, &tasks[i]->ready, tasks[i]->affinity);
+    JobSystem::Wait(done);
+
+    frame_milliseconds = GetMilliseconds(frame_start, FrameClock::now());
+    ComputeCriticalPath();
+}
+
+void core::FrameGraph::Run(unsigned int index)
+{
+    FrameTask &task = *tasks[index];
+    FrameClock::time_point start = FrameClock::now();
+    task.function();
+    FrameClock::time_point end = FrameClock::now();
+    task.start = GetMilliseconds(frame_start, start);
+    task.milliseconds = GetMilliseconds(start, end);
+
+    for (unsigned int i = 0; i < task.successors.size(); ++i)
+        tasks[task.successors[i]]->ready.Decrement();
+}
+
+void core::FrameGraph::ComputeCriticalPath(void)
+{
+    // Predecessors are always declared first, the declaration order is a topological order.
+    work_milliseconds = 0.0;
+    critical_task = -1;
+    for (unsigned int i = 0; i < tasks.size(); ++i) {
+        FrameTask &task = *tasks[i];
+        task.path_milliseconds = 0.0;
+        task.path_predecessor = -1;
+        for (unsigned int j = 0; j < task.predecessors.size(); ++j) {
+            const FrameTask &predecessor = *tasks[task.predecessors[j]];
+            if (predecessor.path_milliseconds > task.path_milliseconds) {
+                task.path_milliseconds = predecessor.path_milliseconds;
+                task.path_predecessor = (int)task.predecessors[j];
+            }
+        }
+        task.path_milliseconds += task.milliseconds;
+        work_milliseconds += task.milliseconds;
+
+        if (critical_task < 0 || task.path_milliseconds > tasks[critical_task]->path_milliseconds)
+            critical_task = (int)i;
+    }
+}
+
+std::vector<unsigned int> core::FrameGraph::GetCriticalPath(void) const
+{
+    std::vector<unsigned int> path;
+    for (int i = critical_task; i >= 0; i = tasks[i]->path_predecessor)
+        path.push_back((unsigned int)i);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+std::string core::FrameGraph::GetReport(void) const
+{
+    char times[64];
+    sprintf(times, "%.2f/%.2f ms:", GetCriticalPathMilliseconds(), work_milliseconds);
+
+    std::string report = times;
+    std::vector<unsigned int> path = GetCriticalPath();
+    for (unsigned int i = 0; i < path.size(); ++i) {
+        report += i? " > ": " ";
+        report += tasks[path[i]]->name;
+    }
+    return report;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file frame_graph.h
+ * @brief Per frame task graph built from the resources each task reads and writes.
+ */
+#ifndef FRAME_GRAPH_H_INCLUDED
+#define FRAME_GRAPH_H_INCLUDED
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "job_system.h"
+
+namespace core {
+
+    /// A task of the frame graph, see 'FrameGraph::AddTask'.
+    class FrameTask
+    {
+    public:
+        FrameTask(const std::string &_name, const JobFunction &_function, JobAffinity _affinity):
+            name(_name), function(_function), affinity(_affinity), start(0.0), milliseconds(0.0), path_milliseconds(0.0),
+            path_predecessor(-1) {}
+
+    public:
+        std::string name;
+        JobFunction function;
+        JobAffinity affinity;
+        /// Tasks that must complete before this one, and the tasks waiting for this one.
+        std::vector<unsigned int> predecessors;
+        std::vector<unsigned int> successors;
+        /// Predecessors not completed yet in the current frame, the task is queued at 0.
+        JobCounter ready;
+
+        /// Timings of the last frame: start since the frame start and duration.
+        double start;
+        double milliseconds;
+        /// Longest chain of task durations ending with this task, and its previous task (-1 if none).
+        double path_milliseconds;
+        int path_predecessor;
+
+    private:
+        // Not copyable, jobs point to the counter.
+        FrameTask(const FrameTask &);
+        FrameTask &operator =(const FrameTask &);
+    };
+
+    /**
+     * @brief Runs the work of a frame as a graph of tasks on the job system: each task declares the
+     * resources (input state, camera, transforms, render list...) it reads and writes, and tasks
+     * that do not conflict run concurrently.
+     * @remarks The graph is declared once, the order of declaration is the sequential order of the
+     * frame: a task runs after the previous writer of anything it reads or writes, and after the
+     * previous readers of anything it writes. Running the graph thus gives the same result as
+     * running the tasks in sequence.
+     * @remarks Tasks calling a thread bound API (OpenGL, windowing) are declared with
+     * 'JOB_MAIN_THREAD' affinity, 'Execute' must then be called from the main thread.
+     * @remarks Each frame the critical path is measured: the chain of dependent tasks with the
+     * longest total duration. It bounds the frame time however many workers there are.
+     */
+    class FrameGraph
+    {
+    public:
+        FrameGraph(): work_milliseconds(0.0), frame_milliseconds(0.0), critical_task(-1) {}
+        ~FrameGraph();
+
+        /**
+         * @brief Declares a resource tasks can read and write.
+         * @return The identifier of the resource.
+         */
+        unsigned int AddResource(const std::string &name);
+
+        /**
+         * @brief Appends a task to the graph.
+         * @param reads Resources the task reads.
+         * @param writes Resources the task writes (reading them is implied).
+         * @return The index of the task.
+         */
+        unsigned int AddTask(const std::string &name, const JobFunction &function, const std::vector<unsigned int> &reads,
+                             const std::vector<unsigned int> &writes, JobAffinity affinity = JOB_ANY_THREAD);
+
+        /// Runs every task once, returns once they are all done. The calling thread helps.
+        void Execute(void);
+
+        /// Returns the tasks on the critical path of the last frame, in execution order.
+        std::vector<unsigned int> GetCriticalPath(void) const;
+
+        /// Returns the total duration of the critical path of the last frame.
+        double GetCriticalPathMilliseconds(void) const
+        {
+            return (critical_task >= 0)? tasks[critical_task]->path_milliseconds: 0.0;
+        }
+
+        /// Returns the sum of the task durations of the last frame, what a sequential frame would take.
+        double GetWorkMilliseconds(void) const
+        {
+            return work_milliseconds;
+        }
+
+        /// Returns the wall time 'Execute' took in the last frame.
+        double GetFrameMilliseconds(void) const
+        {
+            return frame_milliseconds;
+        }
+
+        /// Returns a one line summary of the last frame: "path/work ms: task > task > ...".
+        std::string GetReport(void) const;
+
+        unsigned int GetTaskCount(void) const
+        {
+            return (unsigned int)tasks.size();
+        }
+
+        const FrameTask &GetTask(unsigned int index) const
+        {
+            return *tasks[index];
+        }
+
+        const std::string &GetResourceName(unsigned int resource) const
+        {
+            return resources[resource].name;
+        }
+
+    private:
+        /// Access history of a resource while the graph is declared.
+        class FrameResource
+        {
+        public:
+            FrameResource(const std::string &_name): name(_name), last_writer(-1) {}
+
+        public:
+            std::string name;
+            int last_writer;
+            /// Tasks that read the resource since its last writer.
+            std::vector<unsigned int> readers;
+        };
+
+        // Not copyable, owns its tasks.
+        FrameGraph(const FrameGraph &);
+        FrameGraph &operator =(const FrameGraph &);
+
+        /// Makes @a task depend on @a predecessor, once.
+        void AddEdge(unsigned int predecessor, unsigned int task);
+
+        /// Job: runs the task at @a index and releases its successors.
+        void Run(unsigned int index);
+
+        /// Finds the longest chain of the last frame.
+        void ComputeCriticalPath(void);
+
+    private:
+        std::vector<FrameTask *> tasks;
+        std::vector<FrameResource> resources;
+        /// Start of the current frame, the task timings are relative to it.
+        std::chrono::steady_clock::time_point frame_start;
+        double work_milliseconds;
+        double frame_milliseconds;
+        /// Last task of the critical path of the last frame.
+        int critical_task;
+    };
+}
+
+#endif // FRAME_GRAPH_H_INCLUDED
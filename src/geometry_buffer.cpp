@@ -0,0 +1,47 @@
+#include <new>
+#include <cstring>
+#include "geometry_buffer.h"
+
+core::GeometryBuffer *core::GeometryBuffer::Create(size_t size, MeshArena *arena)
+{
+    size_t allocation_size = GetAllocationSize(size);
+    char *memory = NULL;
+    if (arena) {
+        memory = (char *)arena->Allocate(allocation_size);
+        arena->AddRef();
+    } else {
+        memory = (char *)MeshArena::AllocateAligned(allocation_size);
+    }
+
+    // The header is placed in front of the data.
+    char *data = memory + MeshArena::AlignSize(sizeof(GeometryBuffer));
+    return new (memory) GeometryBuffer(data, size, arena, false);
+}
+
+core::GeometryBuffer *core::GeometryBuffer::CreateView(char *_data, size_t _size, SharedStorage *_backing, bool _read_only)
+{
+    _backing->AddRef();
+    void *memory = MeshArena::AllocateAligned(sizeof(GeometryBuffer));
+    return new (memory) GeometryBuffer(_data, _size, _backing, _read_only, true);
+}
+
+core::GeometryBuffer *core::GeometryBuffer::Clone(void) const
+{
+    GeometryBuffer *copy = Create(size);
+    memcpy(copy->data, data, size);
+    return copy;
+}
+
+void core::GeometryBuffer::Destroy(void)
+{
+    SharedStorage *owner = backing;
+    bool view = is_view;
+    this->~GeometryBuffer();
+
+    // Arena memory is reclaimed with the arena, heap buffers are their own allocation and views
+    // only own their header.
+    if (owner)
+        owner->Release();
+    if (!owner || view)
+        MeshArena::FreeAligned(this);
+}
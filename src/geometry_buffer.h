@@ -0,0 +1,98 @@
+/**
+ * @file geometry_buffer.h
+ * @brief Reference counted block holding the arrays of one or more meshes.
+ */
+#ifndef GEOMETRY_BUFFER_H_INCLUDED
+#define GEOMETRY_BUFFER_H_INCLUDED
+
+#include <cstddef>
+#include "shared_storage.h"
+#include "mesh_arena.h"
+
+namespace core {
+
+    /**
+     * @brief A block of geometry data (vertex attributes and indices) shared between meshes.
+     * @remarks The header lives right in front of the data, in the same allocation, which either
+     * comes from the heap or from a 'MeshArena' (in which case the buffer holds a reference on the
+     * arena).
+     * @remarks Treated as immutable once shared: a mesh must call 'Mesh::MakeWritable' before
+     * modifying its arrays, which clones the buffer if anyone else references it.
+     */
+    class GeometryBuffer: public SharedStorage
+    {
+    public:
+        /**
+         * @brief Creates a buffer of @a size bytes, the data is aligned on MESH_ARRAY_ALIGNMENT.
+         * @param size The size of the data in bytes.
+         * @param arena The arena to place the buffer in, or NULL for a heap allocation.
+         * @return The new buffer with a reference count of 1.
+         */
+        static GeometryBuffer *Create(size_t size, MeshArena *arena = NULL);
+
+        /**
+         * @brief Creates a buffer over memory owned by someone else (i.e. a mapped file), nothing
+         * is copied. Only the header is allocated, on the heap.
+         * @param _data The start of the data, which should be aligned on MESH_ARRAY_ALIGNMENT.
+         * @param _size The size of the data in bytes.
+         * @param _backing The owner of the memory, the buffer holds a reference on it.
+         * @param _read_only Whether the memory cannot be written to, writers then work on a clone.
+         * @return The new buffer with a reference count of 1.
+         */
+        static GeometryBuffer *CreateView(char *_data, size_t _size, SharedStorage *_backing, bool _read_only = true);
+
+        /// Returns the number of bytes 'Create' needs to store @a size bytes of data.
+        static size_t GetAllocationSize(size_t size)
+        {
+            return MeshArena::AlignSize(sizeof(GeometryBuffer)) + MeshArena::AlignSize(size);
+        }
+
+        /// Returns a heap allocated copy of the buffer, with a reference count of 1.
+        GeometryBuffer *Clone(void) const;
+
+        /// Returns the start of the data.
+        char *GetData(void) const
+        {
+            return data;
+        }
+
+        /// Returns the size of the data in bytes.
+        size_t GetSize(void) const
+        {
+            return size;
+        }
+
+        /// Whether the data can never be written to (i.e. it is backed by read only memory).
+        bool IsReadOnly(void) const
+        {
+            return read_only;
+        }
+
+        /// Whether a writer can modify the data in place.
+        bool IsWritable(void) const
+        {
+            return !read_only && GetReferenceCount() == 1;
+        }
+
+    protected:
+        GeometryBuffer(char *_data, size_t _size, SharedStorage *_backing, bool _read_only, bool _is_view = false):
+            data(_data), size(_size), backing(_backing), read_only(_read_only), is_view(_is_view) {}
+
+        virtual ~GeometryBuffer() {}
+
+        /// Releases the memory back to the heap or the reference to the backing storage.
+        virtual void Destroy(void);
+
+    private:
+        /// The geometry data.
+        char *data;
+        size_t size;
+        /// The owner of the memory (arena or view), NULL when the buffer is a heap allocation of its own.
+        SharedStorage *backing;
+        bool read_only;
+        /// Whether the header is a heap allocation separate from the data.
+        bool is_view;
+    };
+}
+
+#endif // GEOMETRY_BUFFER_H_INCLUDED
@@ -0,0 +1,200 @@
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include "geometry_deduplicator.h"
+
+/// Tolerances of the final comparison, positions are relative to the size of the mesh.
+#define DEDUPLICATION_POSITION_EPSILON 1e-4f
+#define DEDUPLICATION_DIRECTION_EPSILON 1e-3f
+#define DEDUPLICATION_UV_EPSILON 1e-5f
+
+/**
+ * @brief Computes the frame of the first non degenerate triangle of @a mesh: its first corner
+ * is the origin, the x axis goes along its first edge and the z axis along its normal.
+ * @param [out] frame Transformation from the canonical space to the mesh space.
+ * @return False if every triangle is degenerate.
+ */
+static bool ComputeCanonicalFrame(const core::Mesh &mesh, math::Matrix4D &frame)
+{
+    for (unsigned int i = 0; i + 2 < mesh.index_array_size; i += 3) {
+        const float *p0 = mesh.vertices + mesh.index_array[i + 0] * 4;
+        const float *p1 = mesh.vertices + mesh.index_array[i + 1] * 4;
+        const float *p2 = mesh.vertices + mesh.index_array[i + 2] * 4;
+        math::Vector3D e1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+        math::Vector3D e2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+        math::Vector3D z = e1.CrossProduct(e2);
+
+        float length = e1.Length(math::PRECISE);
+        if (length <= 0.f || z.Length(math::PRECISE) <= 1e-6f * length * e2.Length(math::PRECISE))
+            continue;
+
+        math::Vector3D x = e1;
+        x.Normalize(math::PRECISE);
+        z.Normalize(math::PRECISE);
+        math::Vector3D y = z.CrossProduct(x);
+
+        frame.m00 = x.x; frame.m01 = y.x; frame.m02 = z.x; frame.m03 = p0[0];
+        frame.m10 = x.y; frame.m11 = y.y; frame.m12 = z.y; frame.m13 = p0[1];
+        frame.m20 = x.z; frame.m21 = y.z; frame.m22 = z.z; frame.m23 = p0[2];
+        frame.m30 = 0.f; frame.m31 = 0.f; frame.m32 = 0.f; frame.m33 = 1.f;
+        return true;
+    }
+
+    return false;
+}
+
+/// Transforms the point @a p (3 floats).
+static math::Point3D ToCanonical(const math::Matrix4D &inverse, const float *p)
+{
+    return inverse * math::Point3D(p[0], p[1], p[2]);
+}
+
+/// Rotates the direction @a d (3 floats).
+static math::Vector3D ToCanonicalDirection(const math::Matrix4D &inverse, const float *d)
+{
+    return inverse * math::Vector3D(d[0], d[1], d[2], 0.f);
+}
+
+/// Returns the largest distance of the vertices from the frame origin, rotations do not change it.
+static float ComputeRadius(const core::Mesh &mesh, const math::Matrix4D &frame)
+{
+    float radius = 0.f;
+    for (unsigned int i = 0; i < mesh.vertex_number; ++i) {
+        const float *p = mesh.vertices + i * 4;
+        float dx = p[0] - frame.m03, dy = p[1] - frame.m13, dz = p[2] - frame.m23;
+        radius = std::max(radius, sqrtf(dx * dx + dy * dy + dz * dz));
+    }
+    return radius;
+}
+
+/// FNV-1a over the bytes of @a value.
+template <typename T>
+static void HashValue(unsigned long long &hash, T value)
+{
+    const unsigned char *bytes = (const unsigned char *)&value;
+    for (unsigned int i = 0; i < sizeof(T); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+/**
+ * @brief Hashes the parts of @a mesh that a rigid transformation leaves untouched: the counts, the
+ * corners and the uvs.
+ * @remarks Positions and normals are left to 'IsSameGeometry', once rotated in the canonical frame
+ * they only match within a tolerance, and rounding them for the hash would split copies whose
+ * values straddle a rounding boundary.
+ */
+static unsigned long long HashInvariantGeometry(const core::Mesh &mesh)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    HashValue(hash, mesh.vertex_number);
+    HashValue(hash, mesh.index_array_size);
+    HashValue(hash, mesh.uv_layer_count);
+
+    for (unsigned int i = 0; i < mesh.index_array_size; ++i)
+        HashValue(hash, mesh.index_array[i]);
+
+    for (unsigned int l = 0; l < mesh.uv_layer_count; ++l) {
+        for (unsigned int i = 0; i < mesh.vertex_number * 3; ++i)
+            HashValue(hash, mesh.uv_coordinates[l][i]);
+    }
+
+    return hash;
+}
+
+/// Whether @a a and @a b differ by at most @a epsilon, NaNs (tangents of degenerate uvs) match NaNs.
+static bool IsClose(float a, float b, float epsilon)
+{
+    return fabsf(a - b) <= epsilon || (a != a && b != b);
+}
+
+/// Whether @a a and @a b differ by at most @a epsilon on every axis.
+static bool IsClose(float ax, float ay, float az, float bx, float by, float bz, float epsilon)
+{
+    return IsClose(ax, bx, epsilon) && IsClose(ay, by, epsilon) && IsClose(az, bz, epsilon);
+}
+
+/// Whether the directions @a a and @a b of 2 meshes match once both are in their canonical frame.
+static bool AreDirectionsClose(const math::Matrix4D &inverse_a, const float *a, const math::Matrix4D &inverse_b,
+                               const float *b)
+{
+    math::Vector3D da = ToCanonicalDirection(inverse_a, a);
+    math::Vector3D db = ToCanonicalDirection(inverse_b, b);
+    return IsClose(da.x, da.y, da.z, db.x, db.y, db.z, DEDUPLICATION_DIRECTION_EPSILON);
+}
+
+/// Full comparison of 2 meshes, each expressed in its own canonical frame.
+static bool IsSameGeometry(const core::Mesh &a, const math::Matrix4D &frame_a, const core::Mesh &b,
+                           const math::Matrix4D &frame_b)
+{
+    if (a.vertex_number != b.vertex_number || a.index_array_size != b.index_array_size ||
+        a.uv_layer_count != b.uv_layer_count || a.is_using_colors != b.is_using_colors || a.materials != b.materials)
+        return false;
+
+    if (memcmp(a.index_array, b.index_array, a.index_array_size * sizeof(unsigned short)))
+        return false;
+
+    math::Matrix4D inverse_a = frame_a.RigidInverse(), inverse_b = frame_b.RigidInverse();
+    float radius = ComputeRadius(a, frame_a);
+    float epsilon = DEDUPLICATION_POSITION_EPSILON * (radius > 1.f? radius: 1.f);
+
+    for (unsigned int i = 0; i < a.vertex_number; ++i) {
+        math::Point3D pa = ToCanonical(inverse_a, a.vertices + i * 4);
+        math::Point3D pb = ToCanonical(inverse_b, b.vertices + i * 4);
+        if (!IsClose(pa.x, pa.y, pa.z, pb.x, pb.y, pb.z, epsilon))
+            return false;
+
+        if (!AreDirectionsClose(inverse_a, a.normals + i * 3, inverse_b, b.normals + i * 3))
+            return false;
+
+        if (a.is_using_colors && a.colors && b.colors) {
+            const float *ca = a.colors + i * 4, *cb = b.colors + i * 4;
+            if (!IsClose(ca[0], ca[1], ca[2], cb[0], cb[1], cb[2], DEDUPLICATION_UV_EPSILON) || ca[3] != cb[3])
+                return false;
+        }
+
+        for (unsigned int l = 0; l < a.uv_layer_count; ++l) {
+            const float *ua = a.uv_coordinates[l] + i * 3, *ub = b.uv_coordinates[l] + i * 3;
+            if (!IsClose(ua[0], ua[1], ua[2], ub[0], ub[1], ub[2], DEDUPLICATION_UV_EPSILON))
+                return false;
+
+            if (!AreDirectionsClose(inverse_a, a.tangents[l] + i * 3, inverse_b, b.tangents[l] + i * 3) ||
+                !AreDirectionsClose(inverse_a, a.binormals[l] + i * 3, inverse_b, b.binormals[l] + i * 3))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+const core::Mesh *core::GeometryDeduplicator::Find(const Mesh &mesh, math::Matrix4D &placement) const
+{
+    math::Matrix4D frame;
+    if (!mesh.EnsureResident() || !mesh.vertices || !mesh.index_array || !ComputeCanonicalFrame(mesh, frame))
+        return NULL;
+
+    unsigned long long hash = HashInvariantGeometry(mesh);
+    std::pair<std::multimap<unsigned long long, Entry>::const_iterator,
+              std::multimap<unsigned long long, Entry>::const_iterator> range = entries.equal_range(hash);
+
+    for (std::multimap<unsigned long long, Entry>::const_iterator iter = range.first; iter != range.second; ++iter) {
+        if (IsSameGeometry(*iter->second.mesh, iter->second.frame, mesh, frame)) {
+            // Back to the canonical space of the original, then out to the space of 'mesh'.
+            placement = frame * iter->second.frame.RigidInverse();
+            return iter->second.mesh;
+        }
+    }
+
+    return NULL;
+}
+
+void core::GeometryDeduplicator::Add(const Mesh *mesh)
+{
+    Entry entry;
+    if (!mesh->EnsureResident() || !mesh->vertices || !mesh->index_array || !ComputeCanonicalFrame(*mesh, entry.frame))
+        return;
+
+    entry.mesh = mesh;
+    entries.insert(std::make_pair(HashInvariantGeometry(*mesh), entry));
+}
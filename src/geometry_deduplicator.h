@@ -0,0 +1,60 @@
+/**
+ * @file geometry_deduplicator.h
+ * @brief Finds meshes that are copies of each other up to a rigid transformation.
+ */
+#ifndef GEOMETRY_DEDUPLICATOR_H_INCLUDED
+#define GEOMETRY_DEDUPLICATOR_H_INCLUDED
+
+#include <map>
+#include "mesh.h"
+#include "matrix.h"
+
+namespace core {
+
+    /**
+     * @brief Matches meshes against the ones registered so far, so that duplicated props can share
+     * a single geometry buffer and only differ by their model transformation.
+     * @remarks Each mesh is canonicalized in the frame of its first non degenerate triangle, which
+     * makes the comparison independent of translations and rotations. The corners and uvs are
+     * hashed, and the candidates with the same hash have their canonical positions, normals and
+     * tangent frames compared with a tolerance.
+     * @remarks Mirrored or scaled copies are not detected.
+     */
+    class GeometryDeduplicator
+    {
+    public:
+        GeometryDeduplicator() {}
+
+        /**
+         * @brief Looks for a registered mesh with the same geometry and materials as @a mesh.
+         * @param mesh The mesh to look for.
+         * @param [out] placement The transformation that moves the found mesh onto @a mesh.
+         * @return The registered mesh, or NULL if there is none.
+         */
+        const Mesh *Find(const Mesh &mesh, math::Matrix4D &placement) const;
+
+        /// Registers @a mesh as an original, it must stay alive while the deduplicator is used.
+        void Add(const Mesh *mesh);
+
+        /// Removes all registered meshes.
+        void Clear(void)
+        {
+            entries.clear();
+        }
+
+    private:
+        /// A registered mesh, with its canonical frame.
+        class Entry
+        {
+        public:
+            const Mesh *mesh;
+            math::Matrix4D frame;
+        };
+
+    private:
+        /// Registered meshes by hash of their corners and uvs.
+        std::multimap<unsigned long long, Entry> entries;
+    };
+}
+
+#endif // GEOMETRY_DEDUPLICATOR_H_INCLUDED
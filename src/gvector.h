@@ -8,88 +8,97 @@
 #include <math.h>
 #include <limits>
 #include "point.h"
+#include "simd.h"
 
 namespace math {
 
     /**
      * @brief 3D vector class.
+     * @remarks The 4 floats are loaded in a SIMD register by the arithmetic operators (see
+     * 'simd'), w included, the results are the same as computing each component.
      */
     class Vector3D
     {
     public:
-        Vector3D(): x(0), y(1), z(0), w(0) {}
-        Vector3D(const Vector3D &vec) { *this = vec; }
-        Vector3D(float _x, float _y, float _z, float _w = 0.f): x(_x), y(_y), z(_z), w(_w) {}
-        Vector3D(const Point3D &A, const Point3D &B): x(B.x - A.x), y(B.y - A.y), z(B.z - A.z), w(B.w - A.w) {}
-        ~Vector3D() {}
+        constexpr Vector3D(): x(0), y(1), z(0), w(0) {}
+        constexpr Vector3D(float _x, float _y, float _z, float _w = 0.f): x(_x), y(_y), z(_z), w(_w) {}
+        Vector3D(const Point3D &A, const Point3D &B) { simd::Store(&x, simd::Subtract(B.GetRegister(), A.GetRegister())); }
+        explicit Vector3D(simd::float4 value) { simd::Store(&x, value); }
+
+        /// Returns x, y, z and w in a SIMD register.
+        simd::float4 GetRegister(void) const
+        {
+            return simd::Load(&x);
+        }
 
         /// Multiply a vector by a scalar.
         Vector3D operator *(float scale) const
         {
-            return Vector3D(x * scale, y * scale, z * scale, w * scale);
+            return Vector3D(simd::Multiply(GetRegister(), simd::Splat(scale)));
         }
 
         Vector3D operator *=(float scale)
         {
-            x *= scale;
-            y *= scale;
-            z *= scale;
-            w *= scale;
+            simd::Store(&x, simd::Multiply(GetRegister(), simd::Splat(scale)));
             return *this;
         }
 
         /// Subtracts 2 vectors.
         Vector3D operator -(const Vector3D &vec) const
         {
-             return Vector3D(x - vec.x, y - vec.y, z - vec.z, w - vec.w);
+             return Vector3D(simd::Subtract(GetRegister(), vec.GetRegister()));
         }
 
         /// Overloading unary - operator.
         Vector3D operator -(void) const
         {
-            return Vector3D(-x, -y, -z, w);
+            return Vector3D(simd::Negate3(GetRegister()));
         }
 
         Vector3D operator -=(const Vector3D &vec)
         {
-            x -= vec.x;
-            y -= vec.y;
-            z -= vec.z;
-            w -= vec.w;
+            simd::Store(&x, simd::Subtract(GetRegister(), vec.GetRegister()));
             return *this;
         }
 
         /// Add 2 vectors.
         Vector3D operator +(const Vector3D &vec) const
         {
-            return Vector3D(x + vec.x, y + vec.y, z + vec.z, w + vec.w);
+            return Vector3D(simd::Add(GetRegister(), vec.GetRegister()));
         }
 
         Vector3D operator +=(const Vector3D &vec)
         {
-            x += vec.x;
-            y += vec.y;
-            z += vec.z;
-            w += vec.w;
+            simd::Store(&x, simd::Add(GetRegister(), vec.GetRegister()));
             return *this;
         }
 
-        /// Returns the length of the vector.
-        float Length(void) const
+        /// Returns the squared length of the vector, compare it to squared distances to avoid the square root.
+        float LengthSquared(void) const
+        {
+            simd::float4 value = GetRegister();
+            return simd::Dot3(value, value);
+        }
+
+        /// Returns the length of the vector, see 'Precision'.
+        float Length(Precision precision = DEFAULT_PRECISION) const
         {
-            return sqrtf(x * x + y * y + z * z);
+            float length_sqr = LengthSquared();
+            if (precision == PRECISE)
+                return sqrtf(length_sqr);
+            return (length_sqr > 0.f)? length_sqr * ReciprocalSqrt(length_sqr, FAST): 0.f;
         }
 
         /// Returns the dot product.
         float DotProduct(const Vector3D &vec) const
         {
-            return x * vec.x + y * vec.y + z * vec.z;
+            return simd::Dot3(GetRegister(), vec.GetRegister());
         }
 
         /// Returns the resultant vector.
         Vector3D CrossProduct(const Vector3D &vec) const
         {
-            return Vector3D(y * vec.z - vec.y * z, vec.x * z - x * vec.z, x * vec.y - vec.x * y);
+            return Vector3D(simd::Cross3(GetRegister(), vec.GetRegister()));
         }
 
         /// Compares equality within an epsilon difference.
@@ -104,13 +113,18 @@ namespace math {
             return false;
         }
 
-        /// Normalizes the current vector.
-        void Normalize(void)
+        /// Normalizes the current vector, w is left as is. See 'Precision'.
+        void Normalize(Precision precision = DEFAULT_PRECISION)
         {
-            float length = Length();
-            x /= length;
-            y /= length;
-            z /= length;
+            simd::float4 value = GetRegister();
+            if (precision == PRECISE) {
+                float length = sqrtf(simd::Dot3(value, value));
+                simd::Store(&x, simd::Divide(value, simd::Set(length, length, length, 1.f)));
+                return;
+            }
+
+            float inverse = ReciprocalSqrt(simd::Dot3(value, value), FAST);
+            simd::Store(&x, simd::Multiply(value, simd::Set(inverse, inverse, inverse, 1.f)));
         }
 
     public:
@@ -120,19 +134,19 @@ namespace math {
     /// Multiply a scalar with a vector.
 	static Vector3D operator *(float scale, const Vector3D &vec)
 	{
-        return Vector3D(vec.x * scale, vec.y * scale, vec.z * scale, vec.w * scale);
+        return Vector3D(simd::Multiply(vec.GetRegister(), simd::Splat(scale)));
     }
 
     /// Add a point and a vector.
 	static Point3D operator +(const Point3D &pt, const Vector3D &vec)
 	{
-        return Point3D(pt.x + vec.x, pt.y + vec.y, pt.z + vec.z, pt.w + vec.w);
+        return Point3D(simd::Add(pt.GetRegister(), vec.GetRegister()));
     }
 
     /// Returns the vector resulting from the difference between 2 points.
 	static Vector3D operator -(const Point3D &pt1, const Point3D &pt2)
 	{
-        return Vector3D(pt1.x - pt2.x, pt1.y - pt2.y, pt1.z - pt2.z, pt1.w - pt2.w);
+        return Vector3D(simd::Subtract(pt1.GetRegister(), pt2.GetRegister()));
     }
 }
 
@@ -0,0 +1,632 @@
+#include <cmath>
+#include <cfloat>
+#include <atomic>
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include "hull_generator.h"
+#include "gvector.h"
+#include "job_system.h"
+#include "transform_batch.h"
+
+/// Hull face being built, the plane is kept in double precision.
+struct HullFace
+{
+    unsigned int v[3];
+    double normal[3];
+    double d;
+    /// Points above the face not yet on the hull, and the furthest one.
+    std::vector<unsigned int> outside;
+    unsigned int furthest;
+    double furthest_distance;
+    bool alive;
+};
+
+/// Incremental Quickhull state.
+class Quickhull
+{
+public:
+    Quickhull(const float *_points, unsigned int _count, unsigned int _stride):
+        points(_points), count(_count), stride(_stride), epsilon(0.0), vertex_count(0), limited(false) {}
+
+    /// Runs the algorithm until every point is inside or @a max_vertices is reached.
+    bool Build(unsigned int max_vertices);
+
+    /// Copies the result in @a hull, the planes are pushed out to enclose every point.
+    void Output(core::ConvexHull &hull) const;
+
+private:
+    void GetPoint(unsigned int i, double p[3]) const
+    {
+        const float *point = points + (size_t)i * stride;
+        p[0] = point[0];
+        p[1] = point[1];
+        p[2] = point[2];
+    }
+
+    double GetDistance(const HullFace &face, unsigned int i) const
+    {
+        double p[3];
+        GetPoint(i, p);
+        return face.normal[0] * p[0] + face.normal[1] * p[1] + face.normal[2] * p[2] + face.d;
+    }
+
+    static unsigned long long EdgeKey(unsigned int a, unsigned int b)
+    {
+        return ((unsigned long long)a << 32) | b;
+    }
+
+    bool BuildInitialSimplex(void);
+    unsigned int AddFace(unsigned int a, unsigned int b, unsigned int c);
+    void KillFace(unsigned int face);
+    void AssignPoint(unsigned int point, const std::vector<unsigned int> &candidates);
+    void QueueFaces(const std::vector<unsigned int> &candidates);
+    void AddPoint(unsigned int face);
+
+private:
+    const float *points;
+    unsigned int count;
+    unsigned int stride;
+    double epsilon;
+    unsigned int vertex_count;
+    /// Whether the vertex budget stopped the hull before every point was enclosed.
+    bool limited;
+
+    std::vector<HullFace> faces;
+    /// Faces with outside points by distance of their furthest point, dead faces are skipped when popped.
+    std::priority_queue<std::pair<double, unsigned int> > queue;
+    /// Directed edge to the alive face it belongs to.
+    std::unordered_map<unsigned long long, unsigned int> edges;
+};
+
+unsigned int Quickhull::AddFace(unsigned int a, unsigned int b, unsigned int c)
+{
+    HullFace face;
+    face.v[0] = a;
+    face.v[1] = b;
+    face.v[2] = c;
+    face.furthest = 0;
+    face.furthest_distance = 0.0;
+    face.alive = true;
+
+    double pa[3], pb[3], pc[3];
+    GetPoint(a, pa);
+    GetPoint(b, pb);
+    GetPoint(c, pc);
+    double u[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+    double v[3] = { pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2] };
+    double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+    double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length > 0.0) {
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+    }
+    face.normal[0] = n[0];
+    face.normal[1] = n[1];
+    face.normal[2] = n[2];
+    face.d = -(n[0] * pa[0] + n[1] * pa[1] + n[2] * pa[2]);
+
+    unsigned int index = (unsigned int)faces.size();
+    faces.push_back(face);
+    edges[EdgeKey(a, b)] = index;
+    edges[EdgeKey(b, c)] = index;
+    edges[EdgeKey(c, a)] = index;
+    return index;
+}
+
+void Quickhull::KillFace(unsigned int face)
+{
+    HullFace &f = faces[face];
+    f.alive = false;
+    for (unsigned int i = 0; i < 3; ++i) {
+        std::unordered_map<unsigned long long, unsigned int>::iterator iter = edges.find(EdgeKey(f.v[i], f.v[(i + 1) % 3]));
+        if (iter != edges.end() && iter->second == face)
+            edges.erase(iter);
+    }
+}
+
+void Quickhull::AssignPoint(unsigned int point, const std::vector<unsigned int> &candidates)
+{
+    // The first face the point is above of owns it, points below every face are inside.
+    for (unsigned int i = 0; i < candidates.size(); ++i) {
+        HullFace &face = faces[candidates[i]];
+        double distance = GetDistance(face, point);
+        if (distance > epsilon) {
+            if (face.outside.empty() || distance > face.furthest_distance) {
+                face.furthest = point;
+                face.furthest_distance = distance;
+            }
+            face.outside.push_back(point);
+            return;
+        }
+    }
+}
+
+void Quickhull::QueueFaces(const std::vector<unsigned int> &candidates)
+{
+    for (unsigned int i = 0; i < candidates.size(); ++i) {
+        if (!faces[candidates[i]].outside.empty())
+            queue.push(std::make_pair(faces[candidates[i]].furthest_distance, candidates[i]));
+    }
+}
+
+bool Quickhull::BuildInitialSimplex(void)
+{
+    if (count < 4)
+        return false;
+
+    // Extreme points on each axis, and the scale of the cloud for the tolerance.
+    unsigned int extremes[6] = { 0, 0, 0, 0, 0, 0 };
+    double minimum[3], maximum[3], p[3];
+    GetPoint(0, minimum);
+    GetPoint(0, maximum);
+    for (unsigned int i = 1; i < count; ++i) {
+        GetPoint(i, p);
+        for (unsigned int k = 0; k < 3; ++k) {
+            if (p[k] < minimum[k]) { minimum[k] = p[k]; extremes[k * 2] = i; }
+            if (p[k] > maximum[k]) { maximum[k] = p[k]; extremes[k * 2 + 1] = i; }
+        }
+    }
+
+    double scale = std::max(std::max(fabs(minimum[0]), fabs(maximum[0])), std::max(fabs(minimum[1]), fabs(maximum[1])));
+    scale = std::max(scale, std::max(fabs(minimum[2]), fabs(maximum[2])));
+    epsilon = 3.0 * scale * FLT_EPSILON;
+
+    // The 2 most distant extremes.
+    unsigned int i0 = 0, i1 = 0;
+    double best = -1.0;
+    for (unsigned int a = 0; a < 6; ++a) {
+        for (unsigned int b = a + 1; b < 6; ++b) {
+            double pa[3], pb[3];
+            GetPoint(extremes[a], pa);
+            GetPoint(extremes[b], pb);
+            double d = (pa[0] - pb[0]) * (pa[0] - pb[0]) + (pa[1] - pb[1]) * (pa[1] - pb[1]) + (pa[2] - pb[2]) * (pa[2] - pb[2]);
+            if (d > best) {
+                best = d;
+                i0 = extremes[a];
+                i1 = extremes[b];
+            }
+        }
+    }
+    if (sqrt(best) <= epsilon)
+        return false;
+
+    // The point furthest from the line.
+    double p0[3], p1[3];
+    GetPoint(i0, p0);
+    GetPoint(i1, p1);
+    double axis[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    unsigned int i2 = 0;
+    best = -1.0;
+    for (unsigned int i = 0; i < count; ++i) {
+        GetPoint(i, p);
+        double w[3] = { p[0] - p0[0], p[1] - p0[1], p[2] - p0[2] };
+        double c[3] = { axis[1] * w[2] - axis[2] * w[1], axis[2] * w[0] - axis[0] * w[2], axis[0] * w[1] - axis[1] * w[0] };
+        double d = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+        if (d > best) {
+            best = d;
+            i2 = i;
+        }
+    }
+    if (sqrt(best) / sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) <= epsilon)
+        return false;
+
+    // The point furthest from the plane.
+    unsigned int base = AddFace(i0, i1, i2);
+    unsigned int i3 = 0;
+    best = 0.0;
+    for (unsigned int i = 0; i < count; ++i) {
+        double d = GetDistance(faces[base], i);
+        if (fabs(d) > fabs(best)) {
+            best = d;
+            i3 = i;
+        }
+    }
+    KillFace(base);
+    faces.clear();
+    if (fabs(best) <= epsilon)
+        return false;
+
+    // Orient the faces outward, i3 must be below the base.
+    if (best > 0.0)
+        std::swap(i0, i1);
+
+    std::vector<unsigned int> initial;
+    initial.push_back(AddFace(i0, i1, i2));
+    initial.push_back(AddFace(i1, i0, i3));
+    initial.push_back(AddFace(i2, i1, i3));
+    initial.push_back(AddFace(i0, i2, i3));
+    vertex_count = 4;
+
+    for (unsigned int i = 0; i < count; ++i) {
+        if (i != i0 && i != i1 && i != i2 && i != i3)
+            AssignPoint(i, initial);
+    }
+    QueueFaces(initial);
+
+    return true;
+}
+
+void Quickhull::AddPoint(unsigned int face)
+{
+    unsigned int eye = faces[face].furthest;
+
+    // Flood the faces visible from the point, starting from the one it is above of.
+    std::vector<unsigned int> visible(1, face);
+    std::vector<unsigned int> horizon;
+    faces[face].alive = false;
+    for (unsigned int i = 0; i < visible.size(); ++i) {
+        const HullFace &f = faces[visible[i]];
+        for (unsigned int k = 0; k < 3; ++k) {
+            unsigned int a = f.v[k], b = f.v[(k + 1) % 3];
+            std::unordered_map<unsigned long long, unsigned int>::const_iterator iter = edges.find(EdgeKey(b, a));
+            if (iter == edges.end())
+                continue;
+
+            unsigned int neighbor = iter->second;
+            if (!faces[neighbor].alive)
+                continue;
+
+            if (GetDistance(faces[neighbor], eye) > epsilon) {
+                faces[neighbor].alive = false;
+                visible.push_back(neighbor);
+            }
+        }
+    }
+
+    // The horizon: edges of visible faces whose neighbor stays.
+    for (unsigned int i = 0; i < visible.size(); ++i) {
+        const HullFace &f = faces[visible[i]];
+        for (unsigned int k = 0; k < 3; ++k) {
+            unsigned int a = f.v[k], b = f.v[(k + 1) % 3];
+            std::unordered_map<unsigned long long, unsigned int>::const_iterator iter = edges.find(EdgeKey(b, a));
+            if (iter != edges.end() && faces[iter->second].alive) {
+                horizon.push_back(a);
+                horizon.push_back(b);
+            }
+        }
+    }
+
+    std::vector<unsigned int> orphans;
+    for (unsigned int i = 0; i < visible.size(); ++i) {
+        std::vector<unsigned int> &outside = faces[visible[i]].outside;
+        orphans.insert(orphans.end(), outside.begin(), outside.end());
+        std::vector<unsigned int>().swap(outside);
+        KillFace(visible[i]);
+    }
+
+    // Close the hole with a cone of faces to the point.
+    std::vector<unsigned int> created;
+    for (unsigned int i = 0; i < horizon.size(); i += 2)
+        created.push_back(AddFace(horizon[i], horizon[i + 1], eye));
+
+    for (unsigned int i = 0; i < orphans.size(); ++i) {
+        if (orphans[i] != eye)
+            AssignPoint(orphans[i], created);
+    }
+    QueueFaces(created);
+
+    ++vertex_count;
+}
+
+bool Quickhull::Build(unsigned int max_vertices)
+{
+    if (!BuildInitialSimplex())
+        return false;
+
+    // Take the point furthest from the current hull, so a limited hull keeps the main features.
+    while (!queue.empty()) {
+        unsigned int face = queue.top().second;
+        if (!faces[face].alive) {
+            queue.pop();
+            continue;
+        }
+
+        if (vertex_count >= max_vertices) {
+            limited = true;
+            break;
+        }
+        queue.pop();
+        AddPoint(face);
+    }
+
+    return true;
+}
+
+void Quickhull::Output(core::ConvexHull &hull) const
+{
+    hull.vertices.clear();
+    hull.indices.clear();
+    hull.planes.clear();
+
+    std::unordered_map<unsigned int, unsigned int> remap;
+    for (unsigned int i = 0; i < faces.size(); ++i) {
+        if (!faces[i].alive)
+            continue;
+
+        const HullFace &face = faces[i];
+        for (unsigned int k = 0; k < 3; ++k) {
+            std::unordered_map<unsigned int, unsigned int>::iterator iter = remap.find(face.v[k]);
+            if (iter == remap.end()) {
+                iter = remap.insert(std::make_pair(face.v[k], (unsigned int)hull.vertices.size() / 3)).first;
+                const float *point = points + (size_t)face.v[k] * stride;
+                hull.vertices.insert(hull.vertices.end(), point, point + 3);
+            }
+            hull.indices.push_back(iter->second);
+        }
+
+        // Coplanar faces share their plane.
+        bool duplicate = false;
+        for (unsigned int p = 0; p < hull.planes.size() && !duplicate; p += 4) {
+            double dot = hull.planes[p] * face.normal[0] + hull.planes[p + 1] * face.normal[1] + hull.planes[p + 2] * face.normal[2];
+            duplicate = dot > 1.0 - 1e-5 && fabs(hull.planes[p + 3] - face.d) <= epsilon * 4.0;
+        }
+        if (!duplicate) {
+            hull.planes.push_back((float)face.normal[0]);
+            hull.planes.push_back((float)face.normal[1]);
+            hull.planes.push_back((float)face.normal[2]);
+            hull.planes.push_back((float)face.d);
+        }
+    }
+
+    // A limited hull can leave points outside, move the planes out so they are enclosed.
+    for (unsigned int p = 0; limited && p < hull.planes.size(); p += 4) {
+        float furthest = 0.f;
+        for (unsigned int i = 0; i < count; ++i) {
+            const float *point = points + (size_t)i * stride;
+            float d = hull.planes[p] * point[0] + hull.planes[p + 1] * point[1] + hull.planes[p + 2] * point[2] + hull.planes[p + 3];
+            furthest = std::max(furthest, d);
+        }
+        hull.planes[p + 3] -= furthest;
+    }
+}
+
+bool core::HullGenerator::BuildHull(const float *points, unsigned int count, unsigned int stride,
+                                    unsigned int max_vertices, ConvexHull &hull)
+{
+    hull = ConvexHull();
+    if (!points || stride < 3)
+        return false;
+
+    Quickhull quickhull(points, count, stride);
+    if (!quickhull.Build(std::max(max_vertices, 4u)))
+        return false;
+
+    quickhull.Output(hull);
+    return true;
+}
+
+/// A set of triangles of a mesh being decomposed, with its hull.
+struct HullPart
+{
+    std::vector<unsigned int> triangles;
+    core::ConvexHull hull;
+    float concavity;
+    bool final;
+};
+
+/// Builds the hull of the triangles of @a part and measures how concave the part is.
+static bool BuildPartHull(const core::Mesh &mesh, HullPart &part, unsigned int max_vertices)
+{
+    std::vector<float> points;
+    std::vector<bool> used(mesh.vertex_number, false);
+    for (unsigned int i = 0; i < part.triangles.size(); ++i) {
+        for (unsigned int k = 0; k < 3; ++k) {
+            unsigned int v = mesh.index_array[part.triangles[i] * 3 + k];
+            if (v < mesh.vertex_number && !used[v]) {
+                used[v] = true;
+                points.insert(points.end(), mesh.vertices + v * 4, mesh.vertices + v * 4 + 3);
+            }
+        }
+    }
+
+    part.concavity = 0.f;
+    part.final = false;
+    if (points.empty() || !core::HullGenerator::BuildHull(&points[0], (unsigned int)points.size() / 3, 3, max_vertices, part.hull))
+        return false;
+
+    // Concavity: the deepest point inside the hull, relative to the hull size.
+    float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (unsigned int i = 0; i < part.hull.vertices.size(); ++i) {
+        minimum[i % 3] = std::min(minimum[i % 3], part.hull.vertices[i]);
+        maximum[i % 3] = std::max(maximum[i % 3], part.hull.vertices[i]);
+    }
+    float size = sqrtf((maximum[0] - minimum[0]) * (maximum[0] - minimum[0]) + (maximum[1] - minimum[1]) * (maximum[1] - minimum[1]) +
+                       (maximum[2] - minimum[2]) * (maximum[2] - minimum[2]));
+
+    // A vertex on a flat cap is on the hull even when its triangle is in a cavity, so measure along
+    // the outward normal of each triangle how far its centroid is from leaving the hull.
+    float depth = 0.f;
+    for (unsigned int i = 0; i < part.triangles.size(); ++i) {
+        const unsigned short *corners = mesh.index_array + part.triangles[i] * 3;
+        const float *a = mesh.vertices + corners[0] * 4;
+        const float *b = mesh.vertices + corners[1] * 4;
+        const float *c = mesh.vertices + corners[2] * 4;
+        math::Vector3D normal = math::Vector3D(b[0] - a[0], b[1] - a[1], b[2] - a[2]).CrossProduct(
+            math::Vector3D(c[0] - a[0], c[1] - a[1], c[2] - a[2]));
+        if (mesh.normals) {
+            // Trust the shading normals over the winding.
+            math::Vector3D shading(0.f, 0.f, 0.f);
+            for (unsigned int k = 0; k < 3; ++k)
+                shading = shading + math::Vector3D(mesh.normals[corners[k] * 3], mesh.normals[corners[k] * 3 + 1], mesh.normals[corners[k] * 3 + 2]);
+            if (normal.DotProduct(shading) < 0.f)
+                normal = -normal;
+        }
+        if (normal.LengthSquared() <= 0.f)
+            continue;
+        normal.Normalize(math::PRECISE);
+
+        math::Point3D centroid((a[0] + b[0] + c[0]) / 3.f, (a[1] + b[1] + c[1]) / 3.f, (a[2] + b[2] + c[2]) / 3.f);
+        float exit = FLT_MAX;
+        for (unsigned int p = 0; p < part.hull.planes.size(); p += 4) {
+            const float *plane = &part.hull.planes[p];
+            float facing = plane[0] * normal.x + plane[1] * normal.y + plane[2] * normal.z;
+            if (facing > 0.f) {
+                float distance = -(plane[0] * centroid.x + plane[1] * centroid.y + plane[2] * centroid.z + plane[3]);
+                exit = std::min(exit, std::max(distance, 0.f) / facing);
+            }
+        }
+        if (exit != FLT_MAX)
+            depth = std::max(depth, exit);
+    }
+    part.concavity = (size > 0.f)? depth / size: 0.f;
+    return true;
+}
+
+/// Splits @a part in 2 along the longest axis of its triangle centroids, returns false if it cannot be split.
+static bool SplitPart(const core::Mesh &mesh, const HullPart &part, HullPart &left, HullPart &right)
+{
+    std::vector<float> centroids(part.triangles.size() * 3);
+    float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    for (unsigned int i = 0; i < part.triangles.size(); ++i) {
+        for (unsigned int a = 0; a < 3; ++a) {
+            float c = 0.f;
+            for (unsigned int k = 0; k < 3; ++k)
+                c += mesh.vertices[mesh.index_array[part.triangles[i] * 3 + k] * 4 + a] / 3.f;
+            centroids[i * 3 + a] = c;
+            minimum[a] = std::min(minimum[a], c);
+            maximum[a] = std::max(maximum[a], c);
+            mean[a] += c;
+        }
+    }
+
+    unsigned int axis = 0;
+    for (unsigned int a = 1; a < 3; ++a) {
+        if (maximum[a] - minimum[a] > maximum[axis] - minimum[axis])
+            axis = a;
+    }
+    float cut = (float)(mean[axis] / part.triangles.size());
+
+    left.triangles.clear();
+    right.triangles.clear();
+    for (unsigned int i = 0; i < part.triangles.size(); ++i) {
+        if (centroids[i * 3 + axis] < cut)
+            left.triangles.push_back(part.triangles[i]);
+        else
+            right.triangles.push_back(part.triangles[i]);
+    }
+
+    return !left.triangles.empty() && !right.triangles.empty();
+}
+
+unsigned int core::HullGenerator::BuildMeshHulls(Mesh &mesh, const HullSettings &settings)
+{
+    mesh.hulls.clear();
+    if (!mesh.EnsureResident() || !mesh.vertices || !mesh.index_array || mesh.index_array_size < 3)
+        return 0;
+
+    std::vector<HullPart> parts(1);
+    for (unsigned int i = 0; i < mesh.index_array_size / 3; ++i)
+        parts[0].triangles.push_back(i);
+    if (!BuildPartHull(mesh, parts[0], settings.max_vertices))
+        return 0;
+
+    // Keep cutting the most concave part while the budget allows.
+    while (parts.size() < settings.max_hulls) {
+        unsigned int worst = (unsigned int)parts.size();
+        for (unsigned int i = 0; i < parts.size(); ++i) {
+            if (!parts[i].final && parts[i].concavity > settings.max_concavity &&
+                (worst == parts.size() || parts[i].concavity > parts[worst].concavity))
+                worst = i;
+        }
+        if (worst == parts.size())
+            break;
+
+        HullPart left, right;
+        if (!SplitPart(mesh, parts[worst], left, right) || !BuildPartHull(mesh, left, settings.max_vertices) ||
+            !BuildPartHull(mesh, right, settings.max_vertices)) {
+            // Flat or too small halves, keep the part whole.
+            parts[worst].final = true;
+            continue;
+        }
+
+        parts[worst] = left;
+        parts.push_back(right);
+    }
+
+    for (unsigned int i = 0; i < parts.size(); ++i)
+        mesh.hulls.push_back(parts[i].hull);
+    return (unsigned int)mesh.hulls.size();
+}
+
+/// Lists the meshes of the hierarchy.
+static void CollectMeshes(core::Model &model, std::vector<core::Mesh *> &meshes)
+{
+    meshes.insert(meshes.end(), model.meshes.begin(), model.meshes.end());
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        CollectMeshes(*model.sub_models[i], meshes);
+}
+
+unsigned int core::HullGenerator::BuildModelHulls(Model &model, const HullSettings &settings)
+{
+    std::vector<Mesh *> meshes;
+    CollectMeshes(model, meshes);
+
+    // Meshes sharing a buffer get the hulls of the first one.
+    std::vector<Mesh *> unique;
+    std::vector<std::pair<Mesh *, Mesh *> > copies;
+    std::unordered_map<const GeometryBuffer *, Mesh *> owners;
+    for (unsigned int i = 0; i < meshes.size(); ++i) {
+        // Lazy meshes are loaded first, the shared payloads can then be recognized.
+        meshes[i]->EnsureResident();
+        const GeometryBuffer *geometry = meshes[i]->GetGeometry();
+        std::unordered_map<const GeometryBuffer *, Mesh *>::iterator iter = owners.find(geometry);
+        if (geometry && iter != owners.end()) {
+            copies.push_back(std::make_pair(meshes[i], iter->second));
+        } else {
+            owners[geometry] = meshes[i];
+            unique.push_back(meshes[i]);
+        }
+    }
+
+    std::atomic<unsigned int> total(0);
+    JobSystem::ParallelFor(0, (unsigned int)unique.size(), 1, [&](unsigned int first, unsigned int last) {
+        for (unsigned int i = first; i < last; ++i)
+            total += BuildMeshHulls(*unique[i], settings);
+    });
+
+    for (unsigned int i = 0; i < copies.size(); ++i) {
+        copies[i].first->hulls = copies[i].second->hulls;
+        total += (unsigned int)copies[i].first->hulls.size();
+    }
+
+    return total;
+}
+
+/**
+ * @brief Gathers the vertices of the hierarchy, @a matrix places @a model in the space of the root.
+ * @remarks Composed as matrices, composing 'math::Transform' loses the shear of a non uniform scale
+ * under a rotation.
+ */
+static void CollectPoints(const core::Model &model, const math::Matrix4D &matrix, std::vector<float> &points)
+{
+    for (unsigned int i = 0; i < model.meshes.size(); ++i) {
+        const core::Mesh *mesh = model.meshes[i];
+        mesh->EnsureResident();
+        if (!mesh->vertices || !mesh->vertex_number)
+            continue;
+
+        size_t first = points.size();
+        points.resize(first + (size_t)mesh->vertex_number * 3);
+        math::TransformPoints(matrix, mesh->vertices, 4, &points[first], 3, mesh->vertex_number);
+    }
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        CollectPoints(*model.sub_models[i], matrix * model.sub_models[i]->transform.ToMatrix4D(), points);
+}
+
+bool core::HullGenerator::BuildModelHull(const Model &model, unsigned int max_vertices, ConvexHull &hull)
+{
+    // The root transformation places the model in its parent, the hull is in model space.
+    std::vector<float> points;
+    CollectPoints(model, math::Matrix4D(), points);
+
+    if (points.empty()) {
+        hull = ConvexHull();
+        return false;
+    }
+
+    return BuildHull(&points[0], (unsigned int)points.size() / 3, 3, max_vertices, hull);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file hull_generator.h
+ * @brief Builds convex hulls and convex decompositions of meshes.
+ */
+#ifndef HULL_GENERATOR_H_INCLUDED
+#define HULL_GENERATOR_H_INCLUDED
+
+#include "convex_hull.h"
+#include "model.h"
+
+namespace core {
+
+    /// Parameters of the collision proxies generation.
+    class HullSettings
+    {
+    public:
+        HullSettings(): max_vertices(32), max_hulls(1), max_concavity(0.05f) {}
+
+    public:
+        /// Vertex budget of each hull, the Quickhull iterations stop once it is reached (minimum 4).
+        unsigned int max_vertices;
+        /// Maximum number of hulls per mesh, 1 disables the convex decomposition.
+        unsigned int max_hulls;
+        /**
+         * @brief Decomposition stops once every part has a concavity below this: the deepest
+         * source vertex inside its hull, relative to the size of the hull.
+         */
+        float max_concavity;
+    };
+
+    /**
+     * @brief Quickhull based convex hull generation, with an approximate convex decomposition for
+     * concave props.
+     * @remarks The decomposition recursively cuts the most concave part in 2 along the longest axis
+     * of its bounds (triangles are assigned by centroid) until it is convex enough or the hull
+     * budget is spent. It is approximate: parts may overlap slightly and nothing is cut through
+     * triangles.
+     */
+    class HullGenerator
+    {
+    public:
+        /**
+         * @brief Builds the convex hull of a point cloud.
+         * @param points The first point.
+         * @param count The number of points.
+         * @param stride The distance in floats between 2 consecutive points.
+         * @param max_vertices The vertex budget of the hull (minimum 4).
+         * @param [out] hull The hull, left empty on failure.
+         * @return False if the points are degenerate (less than 4 points, coplanar...).
+         */
+        static bool BuildHull(const float *points, unsigned int count, unsigned int stride, unsigned int max_vertices,
+                              ConvexHull &hull);
+
+        /**
+         * @brief Builds the collision hulls of @a mesh into 'Mesh::hulls' (in mesh space).
+         * @return The number of hulls generated.
+         */
+        static unsigned int BuildMeshHulls(Mesh &mesh, const HullSettings &settings = HullSettings());
+
+        /**
+         * @brief Builds the collision hulls of every mesh of the hierarchy, spread over the job
+         * system workers. Meshes sharing their geometry are only processed once.
+         * @return The number of hulls generated.
+         */
+        static unsigned int BuildModelHulls(Model &model, const HullSettings &settings = HullSettings());
+
+        /**
+         * @brief Builds a single hull enclosing the whole hierarchy, in the space of @a model (the
+         * transformations of the sub models are applied).
+         * @return False if the hierarchy has no usable geometry.
+         */
+        static bool BuildModelHull(const Model &model, unsigned int max_vertices, ConvexHull &hull);
+    };
+}
+
+#endif // HULL_GENERATOR_H_INCLUDED
@@ -0,0 +1,65 @@
+/**
+ * @file instance_buffer.h
+ * @brief Per instance data for instanced drawing.
+ */
+#ifndef INSTANCE_BUFFER_H_INCLUDED
+#define INSTANCE_BUFFER_H_INCLUDED
+
+#include <vector>
+#include "matrix.h"
+
+namespace core {
+
+    /**
+     * @brief Holds the transformations of the instances of a mesh, stored contiguously as column
+     * major 4x4 matrices (the layout OpenGL and instance vertex streams expect).
+     * @remarks Meant to be kept around and refilled every frame, clearing keeps the memory.
+     */
+    class InstanceBuffer
+    {
+    public:
+        InstanceBuffer() {}
+
+        /// Reserves room for @a count instances.
+        void Reserve(unsigned int count)
+        {
+            data.reserve(count * 16);
+        }
+
+        /// Removes all instances.
+        void Clear(void)
+        {
+            data.clear();
+        }
+
+        /// Appends an instance placed by @a transform.
+        void Add(const math::Matrix4D &transform)
+        {
+            data.resize(data.size() + 16);
+            transform.ToArrayColumnMajor(&data[data.size() - 16]);
+        }
+
+        /// Replaces the transformation of the instance @a index.
+        void Set(unsigned int index, const math::Matrix4D &transform)
+        {
+            transform.ToArrayColumnMajor(&data[index * 16]);
+        }
+
+        /// Returns the number of instances.
+        unsigned int GetCount(void) const
+        {
+            return (unsigned int)(data.size() / 16);
+        }
+
+        /// Returns the matrices, 16 floats per instance.
+        const float *GetData(void) const
+        {
+            return data.empty()? NULL: &data[0];
+        }
+
+    private:
+        std::vector<float> data;
+    };
+}
+
+#endif // INSTANCE_BUFFER_H_INCLUDED
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include "job_system.h"
+
+/// A scheduled job.
+class core::Job
+{
+public:
+    Job(const JobFunction &_function, JobCounter *_signal, JobAffinity _affinity):
+        function(_function), signal(_signal), affinity(_affinity) {}
+
+public:
+    JobFunction function;
+    JobCounter *signal;
+    JobAffinity affinity;
+};
+
+/// The jobs of a worker, the owner works at the back, thieves at the front.
+class JobDeque
+{
+public:
+    std::mutex mutex;
+    std::deque<core::Job *> jobs;
+};
+
+/// State of the scheduler, created by 'Initialize'.
+static std::vector<JobDeque *> deques;
+static std::vector<std::thread> workers;
+static std::mutex main_thread_mutex;
+static std::deque<core::Job *> main_thread_jobs;
+static std::thread::id main_thread_id;
+
+/// Jobs in the worker deques, the idle workers sleep while there are none.
+static std::atomic<int> queued_jobs(0);
+static std::atomic<unsigned int> next_deque(0);
+static std::mutex sleep_mutex;
+static std::condition_variable wake;
+static bool stop = false;
+
+/// Index of the deque of the calling thread, -1 for threads that are not workers.
+static thread_local int worker_index = -1;
+
+void core::JobCounter::Decrement(void)
+{
+    // The counter is not touched once the lock is released, a waiter may destroy it.
+    std::vector<Job *> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        released.swap(waiting);
+    }
+    for (unsigned int i = 0; i < released.size(); ++i)
+        JobSystem::Queue(released[i]);
+}
+
+void core::JobSystem::Initialize(unsigned int thread_count)
+{
+    main_thread_id = std::this_thread::get_id();
+    stop = false;
+    if (!thread_count) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        thread_count = (cores > 1)? cores - 1: 0;
+    }
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+        deques.push_back(new JobDeque());
+    for (unsigned int i = 0; i < thread_count; ++i)
+        workers.push_back(std::thread(&JobSystem::WorkerLoop, i));
+}
+
+void core::JobSystem::Cleanup(void)
+{
+    // The main thread helps with what is left, then the workers are told to stop.
+    for (;;) {
+        unsigned int ran = RunMainThreadJobs();
+        Job *job = Take();
+        if (job)
+            Execute(job);
+        else if (!ran && !queued_jobs.load(std::memory_order_acquire))
+            break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (unsigned int i = 0; i < workers.size(); ++i)
+        workers[i].join();
+    workers.clear();
+
+    for (unsigned int i = 0; i < deques.size(); ++i)
+        delete deques[i];
+    deques.clear();
+}
+
+unsigned int core::JobSystem::GetWorkerCount(void)
+{
+    return (unsigned int)workers.size();
+}
+
+bool core::JobSystem::IsMainThread(void)
+{
+    return std::this_thread::get_id() == main_thread_id;
+}
+
+void core::JobSystem::Schedule(const JobFunction &function, JobCounter *signal, JobCounter *dependency, JobAffinity affinity)
+{
+    Job *job = new Job(function, signal, affinity);
+    if (signal)
+        signal->Increment();
+
+    if (dependency) {
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (dependency->value.load(std::memory_order_acquire)) {
+            dependency->waiting.push_back(job);
+            return;
+        }
+    }
+
+    Queue(job);
+}
+
+void core::JobSystem::Queue(Job *job)
+{
+    if (job->affinity == JOB_MAIN_THREAD) {
+        std::lock_guard<std::mutex> lock(main_thread_mutex);
+        main_thread_jobs.push_back(job);
+        return;
+    }
+
+    if (deques.empty()) {
+        Execute(job);
+        return;
+    }
+
+    // Workers keep their jobs, other threads spread them.
+    unsigned int index = (worker_index >= 0)? (unsigned int)worker_index: next_deque++ % deques.size();
+    {
+        std::lock_guard<std::mutex> lock(deques[index]->mutex);
+        deques[index]->jobs.push_back(job);
+    }
+    queued_jobs.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders the wake up after the check of a worker about to sleep.
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    wake.notify_one();
+}
+
+core::Job *core::JobSystem::Take(void)
+{
+    if (!queued_jobs.load(std::memory_order_acquire))
+        return NULL;
+
+    if (worker_index >= 0) {
+        JobDeque *own = deques[worker_index];
+        std::lock_guard<std::mutex> lock(own->mutex);
+        if (!own->jobs.empty()) {
+            Job *job = own->jobs.back();
+            own->jobs.pop_back();
+            queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    unsigned int count = (unsigned int)deques.size();
+    unsigned int start = (worker_index >= 0)? (unsigned int)worker_index + 1: next_deque.load(std::memory_order_relaxed);
+    for (unsigned int i = 0; i < count; ++i) {
+        JobDeque *victim = deques[(start + i) % count];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->jobs.empty()) {
+            Job *job = victim->jobs.front();
+            victim->jobs.pop_front();
+            queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+void core::JobSystem::Execute(Job *job)
+{
+    job->function();
+    if (job->signal)
+        job->signal->Decrement();
+    delete job;
+}
+
+void core::JobSystem::WorkerLoop(unsigned int index)
+{
+    worker_index = (int)index;
+    for (;;) {
+        Job *job = Take();
+        if (job) {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        while (!queued_jobs.load(std::memory_order_acquire) && !stop)
+            wake.wait(lock);
+        if (stop)
+            return;
+    }
+}
+
+void core::JobSystem::Wait(const JobCounter &counter)
+{
+    bool main_thread = IsMainThread();
+    while (!counter.IsDone()) {
+        if (main_thread && RunMainThreadJobs())
+            continue;
+
+        Job *job = Take();
+        if (job)
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+unsigned int core::JobSystem::RunMainThreadJobs(void)
+{
+    std::deque<Job *> jobs;
+    {
+        std::lock_guard<std::mutex> lock(main_thread_mutex);
+        jobs.swap(main_thread_jobs);
+    }
+
+    for (unsigned int i = 0; i < jobs.size(); ++i)
+        Execute(jobs[i]);
+    return (unsigned int)jobs.size();
+}
+
+void core::JobSystem::ParallelFor(unsigned int begin, unsigned int end, unsigned int grain,
+                                  const std::function<void(unsigned int, unsigned int)> &body)
+{
+    if (begin >= end)
+        return;
+
+    grain = std::max(1u, grain);
+    JobCounter counter;
+    for (unsigned int first = begin; first < end; first += std::min(grain, end - first)) {
+        unsigned int last = first + std::min(grain, end - first);
+        Schedule([&body, first, last]() { body(first, last); }, &counter);
+    }
+
+    Wait(counter);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file job_system.h
+ * @brief Work stealing job scheduler shared by the whole engine.
+ */
+#ifndef JOB_SYSTEM_H_INCLUDED
+#define JOB_SYSTEM_H_INCLUDED
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace core {
+
+    /// Where a job may run.
+    enum JobAffinity
+    {
+        /// Any worker, or a thread waiting on a counter.
+        JOB_ANY_THREAD,
+        /// The main thread only, for API bound work (OpenGL, windowing): see 'RunMainThreadJobs'.
+        JOB_MAIN_THREAD
+    };
+
+    typedef std::function<void(void)> JobFunction;
+
+    class Job;
+
+    /**
+     * @brief Counts unfinished jobs: scheduling a job that signals the counter increments it,
+     * completing the job decrements it. Jobs can depend on a counter, they are only queued once
+     * it reaches 0.
+     * @remarks Counters can also be set and decremented by hand, to make a job wait on several
+     * events (a counter initialized with the number of dependencies, each one decrementing it).
+     */
+    class JobCounter
+    {
+    public:
+        JobCounter(int initial_value = 0): value(initial_value) {}
+        ~JobCounter() {}
+
+        /**
+         * @brief Returns whether the counter reached 0.
+         * @remarks Once true the counter can be destroyed: the lock waits for the decrement that
+         * reached 0 to be done with it.
+         */
+        bool IsDone(void) const
+        {
+            if (value.load(std::memory_order_acquire))
+                return false;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            return true;
+        }
+
+        /// Returns the current value (only meaningful as a hint across threads).
+        int GetValue(void) const
+        {
+            return value.load(std::memory_order_acquire);
+        }
+
+        void Increment(void)
+        {
+            value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Decrements the counter, the jobs depending on it are queued when it reaches 0.
+        void Decrement(void);
+
+    private:
+        friend class JobSystem;
+
+        // Not copyable, jobs point to it.
+        JobCounter(const JobCounter &);
+        JobCounter &operator =(const JobCounter &);
+
+    private:
+        std::atomic<int> value;
+        /// Guards the jobs waiting for the counter to reach 0.
+        mutable std::mutex mutex;
+        std::vector<Job *> waiting;
+    };
+
+    /**
+     * @brief One pool of worker threads, sized to the machine, for every subsystem (importers,
+     * texture decoding, per frame work) instead of each spawning its own threads.
+     * @remarks Each worker owns a deque: jobs scheduled from a worker go to the back of its own
+     * deque and are popped from the back (most recent first, still hot in the cache), idle
+     * workers steal from the front of the others. Jobs scheduled from other threads are spread
+     * over the workers.
+     * @remarks Threads waiting on a counter run jobs in the meantime instead of blocking, so jobs
+     * can wait on the jobs they schedule (see 'ParallelFor').
+     * @remarks Without workers (not initialized, or 'Initialize(1)' on a single core machine)
+     * jobs run inline when they are scheduled.
+     */
+    class JobSystem
+    {
+    public:
+        /**
+         * @brief Starts the workers, called once from the main thread.
+         * @param thread_count Number of workers, 0 for one per core minus the main thread.
+         */
+        static void Initialize(unsigned int thread_count = 0);
+
+        /// Runs the jobs left and stops the workers.
+        static void Cleanup(void);
+
+        /// Returns the number of worker threads.
+        static unsigned int GetWorkerCount(void);
+
+        /// Returns whether the calling thread is the one that initialized the system.
+        static bool IsMainThread(void);
+
+        /**
+         * @brief Schedules a job.
+         * @param function The work.
+         * @param signal Counter incremented now and decremented once the job completes, can be NULL.
+         * @param dependency The job is only queued once this counter reaches 0, can be NULL.
+         * @param affinity Where the job may run.
+         */
+        static void Schedule(const JobFunction &function, JobCounter *signal = NULL, JobCounter *dependency = NULL,
+                             JobAffinity affinity = JOB_ANY_THREAD);
+
+        /**
+         * @brief Returns once @a counter reaches 0, running jobs meanwhile (main thread jobs
+         * included when called from the main thread).
+         */
+        static void Wait(const JobCounter &counter);
+
+        /**
+         * @brief Runs the main thread jobs queued so far, called once per frame by the main loop.
+         * @return The number of jobs run.
+         */
+        static unsigned int RunMainThreadJobs(void);
+
+        /**
+         * @brief Splits [begin, end) in ranges of @a grain indices, calls @a body on each range
+         * from the workers and returns once they are all done. The calling thread helps.
+         */
+        static void ParallelFor(unsigned int begin, unsigned int end, unsigned int grain,
+                                const std::function<void(unsigned int, unsigned int)> &body);
+
+    private:
+        friend class JobCounter;
+
+        /// Queues a job whose dependency is done.
+        static void Queue(Job *job);
+
+        /// Takes a job for the calling thread (own deque, then stealing), NULL if there are none.
+        static Job *Take(void);
+
+        /// Runs @a job and signals its counter.
+        static void Execute(Job *job);
+
+        /// Body of the worker threads.
+        static void WorkerLoop(unsigned int index);
+    };
+}
+
+#endif // JOB_SYSTEM_H_INCLUDED
@@ -121,8 +121,8 @@
 
             float t, tprime;
             if (!ISZERO(condition1, std::numeric_limits<float>::epsilon())) {
-                t = (a2 * (yB - yA) + b2 * (xA - xB))/condition1;
-                tprime = (a1 * (yB - yA) + b1 * (xA - xB))/condition1;
+                t = (a2 * (yA - yB) + b2 * (xB - xA))/condition1;
+                tprime = (a1 * (yA - yB) + b1 * (xB - xA))/condition1;
             } else if (!ISZERO(condition2, std::numeric_limits<float>::epsilon())) {
                 t = (-(c2 * (yA - yB) + b2 * (zB - zA)))/condition2;
                 tprime = (-(c1 * (yA - yB) + b1 * (zB - zA)))/condition2;
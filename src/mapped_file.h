@@ -0,0 +1,58 @@
+/**
+ * @file mapped_file.h
+ * @brief Read only memory mapping of a file.
+ */
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include <string>
+#include "shared_storage.h"
+
+namespace core {
+
+    /**
+     * @brief A whole file mapped read only in the address space, the pages are only read from disk
+     * when first touched.
+     * @remarks Reference counted so that buffers pointing into the file (see
+     * 'GeometryBuffer::CreateView') keep the mapping alive, the file is unmapped with the last
+     * reference.
+     */
+    class MappedFile: public SharedStorage
+    {
+    public:
+        /**
+         * @brief Maps the file at @a file_path.
+         * @return The mapping with a reference count of 1, or NULL if the file cannot be opened or
+         * is empty.
+         */
+        static MappedFile *Open(const std::string &file_path);
+
+        /// Returns the start of the file content.
+        const char *GetData(void) const
+        {
+            return data;
+        }
+
+        /// Returns the size of the file in bytes.
+        size_t GetSize(void) const
+        {
+            return size;
+        }
+
+    protected:
+        MappedFile(void *_file, void *_mapping, const char *_data, size_t _size):
+            file(_file), mapping(_mapping), data(_data), size(_size) {}
+
+        /// Unmaps the view and closes the handles.
+        virtual ~MappedFile();
+
+    private:
+        /// The file and file mapping handles.
+        void *file;
+        void *mapping;
+        const char *data;
+        size_t size;
+    };
+}
+
+#endif // MAPPED_FILE_H_INCLUDED
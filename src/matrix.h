@@ -20,12 +20,11 @@ namespace math {
     class Matrix3D
     {
     public:
-        Matrix3D()
-        {
-            // Initialize to identity matrix.
-            m00 = m01 = m02 = m10 = m11 = m12 = m20 = m21 = m22 = 0.f;
-            m00 = m11 = m22 = 1.f;
-        }
+        /// Initialize to identity matrix.
+        constexpr Matrix3D():
+            m00(1.f), m01(0.f), m02(0.f),
+            m10(0.f), m11(1.f), m12(0.f),
+            m20(0.f), m21(0.f), m22(1.f) {}
 
         /**
          * @brief Returns the determinant.
@@ -184,13 +183,22 @@ namespace math {
     class Matrix4D
     {
     public:
-        Matrix4D()
-        {
-            m01 = m02 = m03 = m10 = m12 = m13 = m20 = m21 = m23 = m30 = m31 = m32 = 0.f;
-            m00 = m11 = m22 = m33 = 1;
-        }
-
-        ~Matrix4D() {}
+        /// Initialize to identity matrix.
+        constexpr Matrix4D():
+            m00(1.f), m01(0.f), m02(0.f), m03(0.f),
+            m10(0.f), m11(1.f), m12(0.f), m13(0.f),
+            m20(0.f), m21(0.f), m22(1.f), m23(0.f),
+            m30(0.f), m31(0.f), m32(0.f), m33(1.f) {}
+
+        /// Elements given row by row.
+        constexpr Matrix4D(float _m00, float _m01, float _m02, float _m03,
+                           float _m10, float _m11, float _m12, float _m13,
+                           float _m20, float _m21, float _m22, float _m23,
+                           float _m30, float _m31, float _m32, float _m33):
+            m00(_m00), m01(_m01), m02(_m02), m03(_m03),
+            m10(_m10), m11(_m11), m12(_m12), m13(_m13),
+            m20(_m20), m21(_m21), m22(_m22), m23(_m23),
+            m30(_m30), m31(_m31), m32(_m32), m33(_m33) {}
 
         /// Find the determinant of the matrix.
         float determinant(void) const
@@ -222,111 +230,132 @@ namespace math {
             return m00 * det0 - m01 * det1 + m02 * det2 - m03 * det3;
         }
 
-        /// Returns an matrix representing the inverse of the current one.
+        /// Returns the row at @a index in a SIMD register.
+        simd::float4 GetRow(unsigned int index) const
+        {
+            return simd::Load(&m00 + 4 * index);
+        }
+
+        void SetRow(unsigned int index, simd::float4 row)
+        {
+            simd::Store(&m00 + 4 * index, row);
+        }
+
+        /**
+         * @brief Returns an matrix representing the inverse of the current one.
+         * @remarks Computed by blocks: with M = | A B |, the 2 by 2 blocks of the inverse are
+         *                                       | C D |
+         * made of their adjugates (A#, B#, C#, D#) and determinants. The 4 blocks fit a register
+         * each, the cofactors are found with a few shuffles instead of 16 3 by 3 determinants.
+         * @remarks For affine and rigid transformations 'AffineInverse' and 'RigidInverse' are
+         * faster.
+         */
         Matrix4D Inverse(void) const
         {
-            float det1, det2, det3, det4, det5, det6, det7, det8, det9, det10, det11, det12, det13, det14, det15, det16;
-            Matrix3D m;
-
-            m.m00 = m11;	 m.m01 = m12;	 m.m02 = m13;
-            m.m10 = m21;	 m.m11 = m22;	 m.m12 = m23;
-            m.m20 = m31;	 m.m21 = m32;	 m.m22 = m33;
-            det1 = m.determinant();
-
-            m.m00 = m10;	 m.m01 = m12;	 m.m02 = m13;
-            m.m10 = m20;	 m.m11 = m22;	 m.m12 = m23;
-            m.m20 = m30;	 m.m21 = m32;	 m.m22 = m33;
-            det2 = m.determinant();
-
-            m.m00 = m10;	 m.m01 = m11;	 m.m02 = m13;
-            m.m10 = m20;	 m.m11 = m21;	 m.m12 = m23;
-            m.m20 = m30;	 m.m21 = m31;	 m.m22 = m33;
-            det3 = m.determinant();
-
-            m.m00 = m10;	 m.m01 = m11;	 m.m02 = m12;
-            m.m10 = m20;	 m.m11 = m21;	 m.m12 = m22;
-            m.m20 = m30;	 m.m21 = m31;	 m.m22 = m32;
-            det4 = m.determinant();
-
-            m.m00 = m01;	 m.m01 = m02;	 m.m02 = m03;
-            m.m10 = m21;	 m.m11 = m22;	 m.m12 = m23;
-            m.m20 = m31;	 m.m21 = m32;	 m.m22 = m33;
-            det5 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m02;	 m.m02 = m03;
-            m.m10 = m20;	 m.m11 = m22;	 m.m12 = m23;
-            m.m20 = m30;	 m.m21 = m32;	 m.m22 = m33;
-            det6 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m01;	 m.m02 = m03;
-            m.m10 = m20;	 m.m11 = m21;	 m.m12 = m23;
-            m.m20 = m30;	 m.m21 = m31;	 m.m22 = m33;
-            det7 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m01;	 m.m02 = m02;
-            m.m10 = m20;	 m.m11 = m21;	 m.m12 = m22;
-            m.m20 = m30;	 m.m21 = m31;	 m.m22 = m32;
-            det8 = m.determinant();
-
-            m.m00 = m01;	 m.m01 = m02;	 m.m02 = m03;
-            m.m10 = m11;	 m.m11 = m12;	 m.m12 = m13;
-            m.m20 = m31;	 m.m21 = m32;	 m.m22 = m33;
-            det9 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m02;	 m.m02 = m03;
-            m.m10 = m10;	 m.m11 = m12;	 m.m12 = m13;
-            m.m20 = m30;	 m.m21 = m32;	 m.m22 = m33;
-            det10 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m01;	 m.m02 = m03;
-            m.m10 = m10;	 m.m11 = m11;	 m.m12 = m13;
-            m.m20 = m30;	 m.m21 = m31;	 m.m22 = m33;
-            det11 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m01;	 m.m02 = m02;
-            m.m10 = m10;	 m.m11 = m11;	 m.m12 = m12;
-            m.m20 = m30;	 m.m21 = m31;	 m.m22 = m32;
-            det12 = m.determinant();
-
-            m.m00 = m01;	 m.m01 = m02;	 m.m02 = m03;
-            m.m10 = m11;	 m.m11 = m12;	 m.m12 = m13;
-            m.m20 = m21;	 m.m21 = m22;	 m.m22 = m23;
-            det13 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m02;	 m.m02 = m03;
-            m.m10 = m10;	 m.m11 = m12;	 m.m12 = m13;
-            m.m20 = m20;	 m.m21 = m22;	 m.m22 = m23;
-            det14 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m01;	 m.m02 = m03;
-            m.m10 = m10;	 m.m11 = m11;	 m.m12 = m13;
-            m.m20 = m20;	 m.m21 = m21;	 m.m22 = m23;
-            det15 = m.determinant();
-
-            m.m00 = m00;	 m.m01 = m01;	 m.m02 = m02;
-            m.m10 = m10;	 m.m11 = m11;	 m.m12 = m12;
-            m.m20 = m20;	 m.m21 = m21;	 m.m22 = m22;
-            det16 = m.determinant();
+            simd::float4 r0 = GetRow(0), r1 = GetRow(1), r2 = GetRow(2), r3 = GetRow(3);
+
+            // The blocks as (m00, m01, m10, m11).
+            simd::float4 A = simd::Shuffle<0, 1, 0, 1>(r0, r1);
+            simd::float4 B = simd::Shuffle<2, 3, 2, 3>(r0, r1);
+            simd::float4 C = simd::Shuffle<0, 1, 0, 1>(r2, r3);
+            simd::float4 D = simd::Shuffle<2, 3, 2, 3>(r2, r3);
+
+            // (|A|, |B|, |C|, |D|).
+            simd::float4 determinants = simd::Subtract(
+                simd::Multiply(simd::Shuffle<0, 2, 0, 2>(r0, r2), simd::Shuffle<1, 3, 1, 3>(r1, r3)),
+                simd::Multiply(simd::Shuffle<1, 3, 1, 3>(r0, r2), simd::Shuffle<0, 2, 0, 2>(r1, r3)));
+            simd::float4 det_A = simd::Swizzle<0, 0, 0, 0>(determinants);
+            simd::float4 det_B = simd::Swizzle<1, 1, 1, 1>(determinants);
+            simd::float4 det_C = simd::Swizzle<2, 2, 2, 2>(determinants);
+            simd::float4 det_D = simd::Swizzle<3, 3, 3, 3>(determinants);
+
+            simd::float4 D_C = AdjugateMultiply2(D, C);
+            simd::float4 A_B = AdjugateMultiply2(A, B);
+
+            // Adjugates of the blocks of the inverse, before the division by |M|.
+            simd::float4 X_ = simd::Subtract(simd::Multiply(det_D, A), Multiply2(B, D_C));
+            simd::float4 W_ = simd::Subtract(simd::Multiply(det_A, D), Multiply2(C, A_B));
+            simd::float4 Y_ = simd::Subtract(simd::Multiply(det_B, C), MultiplyAdjugate2(D, A_B));
+            simd::float4 Z_ = simd::Subtract(simd::Multiply(det_C, B), MultiplyAdjugate2(A, D_C));
+
+            // |M| = |A| |D| + |B| |C| - tr((A# B) (D# C)).
+            simd::float4 trace = simd::Multiply(A_B, simd::Swizzle<0, 2, 1, 3>(D_C));
+            trace = simd::Add(trace, simd::Swizzle<1, 0, 3, 2>(trace));
+            trace = simd::Add(trace, simd::Swizzle<2, 3, 0, 1>(trace));
+            simd::float4 det_M = simd::Subtract(simd::Add(simd::Multiply(det_A, det_D), simd::Multiply(det_B, det_C)), trace);
+
+            // The adjugate of a 2 by 2 block swaps its diagonal and negates the rest.
+            simd::float4 scale = simd::Divide(simd::Set(1.f, -1.f, -1.f, 1.f), det_M);
+            X_ = simd::Multiply(X_, scale);
+            Y_ = simd::Multiply(Y_, scale);
+            Z_ = simd::Multiply(Z_, scale);
+            W_ = simd::Multiply(W_, scale);
 
             Matrix4D matrix;
-            matrix.m00 = det1;			matrix.m01 = -det2;			matrix.m02 = det3;			matrix.m03 = -det4;
-            matrix.m10 = -det5;			matrix.m11 = det6;			matrix.m12 = -det7;			matrix.m13 = det8;
-            matrix.m20 = det9;			matrix.m21 = -det10;		matrix.m22 = det11;			matrix.m23 = -det12;
-            matrix.m30 = -det13;		matrix.m31 = det14;			matrix.m32 = -det15;		matrix.m33 = det16;
+            matrix.SetRow(0, simd::Shuffle<3, 1, 3, 1>(X_, Y_));
+            matrix.SetRow(1, simd::Shuffle<2, 0, 2, 0>(X_, Y_));
+            matrix.SetRow(2, simd::Shuffle<3, 1, 3, 1>(Z_, W_));
+            matrix.SetRow(3, simd::Shuffle<2, 0, 2, 0>(Z_, W_));
+            return matrix;
+        }
 
-            matrix = matrix.Transpose();
-            matrix = matrix * (1/determinant());
+        /**
+         * @brief Returns the inverse of an affine transformation (the last row is 0, 0, 0, 1):
+         * the inverse of the upper 3 by 3 block, from the cross products of its columns, and the
+         * translation brought back through it.
+         */
+        Matrix4D AffineInverse(void) const
+        {
+            simd::float4 c0 = GetRow(0), c1 = GetRow(1), c2 = GetRow(2), translation = GetRow(3);
+            simd::Transpose(c0, c1, c2, translation);
+
+            simd::float4 i0 = simd::Cross3(c1, c2), i1 = simd::Cross3(c2, c0), i2 = simd::Cross3(c0, c1);
+            simd::float4 scale = simd::Splat(1.f / simd::Dot3(c0, i0));
+            i0 = simd::Multiply(i0, scale);
+            i1 = simd::Multiply(i1, scale);
+            i2 = simd::Multiply(i2, scale);
+
+            Matrix4D matrix;
+            matrix.SetRow(0, i0);
+            matrix.SetRow(1, i1);
+            matrix.SetRow(2, i2);
+            matrix.m03 = -simd::Dot3(i0, translation);
+            matrix.m13 = -simd::Dot3(i1, translation);
+            matrix.m23 = -simd::Dot3(i2, translation);
+            return matrix;
+        }
+
+        /**
+         * @brief Returns the inverse of a rigid transformation (a rotation then a translation):
+         * the transposed rotation and the translation brought back through it.
+         * @remarks Any scale or shear in the matrix gives a wrong result, see 'AffineInverse'.
+         */
+        Matrix4D RigidInverse(void) const
+        {
+            simd::float4 c0 = GetRow(0), c1 = GetRow(1), c2 = GetRow(2), translation = GetRow(3);
+            simd::Transpose(c0, c1, c2, translation);
+
+            Matrix4D matrix;
+            matrix.SetRow(0, c0);
+            matrix.SetRow(1, c1);
+            matrix.SetRow(2, c2);
+            matrix.m03 = -simd::Dot3(c0, translation);
+            matrix.m13 = -simd::Dot3(c1, translation);
+            matrix.m23 = -simd::Dot3(c2, translation);
             return matrix;
         }
 
         /// Returns the transpose of the matrix.
         Matrix4D Transpose(void) const
         {
+            simd::float4 r0 = GetRow(0), r1 = GetRow(1), r2 = GetRow(2), r3 = GetRow(3);
+            simd::Transpose(r0, r1, r2, r3);
+
             Matrix4D t;
-            t.m00 = m00;	t.m01 = m10;	t.m02 = m20;	t.m03 = m30;
-            t.m10 = m01;	t.m11 = m11;	t.m12 = m21;	t.m13 = m31;
-            t.m20 = m02;	t.m21 = m12;	t.m22 = m22;	t.m23 = m32;
-            t.m30 = m03;	t.m31 = m13;	t.m32 = m23;	t.m33 = m33;
+            t.SetRow(0, r0);
+            t.SetRow(1, r1);
+            t.SetRow(2, r2);
+            t.SetRow(3, r3);
             return t;
         }
 
@@ -375,24 +404,40 @@ namespace math {
             return toreturn;
         }
 
-        /// Creates a translation matrix.
-        static Matrix4D Translation(float tx, float ty, float tz)
+        /// Creates a translation matrix, folded at compile time from constant arguments.
+        static constexpr Matrix4D Translation(float tx, float ty, float tz)
         {
-            Matrix4D toreturn;
-            toreturn.m03 = tx;
-            toreturn.m13 = ty;
-            toreturn.m23 = tz;
-            return toreturn;
+            return Matrix4D(1.f, 0.f, 0.f, tx,
+                            0.f, 1.f, 0.f, ty,
+                            0.f, 0.f, 1.f, tz,
+                            0.f, 0.f, 0.f, 1.f);
         }
 
-        /// Creates a scale matrix.
-        static Matrix4D Scale(float sx, float sy, float sz)
+        /// Creates a scale matrix, folded at compile time from constant arguments.
+        static constexpr Matrix4D Scale(float sx, float sy, float sz)
         {
-            Matrix4D toreturn;
-            toreturn.m00 = sx;
-            toreturn.m11 = sy;
-            toreturn.m22 = sz;
-            return toreturn;
+            return Matrix4D(sx, 0.f, 0.f, 0.f,
+                            0.f, sy, 0.f, 0.f,
+                            0.f, 0.f, sz, 0.f,
+                            0.f, 0.f, 0.f, 1.f);
+        }
+
+        /// Creates a perspective projection matrix, the same as glFrustum builds.
+        static constexpr Matrix4D Frustum(float left, float right, float bottom, float top, float _near, float _far)
+        {
+            return Matrix4D(2.f * _near / (right - left), 0.f, (right + left) / (right - left), 0.f,
+                            0.f, 2.f * _near / (top - bottom), (top + bottom) / (top - bottom), 0.f,
+                            0.f, 0.f, -(_far + _near) / (_far - _near), -2.f * _far * _near / (_far - _near),
+                            0.f, 0.f, -1.f, 0.f);
+        }
+
+        /// Creates an orthographic projection matrix, the same as glOrtho builds.
+        static constexpr Matrix4D Orthographic(float left, float right, float bottom, float top, float _near, float _far)
+        {
+            return Matrix4D(2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
+                            0.f, 2.f / (top - bottom), 0.f, -(top + bottom) / (top - bottom),
+                            0.f, 0.f, -2.f / (_far - _near), -(_far + _near) / (_far - _near),
+                            0.f, 0.f, 0.f, 1.f);
         }
 
         /**
@@ -447,52 +492,43 @@ namespace math {
         /// Multiply a matrix with a scalar.
         Matrix4D operator *(float scale) const
         {
+            simd::float4 factor = simd::Splat(scale);
             Matrix4D toreturn;
-            toreturn.m00 = m00 * scale; toreturn.m01 = m01 * scale; toreturn.m02 = m02 * scale; toreturn.m03 = m03 * scale;
-            toreturn.m10 = m10 * scale; toreturn.m11 = m11 * scale; toreturn.m12 = m12 * scale; toreturn.m13 = m13 * scale;
-            toreturn.m20 = m20 * scale; toreturn.m21 = m21 * scale; toreturn.m22 = m22 * scale; toreturn.m23 = m23 * scale;
-            toreturn.m30 = m30 * scale; toreturn.m31 = m31 * scale; toreturn.m32 = m32 * scale; toreturn.m33 = m33 * scale;
+            for (unsigned int i = 0; i < 4; ++i)
+                toreturn.SetRow(i, simd::Multiply(GetRow(i), factor));
             return toreturn;
         }
 
         /// Multiply a matrix with a vector.
         Vector3D operator *(const Vector3D &m) const
         {
-            return Vector3D(m00 * m.x + m01 * m.y + m02 * m.z + m03 * m.w,
-                            m10 * m.x + m11 * m.y + m12 * m.z + m13 * m.w,
-                            m20 * m.x + m21 * m.y + m22 * m.z + m23 * m.w,
-                            m30 * m.x + m31 * m.y + m32 * m.z + m33 * m.w);
+            return Vector3D(Transform(m.GetRegister()));
         }
 
         /// Multiply a matrix with a point.
         Point3D operator *(const Point3D &m) const
         {
-            return Point3D(m00 * m.x + m01 * m.y + m02 * m.z + m03 * m.w,
-                           m10 * m.x + m11 * m.y + m12 * m.z + m13 * m.w,
-                           m20 * m.x + m21 * m.y + m22 * m.z + m23 * m.w,
-                           m30 * m.x + m31 * m.y + m32 * m.z + m33 * m.w);
+            return Point3D(Transform(m.GetRegister()));
         }
 
-        /// Multiply 2 matrices.
+        /**
+         * @brief Multiply 2 matrices.
+         * @remarks Each row of the result is the rows of @a m weighted by a row of this one, the
+         * sums are done in the same order as a dot product per element.
+         */
         Matrix4D operator *(const Matrix4D &m) const
         {
+            simd::float4 b0 = m.GetRow(0), b1 = m.GetRow(1), b2 = m.GetRow(2), b3 = m.GetRow(3);
+
             Matrix4D mt;
-            mt.m00 = m00*m.m00 + m01*m.m10 + m02*m.m20 + m03*m.m30;
-            mt.m01 = m00*m.m01 + m01*m.m11 + m02*m.m21 + m03*m.m31;
-            mt.m02 = m00*m.m02 + m01*m.m12 + m02*m.m22 + m03*m.m32;
-            mt.m03 = m00*m.m03 + m01*m.m13 + m02*m.m23 + m03*m.m33;
-            mt.m10 = m10*m.m00 + m11*m.m10 + m12*m.m20 + m13*m.m30;
-            mt.m11 = m10*m.m01 + m11*m.m11 + m12*m.m21 + m13*m.m31;
-            mt.m12 = m10*m.m02 + m11*m.m12 + m12*m.m22 + m13*m.m32;
-            mt.m13 = m10*m.m03 + m11*m.m13 + m12*m.m23 + m13*m.m33;
-            mt.m20 = m20*m.m00 + m21*m.m10 + m22*m.m20 + m23*m.m30;
-            mt.m21 = m20*m.m01 + m21*m.m11 + m22*m.m21 + m23*m.m31;
-            mt.m22 = m20*m.m02 + m21*m.m12 + m22*m.m22 + m23*m.m32;
-            mt.m23 = m20*m.m03 + m21*m.m13 + m22*m.m23 + m23*m.m33;
-            mt.m30 = m30*m.m00 + m31*m.m10 + m32*m.m20 + m33*m.m30;
-            mt.m31 = m30*m.m01 + m31*m.m11 + m32*m.m21 + m33*m.m31;
-            mt.m32 = m30*m.m02 + m31*m.m12 + m32*m.m22 + m33*m.m32;
-            mt.m33 = m30*m.m03 + m31*m.m13 + m32*m.m23 + m33*m.m33;
+            for (unsigned int i = 0; i < 4; ++i) {
+                simd::float4 a = GetRow(i);
+                simd::float4 row = simd::Multiply(simd::Swizzle<0, 0, 0, 0>(a), b0);
+                row = simd::Add(row, simd::Multiply(simd::Swizzle<1, 1, 1, 1>(a), b1));
+                row = simd::Add(row, simd::Multiply(simd::Swizzle<2, 2, 2, 2>(a), b2));
+                row = simd::Add(row, simd::Multiply(simd::Swizzle<3, 3, 3, 3>(a), b3));
+                mt.SetRow(i, row);
+            }
             return mt;
         }
 
@@ -556,6 +592,40 @@ namespace math {
             }
         }
 
+    private:
+        /// Returns the columns weighted by the components of @a v, summed as a dot product per row.
+        simd::float4 Transform(simd::float4 v) const
+        {
+            simd::float4 c0 = GetRow(0), c1 = GetRow(1), c2 = GetRow(2), c3 = GetRow(3);
+            simd::Transpose(c0, c1, c2, c3);
+
+            simd::float4 result = simd::Multiply(c0, simd::Swizzle<0, 0, 0, 0>(v));
+            result = simd::Add(result, simd::Multiply(c1, simd::Swizzle<1, 1, 1, 1>(v)));
+            result = simd::Add(result, simd::Multiply(c2, simd::Swizzle<2, 2, 2, 2>(v)));
+            return simd::Add(result, simd::Multiply(c3, simd::Swizzle<3, 3, 3, 3>(v)));
+        }
+
+        /// 2 by 2 blocks held as (m00, m01, m10, m11): returns A B.
+        static simd::float4 Multiply2(simd::float4 A, simd::float4 B)
+        {
+            return simd::Add(simd::Multiply(A, simd::Swizzle<0, 3, 0, 3>(B)),
+                             simd::Multiply(simd::Swizzle<1, 0, 3, 2>(A), simd::Swizzle<2, 1, 2, 1>(B)));
+        }
+
+        /// Returns A# B, A# being the adjugate of A.
+        static simd::float4 AdjugateMultiply2(simd::float4 A, simd::float4 B)
+        {
+            return simd::Subtract(simd::Multiply(simd::Swizzle<3, 3, 0, 0>(A), B),
+                                  simd::Multiply(simd::Swizzle<1, 1, 2, 2>(A), simd::Swizzle<2, 3, 0, 1>(B)));
+        }
+
+        /// Returns A B#.
+        static simd::float4 MultiplyAdjugate2(simd::float4 A, simd::float4 B)
+        {
+            return simd::Subtract(simd::Multiply(A, simd::Swizzle<3, 0, 3, 0>(B)),
+                                  simd::Multiply(simd::Swizzle<1, 0, 3, 2>(A), simd::Swizzle<2, 1, 2, 1>(B)));
+        }
+
     public:
         float m00, m01, m02, m03,
               m10, m11, m12, m13,
@@ -566,12 +636,7 @@ namespace math {
     /// Multiply a scalar and a matrix, returns a new matrix.
     static Matrix4D operator *(float scale, const Matrix4D &m)
     {
-        Matrix4D toreturn;
-        toreturn.m00 = m.m00 * scale; toreturn.m01 = m.m01 * scale; toreturn.m02 = m.m02 * scale; toreturn.m03 = m.m03 * scale;
-        toreturn.m10 = m.m10 * scale; toreturn.m11 = m.m11 * scale; toreturn.m12 = m.m12 * scale; toreturn.m13 = m.m13 * scale;
-        toreturn.m20 = m.m20 * scale; toreturn.m21 = m.m21 * scale; toreturn.m22 = m.m22 * scale; toreturn.m23 = m.m23 * scale;
-        toreturn.m30 = m.m30 * scale; toreturn.m31 = m.m31 * scale; toreturn.m32 = m.m32 * scale; toreturn.m33 = m.m33 * scale;
-        return toreturn;
+        return m * scale;
     }
 }
 
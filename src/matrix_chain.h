@@ -0,0 +1,110 @@
+/**
+ * @file matrix_chain.h
+ * @brief Products of several matrices evaluated without intermediate matrices.
+ */
+#ifndef MATRIX_CHAIN_H_INCLUDED
+#define MATRIX_CHAIN_H_INCLUDED
+
+#include "matrix.h"
+
+namespace math {
+
+    /// Returns the row vector @a row times @a m, summed like 'Matrix4D::operator *'.
+    inline simd::float4 MultiplyRow(simd::float4 row, const Matrix4D &m)
+    {
+        simd::float4 result = simd::Multiply(simd::Swizzle<0, 0, 0, 0>(row), m.GetRow(0));
+        result = simd::Add(result, simd::Multiply(simd::Swizzle<1, 1, 1, 1>(row), m.GetRow(1)));
+        result = simd::Add(result, simd::Multiply(simd::Swizzle<2, 2, 2, 2>(row), m.GetRow(2)));
+        return simd::Add(result, simd::Multiply(simd::Swizzle<3, 3, 3, 3>(row), m.GetRow(3)));
+    }
+
+    /**
+     * @brief Product of matrices, @a Left times the last matrix, evaluated when used.
+     * @remarks Converting to 'Matrix4D' computes each row of the result by carrying a row of the
+     * first matrix through the others: no intermediate matrix, and the same values as multiplying
+     * the matrices from left to right.
+     * @remarks Multiplying by a vector or a point applies the matrices from right to left, one
+     * matrix-vector product each instead of the matrix products. The rounding differs from
+     * transforming by the evaluated product.
+     * @remarks Refers to its matrices: use it within the expression that builds it.
+     */
+    template <class Left>
+    class MatrixChain
+    {
+    public:
+        MatrixChain(const Left &_left, const Matrix4D &_right): left(_left), right(_right) {}
+
+        simd::float4 GetRow(unsigned int index) const
+        {
+            return MultiplyRow(left.GetRow(index), right);
+        }
+
+        MatrixChain<MatrixChain<Left> > operator *(const Matrix4D &m) const
+        {
+            return MatrixChain<MatrixChain<Left> >(*this, m);
+        }
+
+        Vector3D operator *(const Vector3D &vec) const
+        {
+            return left * (right * vec);
+        }
+
+        Point3D operator *(const Point3D &point) const
+        {
+            return left * (right * point);
+        }
+
+        operator Matrix4D() const
+        {
+            Matrix4D result;
+            for (unsigned int i = 0; i < 4; ++i)
+                result.SetRow(i, GetRow(i));
+            return result;
+        }
+
+    private:
+        Left left;
+        const Matrix4D &right;
+    };
+
+    /// First matrix of a chain, see 'Chain'.
+    class MatrixChainStart
+    {
+    public:
+        explicit MatrixChainStart(const Matrix4D &_matrix): matrix(_matrix) {}
+
+        simd::float4 GetRow(unsigned int index) const
+        {
+            return matrix.GetRow(index);
+        }
+
+        MatrixChain<MatrixChainStart> operator *(const Matrix4D &m) const
+        {
+            return MatrixChain<MatrixChainStart>(*this, m);
+        }
+
+        Vector3D operator *(const Vector3D &vec) const
+        {
+            return matrix * vec;
+        }
+
+        Point3D operator *(const Point3D &point) const
+        {
+            return matrix * point;
+        }
+
+    private:
+        const Matrix4D &matrix;
+    };
+
+    /**
+     * @brief Starts a lazy product: 'Chain(a) * b * c * v' is 'a * (b * (c * v))' and
+     * 'Matrix4D m = Chain(a) * b * c' fills m a row at a time.
+     */
+    inline MatrixChainStart Chain(const Matrix4D &matrix)
+    {
+        return MatrixChainStart(matrix);
+    }
+}
+
+#endif // MATRIX_CHAIN_H_INCLUDED
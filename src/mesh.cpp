@@ -0,0 +1,301 @@
+#include <utility>
+#include <cstring>
+#include "mesh.h"
+
+/**
+ * @brief Hands out consecutive aligned sub-arrays from a mesh storage block.
+ * @remarks Used both to compute the block size (with a NULL base) and to carve the block.
+ */
+class MeshStorageLayout
+{
+public:
+    MeshStorageLayout(char *_base): base(_base), offset(0) {}
+
+    /// Returns the next array of @a size bytes (NULL when only computing the size).
+    void *Next(size_t size)
+    {
+        void *array = base? base + offset: NULL;
+        offset += core::MeshArena::AlignSize(size);
+        return array;
+    }
+
+public:
+    char *base;
+    size_t offset;
+};
+
+/// Carves every mesh array out of @a layout, returns the number of bytes used.
+static size_t LayoutMeshStorage(MeshStorageLayout &layout, core::Mesh &mesh, unsigned int vertex_number,
+                                unsigned int uv_layer_count, unsigned int index_array_size, bool use_colors)
+{
+    mesh.vertices = (float *)layout.Next(vertex_number * 4 * sizeof(float));
+    mesh.normals = (float *)layout.Next(vertex_number * 3 * sizeof(float));
+    mesh.colors = use_colors? (float *)layout.Next(vertex_number * 4 * sizeof(float)): NULL;
+
+    for (unsigned int i = 0; i < uv_layer_count; ++i) {
+        mesh.tangents[i] = (float *)layout.Next(vertex_number * 3 * sizeof(float));
+        mesh.binormals[i] = (float *)layout.Next(vertex_number * 3 * sizeof(float));
+        mesh.uv_coordinates[i] = (float *)layout.Next(vertex_number * 3 * sizeof(float));
+    }
+
+    mesh.index_array = (unsigned short *)layout.Next(index_array_size * sizeof(unsigned short));
+    return layout.offset;
+}
+
+size_t core::Mesh::GetStorageSize(unsigned int _vertex_number, unsigned int _uv_layer_count,
+                                  unsigned int _index_array_size, bool use_colors)
+{
+    if (_uv_layer_count > MAX_UV_LAYERS)
+        _uv_layer_count = MAX_UV_LAYERS;
+
+    // Run the layout on a throw away mesh, only the offsets matter.
+    core::Mesh dummy;
+    MeshStorageLayout layout(NULL);
+    size_t size = LayoutMeshStorage(layout, dummy, _vertex_number, _uv_layer_count, _index_array_size, use_colors);
+    return GeometryBuffer::GetAllocationSize(size);
+}
+
+core::Mesh::Mesh(const Mesh &mesh): geometry(NULL), payload_source(NULL), payload(0)
+{
+    *this = mesh;
+}
+
+core::Mesh::Mesh(Mesh &&mesh): geometry(NULL), payload_source(NULL), payload(0)
+{
+    *this = std::move(mesh);
+}
+
+core::Mesh &core::Mesh::operator =(const Mesh &mesh)
+{
+    if (this == &mesh)
+        return *this;
+
+    // Reference first, in case both meshes already share the same buffer.
+    if (mesh.geometry)
+        mesh.geometry->AddRef();
+    if (mesh.payload_source)
+        mesh.payload_source->AddRef();
+    Release();
+
+    name = mesh.name;
+    materials = mesh.materials;
+    ranges = mesh.ranges;
+    bounds = mesh.bounds;
+    hulls = mesh.hulls;
+    CopyLayout(mesh);
+    geometry = mesh.geometry;
+    payload_source = mesh.payload_source;
+    payload = mesh.payload;
+    return *this;
+}
+
+core::Mesh &core::Mesh::operator =(Mesh &&mesh)
+{
+    if (this == &mesh)
+        return *this;
+
+    Release();
+
+    name = std::move(mesh.name);
+    materials = std::move(mesh.materials);
+    ranges = std::move(mesh.ranges);
+    bounds = mesh.bounds;
+    hulls = std::move(mesh.hulls);
+    CopyLayout(mesh);
+    geometry = mesh.geometry;
+    payload_source = mesh.payload_source;
+    payload = mesh.payload;
+
+    // Leave the source empty, the references now belong to this mesh.
+    mesh.geometry = NULL;
+    mesh.payload_source = NULL;
+    mesh.Release();
+    return *this;
+}
+
+void core::Mesh::CopyLayout(const Mesh &mesh)
+{
+    vertices = mesh.vertices;
+    normals = mesh.normals;
+    colors = mesh.colors;
+    is_using_colors = mesh.is_using_colors;
+    vertex_number = mesh.vertex_number;
+
+    for (unsigned int i = 0; i < MAX_UV_LAYERS; ++i) {
+        tangents[i] = mesh.tangents[i];
+        binormals[i] = mesh.binormals[i];
+        uv_coordinates[i] = mesh.uv_coordinates[i];
+    }
+    uv_layer_count = mesh.uv_layer_count;
+
+    index_array = mesh.index_array;
+    index_array_size = mesh.index_array_size;
+}
+
+/// Moves @a array from the block at @a from to the same offset in the block at @a to.
+template <typename T>
+static void RebaseArray(T *&array, const char *from, char *to)
+{
+    if (array)
+        array = (T *)(to + ((const char *)array - from));
+}
+
+void core::Mesh::RebaseArrays(const char *from, char *to)
+{
+    RebaseArray(vertices, from, to);
+    RebaseArray(normals, from, to);
+    RebaseArray(colors, from, to);
+    for (unsigned int i = 0; i < MAX_UV_LAYERS; ++i) {
+        RebaseArray(tangents[i], from, to);
+        RebaseArray(binormals[i], from, to);
+        RebaseArray(uv_coordinates[i], from, to);
+    }
+    RebaseArray(index_array, from, to);
+}
+
+void core::Mesh::Allocate(unsigned int _vertex_number, unsigned int _uv_layer_count, unsigned int _index_array_size,
+                          bool use_colors, MeshArena *arena)
+{
+    Release();
+
+    if (_uv_layer_count > MAX_UV_LAYERS)
+        _uv_layer_count = MAX_UV_LAYERS;
+
+    MeshStorageLayout size_layout(NULL);
+    size_t size = LayoutMeshStorage(size_layout, *this, _vertex_number, _uv_layer_count, _index_array_size, use_colors);
+    geometry = GeometryBuffer::Create(size, arena);
+
+    MeshStorageLayout layout(geometry->GetData());
+    LayoutMeshStorage(layout, *this, _vertex_number, _uv_layer_count, _index_array_size, use_colors);
+
+    vertex_number = _vertex_number;
+    uv_layer_count = _uv_layer_count;
+    index_array_size = _index_array_size;
+    is_using_colors = use_colors;
+}
+
+bool core::Mesh::Map(GeometryBuffer *buffer, unsigned int _vertex_number, unsigned int _uv_layer_count,
+                     unsigned int _index_array_size, bool use_colors)
+{
+    Release();
+
+    if (_uv_layer_count > MAX_UV_LAYERS)
+        _uv_layer_count = MAX_UV_LAYERS;
+
+    MeshStorageLayout size_layout(NULL);
+    if (LayoutMeshStorage(size_layout, *this, _vertex_number, _uv_layer_count, _index_array_size, use_colors) > buffer->GetSize())
+        return false;
+
+    buffer->AddRef();
+    geometry = buffer;
+
+    MeshStorageLayout layout(geometry->GetData());
+    LayoutMeshStorage(layout, *this, _vertex_number, _uv_layer_count, _index_array_size, use_colors);
+
+    vertex_number = _vertex_number;
+    uv_layer_count = _uv_layer_count;
+    index_array_size = _index_array_size;
+    is_using_colors = use_colors;
+    return true;
+}
+
+void core::Mesh::Release(void)
+{
+    // The buffer goes away with its last reference (arena memory is reclaimed by the arena).
+    if (geometry)
+        geometry->Release();
+    geometry = NULL;
+    if (payload_source)
+        payload_source->Release();
+    payload_source = NULL;
+
+    vertices = normals = colors = NULL;
+    for (unsigned int i = 0; i < MAX_UV_LAYERS; ++i)
+        tangents[i] = binormals[i] = uv_coordinates[i] = NULL;
+    index_array = NULL;
+
+    vertex_number = uv_layer_count = index_array_size = 0;
+    is_using_colors = false;
+}
+
+void core::Mesh::SetPayload(MeshPayloadSource *source, unsigned int _payload)
+{
+    source->AddRef();
+    if (payload_source)
+        payload_source->Release();
+    payload_source = source;
+    payload = _payload;
+
+    // Keep the counts, they describe the payload.
+    if (geometry)
+        geometry->Release();
+    geometry = NULL;
+    vertices = normals = colors = NULL;
+    for (unsigned int i = 0; i < MAX_UV_LAYERS; ++i)
+        tangents[i] = binormals[i] = uv_coordinates[i] = NULL;
+    index_array = NULL;
+}
+
+bool core::Mesh::EnsureResident(void) const
+{
+    if (IsResident())
+        return true;
+
+    GeometryBuffer *buffer = payload_source->Fetch(payload);
+    if (!buffer)
+        return false;
+
+    // 'Map' releases the source, the mesh becomes a regular one.
+    Mesh *self = const_cast<Mesh *>(this);
+    bool result = self->Map(buffer, vertex_number, uv_layer_count, index_array_size, is_using_colors);
+    buffer->Release();
+    return result;
+}
+
+void core::Mesh::ComputeBounds(void)
+{
+    float minimum[3] = { 0.f, 0.f, 0.f }, maximum[3] = { 0.f, 0.f, 0.f };
+    if (EnsureResident() && vertices && vertex_number) {
+        for (unsigned int k = 0; k < 3; ++k)
+            minimum[k] = maximum[k] = vertices[k];
+
+        for (unsigned int i = 1; i < vertex_number; ++i) {
+            const float *v = vertices + i * 4;
+            for (unsigned int k = 0; k < 3; ++k) {
+                minimum[k] = (v[k] < minimum[k])? v[k]: minimum[k];
+                maximum[k] = (v[k] > maximum[k])? v[k]: maximum[k];
+            }
+        }
+    }
+
+    bounds.center = math::Point3D((minimum[0] + maximum[0]) / 2, (minimum[1] + maximum[1]) / 2, (minimum[2] + maximum[2]) / 2);
+    bounds.maximumdistanceX = (maximum[0] - minimum[0]) / 2;
+    bounds.maximumdistanceY = (maximum[1] - minimum[1]) / 2;
+    bounds.maximumdistanceZ = (maximum[2] - minimum[2]) / 2;
+}
+
+void core::Mesh::MakeWritable(void)
+{
+    EnsureResident();
+    if (!geometry || geometry->IsWritable())
+        return;
+
+    // Shared or read only, duplicate the buffer and point the arrays into the copy.
+    GeometryBuffer *copy = geometry->Clone();
+    RebaseArrays(geometry->GetData(), copy->GetData());
+    geometry->Release();
+    geometry = copy;
+}
+
+void core::Mesh::Relocate(MeshArena *arena)
+{
+    EnsureResident();
+    if (!geometry)
+        return;
+
+    GeometryBuffer *moved = GeometryBuffer::Create(geometry->GetSize(), arena);
+    memcpy(moved->GetData(), geometry->GetData(), geometry->GetSize());
+    RebaseArrays(geometry->GetData(), moved->GetData());
+    geometry->Release();
+    geometry = moved;
+}
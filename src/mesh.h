@@ -7,6 +7,11 @@
 
 #include <string>
 #include <vector>
+#include "mesh_arena.h"
+#include "geometry_buffer.h"
+#include "bbox.h"
+#include "convex_hull.h"
+#include "mesh_payload_source.h"
 
 /**
  * @namespace core
@@ -26,6 +31,18 @@ namespace core {
     public:
         TextureMap(void): u_offset(0.f), v_offset(0.f), u_scale(0.f), v_scale(0.f), angle(0.f) {}
 
+        /// Exact comparison, used to find meshes that can be drawn with the same state.
+        bool operator ==(const TextureMap &map) const
+        {
+            return name == map.name && path == map.path && type == map.type && u_offset == map.u_offset &&
+                   v_offset == map.v_offset && u_scale == map.u_scale && v_scale == map.v_scale && angle == map.angle;
+        }
+
+        bool operator !=(const TextureMap &map) const
+        {
+            return !(*this == map);
+        }
+
     public:
         /// Name of the texture map.
         std::string name;
@@ -46,6 +63,17 @@ namespace core {
         Color(void): r(0.f), g(0.f), b(0.f), a(1.f) {}
         ~Color(void) {}
 
+        /// Exact comparison of the components.
+        bool operator ==(const Color &color) const
+        {
+            return r == color.r && g == color.g && b == color.b && a == color.a;
+        }
+
+        bool operator !=(const Color &color) const
+        {
+            return !(*this == color);
+        }
+
     public:
         float r, g, b, a;
     };
@@ -59,6 +87,19 @@ namespace core {
     public:
         Material(void): shininess(0.0f), opacity(1.0f) {}
 
+        /// Whether both materials render the same (every property and texture map is compared).
+        bool operator ==(const Material &material) const
+        {
+            return name == material.name && ambient == material.ambient && diffuse == material.diffuse &&
+                   specular == material.specular && shininess == material.shininess && opacity == material.opacity &&
+                   textures == material.textures;
+        }
+
+        bool operator !=(const Material &material) const
+        {
+            return !(*this == material);
+        }
+
     public:
         std::string name;
         Color ambient;
@@ -70,6 +111,31 @@ namespace core {
         std::vector <TextureMap> textures;
     };
 
+    /**
+     * @brief The part of a mesh that comes from one of the meshes merged into it (see
+     * 'StaticBatcher'), so the original objects can still be culled and picked individually.
+     */
+    class MeshRange
+    {
+    public:
+        MeshRange(): first_index(0), index_count(0), first_vertex(0), vertex_count(0), first_hull(0), hull_count(0) {}
+
+    public:
+        /// Name of the source mesh.
+        std::string name;
+        /// The triangles of the source mesh in 'Mesh::index_array'.
+        unsigned int first_index;
+        unsigned int index_count;
+        /// The vertices of the source mesh.
+        unsigned int first_vertex;
+        unsigned int vertex_count;
+        /// The collision hulls of the source mesh in 'Mesh::hulls'.
+        unsigned int first_hull;
+        unsigned int hull_count;
+        /// Bounds of the source vertices, in the space of the merged mesh.
+        math::BoundingBox bounds;
+    };
+
     /**
      * @brief The core mesh class, the smallest entity that can be rendered.
      * @remarks A vertex is duplicated when it has different normals specified or different UVs
@@ -82,31 +148,128 @@ namespace core {
     public:
         /// Default constructor.
         Mesh(): vertices(NULL), normals(NULL), colors(NULL), is_using_colors(false), vertex_number(0), uv_layer_count(0),
-                index_array(NULL), index_array_size(0) {}
+                index_array(NULL), index_array_size(0), geometry(NULL), payload_source(NULL), payload(0)
+        {
+            for (unsigned int i = 0; i < MAX_UV_LAYERS; ++i)
+                tangents[i] = binormals[i] = uv_coordinates[i] = NULL;
+            bounds.maximumdistanceX = bounds.maximumdistanceY = bounds.maximumdistanceZ = 0.f;
+        }
+
+        /**
+         * @brief Shallow copy, the copy shares the geometry buffer of @a mesh (no array is
+         * duplicated until one of them calls 'MakeWritable').
+         */
+        Mesh(const Mesh &mesh);
+
+        /// Takes over the geometry of @a mesh, which is left empty.
+        Mesh(Mesh &&mesh);
 
         virtual ~Mesh()
         {
-            if (vertices)
-                delete [] vertices;
-            vertices = NULL;
-
-            if (normals)
-                delete [] normals;
-            normals = NULL;
-
-            if (colors)
-                delete [] colors;
-            colors = NULL;
-
-            // Freeing data associated with the uv layers.
-            for (unsigned int i = 0; i < uv_layer_count; ++i) {
-                delete [] tangents[i];
-                delete [] binormals[i];
-                delete [] uv_coordinates[i];
-            }
+            Release();
+        }
 
-            delete [] index_array;
-            index_array = NULL;
+        /// Shares the geometry of @a mesh, see the copy constructor.
+        Mesh &operator =(const Mesh &mesh);
+
+        /// Takes over the geometry of @a mesh, which is left empty.
+        Mesh &operator =(Mesh &&mesh);
+
+        /**
+         * @brief Allocates all the attribute and index arrays of the mesh in a single contiguous
+         * block, each array is aligned on MESH_ARRAY_ALIGNMENT. Any previous data is released.
+         * @param _vertex_number The number of vertices.
+         * @param _uv_layer_count The number of uv layers (tangents, binormals and uvs), clamped to
+         * MAX_UV_LAYERS.
+         * @param _index_array_size The number of indices.
+         * @param use_colors Whether the 'colors' array is needed.
+         * @param arena The arena to allocate the block from (the block keeps the arena alive). If
+         * NULL the block is a heap allocation of its own.
+         * @remarks The content of the arrays is left uninitialized.
+         */
+        void Allocate(unsigned int _vertex_number, unsigned int _uv_layer_count, unsigned int _index_array_size,
+                      bool use_colors, MeshArena *arena = NULL);
+
+        /**
+         * @brief Points the arrays of the mesh into @a buffer, which already holds them in the
+         * layout 'Allocate' uses (i.e. geometry read from a mapped scene file). The mesh takes a
+         * reference on @a buffer, any previous data is released.
+         * @return False if @a buffer is too small for the given counts, the mesh is then left empty.
+         */
+        bool Map(GeometryBuffer *buffer, unsigned int _vertex_number, unsigned int _uv_layer_count,
+                 unsigned int _index_array_size, bool use_colors);
+
+        /**
+         * @brief Returns the size in bytes of the block needed by 'Allocate' for the given counts.
+         * @remarks Used by loaders to reserve a scene arena up front.
+         */
+        static size_t GetStorageSize(unsigned int _vertex_number, unsigned int _uv_layer_count,
+                                     unsigned int _index_array_size, bool use_colors);
+
+        /// Drops the reference to the geometry (or payload source) and resets the mesh counts.
+        void Release(void);
+
+        /**
+         * @brief Leaves the arrays unloaded, they are fetched from @a source the first time
+         * 'EnsureResident' is called. The counts, bounds and materials must already be set, any
+         * current geometry is released. The mesh holds a reference on @a source until it is
+         * resident.
+         * @param source The provider of the arrays.
+         * @param _payload The identifier of the arrays in @a source.
+         */
+        void SetPayload(MeshPayloadSource *source, unsigned int _payload);
+
+        /// Whether the arrays are loaded (always true for meshes without payload source).
+        bool IsResident(void) const
+        {
+            return geometry || !payload_source;
+        }
+
+        /**
+         * @brief Loads the arrays if they are not yet, every user of the arrays (renderer, queries,
+         * tools) calls it first.
+         * @remarks Logically const: the arrays are a cache of the payload. Not thread safe for a
+         * given mesh, use 'Prefetch' to move the loading work to the source's threads.
+         * @return False if the payload could not be fetched, the arrays are then NULL.
+         */
+        bool EnsureResident(void) const;
+
+        /// Hints the source that the arrays will be needed soon (ignored when resident).
+        void Prefetch(void) const
+        {
+            if (!IsResident())
+                payload_source->Prefetch(payload);
+        }
+
+        /// Computes 'bounds' from the vertices.
+        void ComputeBounds(void);
+
+        /**
+         * @brief Copy-on-write: makes sure the arrays of the mesh can be modified without affecting
+         * any other mesh. Must be called before writing to any of the arrays of a mesh that might
+         * be shared (copied meshes, instanced props, read only data).
+         * @remarks The array pointers change if the geometry had to be duplicated.
+         */
+        void MakeWritable(void);
+
+        /**
+         * @brief Moves the arrays to a new block allocated from @a arena (or the heap if NULL).
+         * Other meshes sharing the current block keep it.
+         * @remarks Used by loaders to pack the geometry they kept in an arena sized once all of it
+         * is known.
+         */
+        void Relocate(MeshArena *arena);
+
+        /// Whether the geometry is referenced by other meshes (or is read only).
+        bool IsShared(void) const
+        {
+            return geometry && !geometry->IsWritable();
+        }
+
+        /// Returns the buffer holding the arrays of the mesh (can be NULL).
+        const GeometryBuffer *GetGeometry(void) const
+        {
+            return geometry;
         }
 
         /**
@@ -118,7 +281,7 @@ namespace core {
             std::vector<std::string> paths;
             for (unsigned int i = 0; i < materials.size(); ++i) {
                 for (unsigned int j = 0; j < materials[i].textures.size(); ++j)
-                    paths.push_back(materials[i].textures[i].path);
+                    paths.push_back(materials[i].textures[j].path);
             }
 
             return paths;
@@ -154,6 +317,30 @@ namespace core {
 
         /// Material vector.
         std::vector<Material> materials;
+
+        /// The source meshes of a merged mesh, empty otherwise.
+        std::vector<MeshRange> ranges;
+
+        /// Bounds of the vertices, available before the arrays are resident.
+        math::BoundingBox bounds;
+
+        /// Collision proxies in mesh space, filled by 'HullGenerator'.
+        std::vector<ConvexHull> hulls;
+
+    private:
+        /// Copies the counts and array pointers of @a mesh, the geometry reference is not touched.
+        void CopyLayout(const Mesh &mesh);
+
+        /// Relocates every array pointer from the block at @a from to the same offset in @a to.
+        void RebaseArrays(const char *from, char *to);
+
+    private:
+        /// The reference counted block holding all the arrays.
+        GeometryBuffer *geometry;
+
+        /// Where the arrays are fetched from while they are not resident, NULL afterwards.
+        MeshPayloadSource *payload_source;
+        unsigned int payload;
     };
 }
 
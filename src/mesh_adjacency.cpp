@@ -0,0 +1,135 @@
+#include "mesh_adjacency.h"
+
+/// Key of the directed edge from @a a to @a b.
+static inline unsigned long long EdgeKey(unsigned int a, unsigned int b)
+{
+    return ((unsigned long long)a << 32) | b;
+}
+
+/// Mixes the bits of an edge key (murmur3 finalizer).
+static inline unsigned long long HashEdgeKey(unsigned long long key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ * @brief Open addressing map from directed edges to their half-edge, sized once for all the edges
+ * so it never grows. A directed edge found twice is marked as duplicated.
+ */
+class DirectedEdgeTable
+{
+public:
+    DirectedEdgeTable(unsigned int edge_count)
+    {
+        unsigned int capacity = 16;
+        while (capacity < edge_count * 2)
+            capacity *= 2;
+
+        mask = capacity - 1;
+        keys.resize(capacity);
+        half_edges.assign(capacity, ADJACENCY_INVALID);
+    }
+
+    /// Inserts the edge, returns the half-edge already stored for it or ADJACENCY_INVALID.
+    unsigned int Insert(unsigned long long key, unsigned int half_edge)
+    {
+        unsigned int slot = (unsigned int)HashEdgeKey(key) & mask;
+        while (half_edges[slot] != ADJACENCY_INVALID) {
+            if (keys[slot] == key)
+                return half_edges[slot];
+            slot = (slot + 1) & mask;
+        }
+
+        keys[slot] = key;
+        half_edges[slot] = half_edge;
+        return ADJACENCY_INVALID;
+    }
+
+    /// Returns the half-edge of the edge, or ADJACENCY_INVALID.
+    unsigned int Find(unsigned long long key) const
+    {
+        unsigned int slot = (unsigned int)HashEdgeKey(key) & mask;
+        while (half_edges[slot] != ADJACENCY_INVALID) {
+            if (keys[slot] == key)
+                return half_edges[slot];
+            slot = (slot + 1) & mask;
+        }
+        return ADJACENCY_INVALID;
+    }
+
+private:
+    unsigned int mask;
+    std::vector<unsigned long long> keys;
+    std::vector<unsigned int> half_edges;
+};
+
+bool core::MeshAdjacency::Build(const unsigned short *indices, unsigned int index_count, unsigned int _vertex_count)
+{
+    Clear();
+
+    unsigned int half_edge_count = index_count - index_count % 3;
+    if (!indices || !half_edge_count)
+        return false;
+
+    vertex_count = _vertex_count;
+    origins.assign(indices, indices + half_edge_count);
+    twins.assign(half_edge_count, ADJACENCY_INVALID);
+    vertex_half_edges.assign(vertex_count, ADJACENCY_INVALID);
+
+    // Pass 1: register every directed edge, the same directed edge twice is non manifold.
+    DirectedEdgeTable table(half_edge_count);
+    std::vector<bool> duplicated(half_edge_count, false);
+    for (unsigned int h = 0; h < half_edge_count; ++h) {
+        unsigned int first = table.Insert(EdgeKey(origins[h], origins[Next(h)]), h);
+        if (first != ADJACENCY_INVALID)
+            duplicated[h] = duplicated[first] = true;
+    }
+
+    // Pass 2: pair each half-edge with the reversed one, unless either side is duplicated.
+    for (unsigned int h = 0; h < half_edge_count; ++h) {
+        unsigned int origin = origins[h], destination = origins[Next(h)];
+        unsigned int twin = table.Find(EdgeKey(destination, origin));
+
+        if (duplicated[h] || (twin != ADJACENCY_INVALID && duplicated[twin])) {
+            non_manifold_edges.push_back(h);
+            continue;
+        }
+        twins[h] = twin;
+    }
+
+    // Pass 3: one outgoing half-edge per vertex, preferring boundaries so fans can be walked whole.
+    for (unsigned int h = 0; h < half_edge_count; ++h) {
+        if (origins[h] >= vertex_count)
+            continue;
+
+        unsigned int &vertex_half_edge = vertex_half_edges[origins[h]];
+        if (vertex_half_edge == ADJACENCY_INVALID || twins[h] == ADJACENCY_INVALID)
+            vertex_half_edge = h;
+    }
+
+    return true;
+}
+
+void core::MeshAdjacency::Clear(void)
+{
+    vertex_count = 0;
+    origins.clear();
+    twins.clear();
+    vertex_half_edges.clear();
+    non_manifold_edges.clear();
+}
+
+unsigned int core::MeshAdjacency::GetBoundaryEdgeCount(void) const
+{
+    unsigned int count = 0;
+    for (unsigned int h = 0; h < twins.size(); ++h) {
+        if (twins[h] == ADJACENCY_INVALID)
+            ++count;
+    }
+    return count - (unsigned int)non_manifold_edges.size();
+}
@@ -0,0 +1,159 @@
+/**
+ * @file mesh_adjacency.h
+ * @brief Half-edge connectivity of a triangle mesh.
+ */
+#ifndef MESH_ADJACENCY_H_INCLUDED
+#define MESH_ADJACENCY_H_INCLUDED
+
+#include <vector>
+#include "mesh.h"
+
+/// Marks a missing half-edge (boundary twin, isolated vertex).
+#define ADJACENCY_INVALID 0xFFFFFFFFu
+
+namespace core {
+
+    /**
+     * @brief Half-edge adjacency of a triangle mesh, in the compact implicit layout of a corner
+     * table: half-edge h is the corner h of the index array, it belongs to the triangle h / 3 and
+     * goes from the vertex of corner h to the vertex of the next corner of the triangle. Only the
+     * twins and one outgoing half-edge per vertex are stored, in flat arrays.
+     * @remarks Built in linear time with an open addressing hash of the directed edges. Edges
+     * used more than twice, or twice in the same direction (inconsistent winding), are non
+     * manifold: they are reported in 'GetNonManifoldEdges' and left without a twin, so the
+     * traversals treat them as boundaries.
+     * @remarks Vertices are matched by index, so seams (duplicated vertices with different normals
+     * or uvs) show up as boundaries.
+     */
+    class MeshAdjacency
+    {
+    public:
+        MeshAdjacency(): vertex_count(0) {}
+
+        /// Builds the adjacency of @a mesh, returns false if it has no triangles.
+        bool Build(const Mesh &mesh)
+        {
+            return mesh.EnsureResident() && Build(mesh.index_array, mesh.index_array_size, mesh.vertex_number);
+        }
+
+        /**
+         * @brief Builds the adjacency of a triangle list.
+         * @param indices The triangle list, 3 indices per triangle.
+         * @param index_count The number of indices (any trailing partial triangle is ignored).
+         * @param _vertex_count The number of vertices referenced by @a indices.
+         * @return False if there are no triangles.
+         */
+        bool Build(const unsigned short *indices, unsigned int index_count, unsigned int _vertex_count);
+
+        /// Releases all the data.
+        void Clear(void);
+
+        /// The half-edge following @a half_edge in its triangle.
+        static unsigned int Next(unsigned int half_edge)
+        {
+            return (half_edge % 3 == 2)? half_edge - 2: half_edge + 1;
+        }
+
+        /// The half-edge preceding @a half_edge in its triangle.
+        static unsigned int Previous(unsigned int half_edge)
+        {
+            return (half_edge % 3 == 0)? half_edge + 2: half_edge - 1;
+        }
+
+        /// The triangle of @a half_edge.
+        static unsigned int GetFace(unsigned int half_edge)
+        {
+            return half_edge / 3;
+        }
+
+        /// The opposite half-edge, ADJACENCY_INVALID on boundary or non manifold edges.
+        unsigned int GetTwin(unsigned int half_edge) const
+        {
+            return twins[half_edge];
+        }
+
+        /// The vertex @a half_edge starts from.
+        unsigned int GetOrigin(unsigned int half_edge) const
+        {
+            return origins[half_edge];
+        }
+
+        /// The vertex @a half_edge points to.
+        unsigned int GetDestination(unsigned int half_edge) const
+        {
+            return origins[Next(half_edge)];
+        }
+
+        /// Whether @a half_edge has no twin.
+        bool IsBoundary(unsigned int half_edge) const
+        {
+            return twins[half_edge] == ADJACENCY_INVALID;
+        }
+
+        /**
+         * @brief Returns a half-edge leaving @a vertex, ADJACENCY_INVALID if it is not used. For
+         * boundary vertices this is the boundary half-edge, so that 'NextAroundOrigin' visits
+         * every triangle of the fan.
+         */
+        unsigned int GetVertexHalfEdge(unsigned int vertex) const
+        {
+            return vertex_half_edges[vertex];
+        }
+
+        /**
+         * @brief Rotates around the origin of @a half_edge: returns the next outgoing half-edge
+         * of the same vertex (clockwise), or ADJACENCY_INVALID when reaching a boundary.
+         */
+        unsigned int NextAroundOrigin(unsigned int half_edge) const
+        {
+            return twins[Previous(half_edge)];
+        }
+
+        /// Returns the triangle across the edge @a edge (0 to 2) of @a face, or ADJACENCY_INVALID.
+        unsigned int GetNeighborFace(unsigned int face, unsigned int edge) const
+        {
+            unsigned int twin = twins[face * 3 + edge];
+            return (twin == ADJACENCY_INVALID)? ADJACENCY_INVALID: GetFace(twin);
+        }
+
+        unsigned int GetHalfEdgeCount(void) const
+        {
+            return (unsigned int)origins.size();
+        }
+
+        unsigned int GetFaceCount(void) const
+        {
+            return (unsigned int)origins.size() / 3;
+        }
+
+        unsigned int GetVertexCount(void) const
+        {
+            return vertex_count;
+        }
+
+        /// The half-edges of the non manifold edges (every half-edge of such an edge is listed).
+        const std::vector<unsigned int> &GetNonManifoldEdges(void) const
+        {
+            return non_manifold_edges;
+        }
+
+        /// Whether every edge is shared by at most 2 consistently oriented triangles.
+        bool IsManifold(void) const
+        {
+            return non_manifold_edges.empty();
+        }
+
+        /// Returns the number of boundary half-edges (non manifold ones excluded).
+        unsigned int GetBoundaryEdgeCount(void) const;
+
+    private:
+        unsigned int vertex_count;
+        /// Start vertex of each half-edge (a 32 bits copy of the index array).
+        std::vector<unsigned int> origins;
+        std::vector<unsigned int> twins;
+        std::vector<unsigned int> vertex_half_edges;
+        std::vector<unsigned int> non_manifold_edges;
+    };
+}
+
+#endif // MESH_ADJACENCY_H_INCLUDED
@@ -0,0 +1,64 @@
+#include "mesh_arena.h"
+
+core::MeshArena::~MeshArena()
+{
+    for (unsigned int i = 0; i < chunks.size(); ++i)
+        FreeAligned(chunks[i].memory);
+    chunks.clear();
+}
+
+void core::MeshArena::Reserve(size_t size)
+{
+    // Nothing to do if the current chunk can already hold the request.
+    if (chunks.size() && (chunks.back().size - chunks.back().used) >= size)
+        return;
+
+    AddChunk(size);
+}
+
+void *core::MeshArena::Allocate(size_t size, size_t alignment)
+{
+    size_t padded = AlignSize(size, alignment);
+    if (!chunks.size() || (AlignedOffset(chunks.back(), alignment) + padded) > chunks.back().size)
+        AddChunk(padded + alignment);
+
+    Chunk &chunk = chunks.back();
+    size_t offset = AlignedOffset(chunk, alignment);
+    used_size += padded + offset - chunk.used;
+    chunk.used = offset + padded;
+    return chunk.memory + offset;
+}
+
+size_t core::MeshArena::AlignedOffset(const Chunk &chunk, size_t alignment)
+{
+    // The alignment is computed on the address, chunks are only guaranteed MESH_ARRAY_ALIGNMENT.
+    size_t address = (size_t)(chunk.memory + chunk.used);
+    return chunk.used + (AlignSize(address, alignment) - address);
+}
+
+void core::MeshArena::AddChunk(size_t size)
+{
+    Chunk chunk;
+    chunk.size = (size > chunk_size)? size: chunk_size;
+    chunk.used = 0;
+    chunk.memory = (char *)AllocateAligned(chunk.size);
+    chunks.push_back(chunk);
+}
+
+void *core::MeshArena::AllocateAligned(size_t size, size_t alignment)
+{
+    // Over-allocate to have room for the alignment and the original pointer.
+    char *raw = new char[size + alignment + sizeof(char *)];
+    size_t address = (size_t)(raw + sizeof(char *));
+    char *aligned = (char *)((address + alignment - 1) & ~(alignment - 1));
+    ((char **)aligned)[-1] = raw;
+    return aligned;
+}
+
+void core::MeshArena::FreeAligned(void *memory)
+{
+    if (!memory)
+        return;
+
+    delete [] ((char **)memory)[-1];
+}
@@ -0,0 +1,104 @@
+/**
+ * @file mesh_arena.h
+ * @brief Linear allocator holding the attribute and index arrays of the meshes of a scene.
+ */
+#ifndef MESH_ARENA_H_INCLUDED
+#define MESH_ARENA_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+#include "shared_storage.h"
+
+/// Alignment, in bytes, of every array handed out for mesh data (SSE friendly).
+#define MESH_ARRAY_ALIGNMENT 16
+/// Default size of an arena chunk when no reservation was made (1MB).
+#define MESH_ARENA_CHUNK_SIZE (1 << 20)
+
+namespace core {
+
+    /**
+     * @brief Bump allocator used to place the mesh arrays of a whole scene in as few heap blocks
+     * as possible.
+     * @remarks Memory is never given back individually, everything is released at once when the
+     * arena is destroyed. A loader that knows the total size up front should call 'Reserve' so
+     * that the scene fits in a single chunk (and is thus released with a single free).
+     * @remarks Reference counted: the geometry buffers placed in the arena keep it alive, the
+     * creator releases its own reference with 'Release' instead of deleting it.
+     * @remarks Allocation is not thread safe.
+     */
+    class MeshArena: public SharedStorage
+    {
+    public:
+        /**
+         * @brief Creates an empty arena.
+         * @param _chunk_size The minimum size of the chunks allocated when the arena runs out.
+         */
+        MeshArena(size_t _chunk_size = MESH_ARENA_CHUNK_SIZE): chunk_size(_chunk_size), used_size(0) {}
+
+        /**
+         * @brief Makes sure the arena can serve @a size bytes without allocating a new chunk.
+         * @param size The number of bytes that will be requested.
+         */
+        void Reserve(size_t size);
+
+        /**
+         * @brief Returns a block of @a size bytes aligned on @a alignment.
+         * @param size The size of the block in bytes.
+         * @param alignment Power of 2 alignment of the block.
+         * @return A pointer to the block, never NULL.
+         */
+        void *Allocate(size_t size, size_t alignment = MESH_ARRAY_ALIGNMENT);
+
+        /// Returns the number of bytes handed out so far (alignment padding included).
+        size_t GetUsedSize(void) const
+        {
+            return used_size;
+        }
+
+        /// Returns the number of heap blocks currently held by the arena.
+        size_t GetChunkCount(void) const
+        {
+            return chunks.size();
+        }
+
+        /**
+         * @brief Returns a heap block of @a size bytes aligned on @a alignment.
+         * @remarks Must be released with 'FreeAligned'.
+         */
+        static void *AllocateAligned(size_t size, size_t alignment = MESH_ARRAY_ALIGNMENT);
+
+        /// Releases a block returned by 'AllocateAligned', NULL is ignored.
+        static void FreeAligned(void *memory);
+
+        /// Rounds @a size up to the next multiple of @a alignment (a power of 2).
+        static size_t AlignSize(size_t size, size_t alignment = MESH_ARRAY_ALIGNMENT)
+        {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+    protected:
+        /// Releases all the chunks, any array handed out by the arena becomes invalid.
+        virtual ~MeshArena();
+
+    private:
+        struct Chunk
+        {
+            char *memory;
+            size_t size;
+            size_t used;
+        };
+
+        /// Adds a chunk able to hold at least @a size bytes.
+        void AddChunk(size_t size);
+
+        /// Returns the first offset in @a chunk past its used bytes aligned on @a alignment.
+        static size_t AlignedOffset(const Chunk &chunk, size_t alignment);
+
+    private:
+        std::vector<Chunk> chunks;
+        size_t chunk_size;
+        size_t used_size;
+    };
+}
+
+#endif // MESH_ARENA_H_INCLUDED
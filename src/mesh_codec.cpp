@@ -0,0 +1,562 @@
+#include <cstring>
+#include "mesh_codec.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MESH_CODEC_SSE2
+    #include <emmintrin.h>
+#endif
+
+/// Elements per block, the byte planes of a block stay in L1 while decoding.
+#define CODEC_BLOCK_SIZE 256
+/// Bytes per group, every group of a plane is packed on the same bit width.
+#define CODEC_GROUP_SIZE 16
+/// First byte of the encoded streams, identifies the stream kind and the format version.
+#define CODEC_INDEX_TAG 0xE1
+#define CODEC_VERTEX_TAG 0xA1
+
+/// Maps signed deltas to unsigned values, small magnitudes giving small values.
+template <typename T>
+static inline T Zigzag(T delta)
+{
+    return (T)((T)(delta << 1) ^ (T)(0 - (delta >> (sizeof(T) * 8 - 1))));
+}
+
+/// Inverse of 'Zigzag'.
+template <typename T>
+static inline T Unzigzag(T value)
+{
+    return (T)((value >> 1) ^ (T)(0 - (value & 1)));
+}
+
+/// Returns the maximum encoded size of a plane of @a count bytes.
+static size_t GetPlaneBound(unsigned int count)
+{
+    unsigned int groups = (count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+    return (groups + 3) / 4 + groups * CODEC_GROUP_SIZE;
+}
+
+/// Returns the maximum encoded size of a stream.
+static size_t GetStreamBound(unsigned int count, unsigned int channels, unsigned int word_size)
+{
+    size_t size = 1;
+    for (unsigned int start = 0; start < count; start += CODEC_BLOCK_SIZE) {
+        unsigned int block_count = (count - start < CODEC_BLOCK_SIZE)? count - start: CODEC_BLOCK_SIZE;
+        size += GetPlaneBound(block_count) * channels * word_size;
+    }
+    return size;
+}
+
+/**
+ * @brief Encodes a plane of @a count bytes (padded with zeros up to the group size).
+ * @return The new write position, or NULL if the output is too small.
+ */
+static unsigned char *EncodeBytePlane(unsigned char *out, const unsigned char *out_end, const unsigned char *plane,
+                                      unsigned int count)
+{
+    unsigned int groups = (count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+    unsigned int header_size = (groups + 3) / 4;
+    if ((size_t)(out_end - out) < header_size)
+        return NULL;
+
+    // The 2 bits width codes of all the groups come first.
+    unsigned char *header = out;
+    memset(header, 0, header_size);
+    out += header_size;
+
+    for (unsigned int g = 0; g < groups; ++g) {
+        const unsigned char *group = plane + g * CODEC_GROUP_SIZE;
+        unsigned char maximum = 0;
+        for (unsigned int i = 0; i < CODEC_GROUP_SIZE; ++i)
+            maximum = (group[i] > maximum)? group[i]: maximum;
+
+        // 0: all zeros, 1: 2 bits, 2: 4 bits, 3: raw bytes.
+        unsigned int code = (maximum == 0)? 0: (maximum < 4)? 1: (maximum < 16)? 2: 3;
+        unsigned int payload = (code == 0)? 0: (code == 1)? 4: (code == 2)? 8: 16;
+        header[g / 4] |= (unsigned char)(code << ((g % 4) * 2));
+
+        if ((size_t)(out_end - out) < payload)
+            return NULL;
+
+        if (code == 1) {
+            for (unsigned int j = 0; j < 4; ++j)
+                out[j] = (unsigned char)(group[j * 4] | (group[j * 4 + 1] << 2) | (group[j * 4 + 2] << 4) | (group[j * 4 + 3] << 6));
+        } else if (code == 2) {
+            for (unsigned int j = 0; j < 8; ++j)
+                out[j] = (unsigned char)(group[j * 2] | (group[j * 2 + 1] << 4));
+        } else if (code == 3) {
+            memcpy(out, group, CODEC_GROUP_SIZE);
+        }
+        out += payload;
+    }
+
+    return out;
+}
+
+/**
+ * @brief Decodes a plane of @a count bytes, @a plane must have room for the padded groups.
+ * @return The new read position, or NULL if the input is truncated.
+ */
+static const unsigned char *DecodeBytePlane(const unsigned char *in, const unsigned char *in_end, unsigned char *plane,
+                                            unsigned int count)
+{
+    unsigned int groups = (count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+    unsigned int header_size = (groups + 3) / 4;
+    if ((size_t)(in_end - in) < header_size)
+        return NULL;
+
+    const unsigned char *header = in;
+    in += header_size;
+
+    for (unsigned int g = 0; g < groups; ++g) {
+        unsigned char *group = plane + g * CODEC_GROUP_SIZE;
+        unsigned int code = (header[g / 4] >> ((g % 4) * 2)) & 3;
+
+#ifdef MESH_CODEC_SSE2
+        if (code == 0) {
+            _mm_storeu_si128((__m128i *)group, _mm_setzero_si128());
+        } else if (code == 1) {
+            if (in_end - in < 4)
+                return NULL;
+            int packed;
+            memcpy(&packed, in, 4);
+            __m128i bytes = _mm_cvtsi32_si128(packed);
+            __m128i mask = _mm_set1_epi8(3);
+            // Shifting 16 bits lanes is fine, the mask drops the bits coming from the next byte.
+            __m128i v0 = _mm_and_si128(bytes, mask);
+            __m128i v1 = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+            __m128i v2 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            __m128i v3 = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+            __m128i v01 = _mm_unpacklo_epi8(v0, v1);
+            __m128i v23 = _mm_unpacklo_epi8(v2, v3);
+            _mm_storeu_si128((__m128i *)group, _mm_unpacklo_epi16(v01, v23));
+            in += 4;
+        } else if (code == 2) {
+            if (in_end - in < 8)
+                return NULL;
+            __m128i bytes = _mm_loadl_epi64((const __m128i *)in);
+            __m128i mask = _mm_set1_epi8(15);
+            __m128i low = _mm_and_si128(bytes, mask);
+            __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            _mm_storeu_si128((__m128i *)group, _mm_unpacklo_epi8(low, high));
+            in += 8;
+        } else {
+            if (in_end - in < 16)
+                return NULL;
+            _mm_storeu_si128((__m128i *)group, _mm_loadu_si128((const __m128i *)in));
+            in += 16;
+        }
+#else
+        if (code == 0) {
+            memset(group, 0, CODEC_GROUP_SIZE);
+        } else if (code == 1) {
+            if (in_end - in < 4)
+                return NULL;
+            for (unsigned int j = 0; j < 4; ++j) {
+                group[j * 4 + 0] = in[j] & 3;
+                group[j * 4 + 1] = (in[j] >> 2) & 3;
+                group[j * 4 + 2] = (in[j] >> 4) & 3;
+                group[j * 4 + 3] = (in[j] >> 6) & 3;
+            }
+            in += 4;
+        } else if (code == 2) {
+            if (in_end - in < 8)
+                return NULL;
+            for (unsigned int j = 0; j < 8; ++j) {
+                group[j * 2 + 0] = in[j] & 15;
+                group[j * 2 + 1] = (in[j] >> 4) & 15;
+            }
+            in += 8;
+        } else {
+            if (in_end - in < 16)
+                return NULL;
+            memcpy(group, in, CODEC_GROUP_SIZE);
+            in += 16;
+        }
+#endif
+    }
+
+    return in;
+}
+
+/**
+ * @brief Rebuilds the values of a block from its byte planes: joins the bytes, undoes the zigzag
+ * and accumulates the deltas starting from @a last (which is updated).
+ */
+static void ReconstructWords(unsigned char planes[][CODEC_BLOCK_SIZE], unsigned int count, unsigned int &last,
+                             unsigned int *words)
+{
+    unsigned int i = 0;
+#ifdef MESH_CODEC_SSE2
+    __m128i carry = _mm_set1_epi32((int)last);
+    __m128i one = _mm_set1_epi32(1);
+    for (; i + 16 <= count; i += 16) {
+        __m128i p0 = _mm_loadu_si128((const __m128i *)(planes[0] + i));
+        __m128i p1 = _mm_loadu_si128((const __m128i *)(planes[1] + i));
+        __m128i p2 = _mm_loadu_si128((const __m128i *)(planes[2] + i));
+        __m128i p3 = _mm_loadu_si128((const __m128i *)(planes[3] + i));
+        __m128i low0 = _mm_unpacklo_epi8(p0, p1);
+        __m128i low1 = _mm_unpackhi_epi8(p0, p1);
+        __m128i high0 = _mm_unpacklo_epi8(p2, p3);
+        __m128i high1 = _mm_unpackhi_epi8(p2, p3);
+        __m128i values[4] = {
+            _mm_unpacklo_epi16(low0, high0), _mm_unpackhi_epi16(low0, high0),
+            _mm_unpacklo_epi16(low1, high1), _mm_unpackhi_epi16(low1, high1)
+        };
+
+        for (unsigned int j = 0; j < 4; ++j) {
+            __m128i v = values[j];
+            v = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+            // Inclusive prefix sum of the 4 lanes, then add the running value.
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, carry);
+            carry = _mm_shuffle_epi32(v, 0xFF);
+            _mm_storeu_si128((__m128i *)(words + i + j * 4), v);
+        }
+    }
+    last = (unsigned int)_mm_cvtsi128_si32(carry);
+#endif
+    for (; i < count; ++i) {
+        unsigned int value = planes[0][i] | (planes[1][i] << 8) | (planes[2][i] << 16) | ((unsigned int)planes[3][i] << 24);
+        last += Unzigzag(value);
+        words[i] = last;
+    }
+}
+
+/// Same as above for 16 bits values.
+static void ReconstructWords(unsigned char planes[][CODEC_BLOCK_SIZE], unsigned int count, unsigned short &last,
+                             unsigned short *words)
+{
+    unsigned int i = 0;
+#ifdef MESH_CODEC_SSE2
+    __m128i carry = _mm_set1_epi16((short)last);
+    __m128i one = _mm_set1_epi16(1);
+    for (; i + 16 <= count; i += 16) {
+        __m128i p0 = _mm_loadu_si128((const __m128i *)(planes[0] + i));
+        __m128i p1 = _mm_loadu_si128((const __m128i *)(planes[1] + i));
+        __m128i values[2] = { _mm_unpacklo_epi8(p0, p1), _mm_unpackhi_epi8(p0, p1) };
+
+        for (unsigned int j = 0; j < 2; ++j) {
+            __m128i v = values[j];
+            v = _mm_xor_si128(_mm_srli_epi16(v, 1), _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(v, one)));
+            v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+            v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi16(v, carry);
+            // Broadcast the last lane.
+            carry = _mm_shufflehi_epi16(v, 0xFF);
+            carry = _mm_unpackhi_epi64(carry, carry);
+            _mm_storeu_si128((__m128i *)(words + i + j * 8), v);
+        }
+    }
+    last = (unsigned short)_mm_extract_epi16(carry, 0);
+#endif
+    for (; i < count; ++i) {
+        unsigned short value = (unsigned short)(planes[0][i] | (planes[1][i] << 8));
+        last = (unsigned short)(last + Unzigzag(value));
+        words[i] = last;
+    }
+}
+
+/**
+ * @brief Encodes @a count elements of @a channels values of type T.
+ * @return The encoded size, 0 if @a buffer is too small.
+ */
+template <typename T>
+static size_t EncodeStream(unsigned char *buffer, size_t buffer_size, unsigned char tag, const T *data,
+                           unsigned int count, unsigned int channels)
+{
+    unsigned char planes[sizeof(T)][CODEC_BLOCK_SIZE];
+    std::vector<T> last(channels, 0);
+    unsigned char *out = buffer;
+    const unsigned char *out_end = buffer + buffer_size;
+
+    if (buffer_size < 1)
+        return 0;
+    *out++ = tag;
+
+    for (unsigned int start = 0; start < count; start += CODEC_BLOCK_SIZE) {
+        unsigned int block_count = (count - start < CODEC_BLOCK_SIZE)? count - start: CODEC_BLOCK_SIZE;
+        // Pad the last group with zeros.
+        unsigned int padded = (block_count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE * CODEC_GROUP_SIZE;
+
+        for (unsigned int c = 0; c < channels; ++c) {
+            for (unsigned int i = 0; i < padded; ++i) {
+                T value = (i < block_count)? Zigzag((T)(data[(start + i) * channels + c] - last[c])): 0;
+                if (i < block_count)
+                    last[c] = data[(start + i) * channels + c];
+
+                for (unsigned int k = 0; k < sizeof(T); ++k)
+                    planes[k][i] = (unsigned char)(value >> (k * 8));
+            }
+
+            for (unsigned int k = 0; k < sizeof(T); ++k) {
+                out = EncodeBytePlane(out, out_end, planes[k], block_count);
+                if (!out)
+                    return 0;
+            }
+        }
+    }
+
+    return out - buffer;
+}
+
+/// Decodes a stream produced by 'EncodeStream', returns false if it is malformed.
+template <typename T>
+static bool DecodeStream(T *destination, unsigned int count, unsigned int channels, const unsigned char *buffer,
+                         size_t buffer_size, unsigned char tag)
+{
+    unsigned char planes[sizeof(T)][CODEC_BLOCK_SIZE];
+    T words[CODEC_BLOCK_SIZE];
+    std::vector<T> last(channels, 0);
+    const unsigned char *in = buffer;
+    const unsigned char *in_end = buffer + buffer_size;
+
+    if (buffer_size < 1 || *in++ != tag)
+        return false;
+
+    for (unsigned int start = 0; start < count; start += CODEC_BLOCK_SIZE) {
+        unsigned int block_count = (count - start < CODEC_BLOCK_SIZE)? count - start: CODEC_BLOCK_SIZE;
+
+        for (unsigned int c = 0; c < channels; ++c) {
+            for (unsigned int k = 0; k < sizeof(T); ++k) {
+                in = DecodeBytePlane(in, in_end, planes[k], block_count);
+                if (!in)
+                    return false;
+            }
+
+            ReconstructWords(planes, block_count, last[c], words);
+
+            if (channels == 1) {
+                memcpy(destination + start, words, block_count * sizeof(T));
+            } else {
+                T *target = destination + start * channels + c;
+                for (unsigned int i = 0; i < block_count; ++i)
+                    target[i * channels] = words[i];
+            }
+        }
+    }
+
+    return in == in_end;
+}
+
+size_t core::MeshCodec::GetIndexBufferBound(unsigned int index_count)
+{
+    return GetStreamBound(index_count, 1, sizeof(unsigned short));
+}
+
+size_t core::MeshCodec::EncodeIndexBuffer(unsigned char *buffer, size_t buffer_size, const unsigned short *indices,
+                                          unsigned int index_count)
+{
+    return EncodeStream(buffer, buffer_size, CODEC_INDEX_TAG, indices, index_count, 1);
+}
+
+bool core::MeshCodec::DecodeIndexBuffer(unsigned short *destination, unsigned int index_count,
+                                        const unsigned char *buffer, size_t buffer_size)
+{
+    return DecodeStream(destination, index_count, 1, buffer, buffer_size, CODEC_INDEX_TAG);
+}
+
+size_t core::MeshCodec::GetVertexBufferBound(unsigned int vertex_count, unsigned int vertex_size)
+{
+    return GetStreamBound(vertex_count, vertex_size / 4, 4);
+}
+
+size_t core::MeshCodec::EncodeVertexBuffer(unsigned char *buffer, size_t buffer_size, const void *vertices,
+                                           unsigned int vertex_count, unsigned int vertex_size)
+{
+    if (!vertex_size || vertex_size % 4)
+        return 0;
+
+    return EncodeStream(buffer, buffer_size, CODEC_VERTEX_TAG, (const unsigned int *)vertices, vertex_count, vertex_size / 4);
+}
+
+bool core::MeshCodec::DecodeVertexBuffer(void *destination, unsigned int vertex_count, unsigned int vertex_size,
+                                         const unsigned char *buffer, size_t buffer_size)
+{
+    if (!vertex_size || vertex_size % 4)
+        return false;
+
+    return DecodeStream((unsigned int *)destination, vertex_count, vertex_size / 4, buffer, buffer_size, CODEC_VERTEX_TAG);
+}
+
+/// Appends an encoded vertex array to @a data, prefixed by its size.
+static void AppendVertexStream(std::vector<unsigned char> &data, const float *array, unsigned int vertex_count,
+                               unsigned int components)
+{
+    size_t offset = data.size();
+    size_t bound = core::MeshCodec::GetVertexBufferBound(vertex_count, components * sizeof(float));
+    data.resize(offset + 4 + bound);
+
+    unsigned int size = (unsigned int)core::MeshCodec::EncodeVertexBuffer(&data[offset + 4], bound, array, vertex_count,
+                                                                         components * sizeof(float));
+    memcpy(&data[offset], &size, 4);
+    data.resize(offset + 4 + size);
+}
+
+/// Reads the next size prefixed stream, returns false if it runs past the end of the data.
+static bool ReadStream(const std::vector<unsigned char> &data, size_t &offset, const unsigned char *&stream, size_t &size)
+{
+    unsigned int stream_size = 0;
+    if (offset + 4 > data.size())
+        return false;
+
+    memcpy(&stream_size, &data[offset], 4);
+    offset += 4;
+    if (offset + stream_size > data.size())
+        return false;
+
+    stream = &data[offset];
+    size = stream_size;
+    offset += stream_size;
+    return true;
+}
+
+bool core::MeshCodec::CompressMesh(const Mesh &mesh, CompressedMesh &compressed)
+{
+    if (!mesh.EnsureResident() || !mesh.vertices || !mesh.index_array)
+        return false;
+
+    compressed.name = mesh.name;
+    compressed.materials = mesh.materials;
+    compressed.vertex_number = mesh.vertex_number;
+    compressed.uv_layer_count = mesh.uv_layer_count;
+    compressed.index_array_size = mesh.index_array_size;
+    compressed.is_using_colors = mesh.is_using_colors && mesh.colors;
+    compressed.bounds = mesh.bounds;
+    compressed.ranges = mesh.ranges;
+    compressed.hulls = mesh.hulls;
+    compressed.data.clear();
+
+    // Same order as the mesh layout.
+    AppendVertexStream(compressed.data, mesh.vertices, mesh.vertex_number, 4);
+    AppendVertexStream(compressed.data, mesh.normals, mesh.vertex_number, 3);
+    if (compressed.is_using_colors)
+        AppendVertexStream(compressed.data, mesh.colors, mesh.vertex_number, 4);
+
+    for (unsigned int i = 0; i < mesh.uv_layer_count; ++i) {
+        AppendVertexStream(compressed.data, mesh.tangents[i], mesh.vertex_number, 3);
+        AppendVertexStream(compressed.data, mesh.binormals[i], mesh.vertex_number, 3);
+        AppendVertexStream(compressed.data, mesh.uv_coordinates[i], mesh.vertex_number, 3);
+    }
+
+    size_t offset = compressed.data.size();
+    size_t bound = GetIndexBufferBound(mesh.index_array_size);
+    compressed.data.resize(offset + 4 + bound);
+    unsigned int size = (unsigned int)EncodeIndexBuffer(&compressed.data[offset + 4], bound, mesh.index_array,
+                                                        mesh.index_array_size);
+    memcpy(&compressed.data[offset], &size, 4);
+    compressed.data.resize(offset + 4 + size);
+
+    // The bounds over-allocate, keep only what is used.
+    std::vector<unsigned char>(compressed.data).swap(compressed.data);
+    return true;
+}
+
+bool core::MeshCodec::DecompressMesh(const CompressedMesh &compressed, Mesh &mesh, MeshArena *arena)
+{
+    mesh.Allocate(compressed.vertex_number, compressed.uv_layer_count, compressed.index_array_size,
+                  compressed.is_using_colors, arena);
+    mesh.name = compressed.name;
+    mesh.materials = compressed.materials;
+    mesh.bounds = compressed.bounds;
+    mesh.ranges = compressed.ranges;
+    mesh.hulls = compressed.hulls;
+
+    if (!DecodeArrays(compressed, mesh)) {
+        mesh.Release();
+        return false;
+    }
+    return true;
+}
+
+bool core::MeshCodec::DecodeArrays(const CompressedMesh &compressed, Mesh &mesh)
+{
+    const unsigned char *stream = NULL;
+    size_t size = 0, offset = 0;
+    unsigned int n = compressed.vertex_number;
+    bool valid = true;
+
+    valid = valid && ReadStream(compressed.data, offset, stream, size) && DecodeVertexBuffer(mesh.vertices, n, 16, stream, size);
+    valid = valid && ReadStream(compressed.data, offset, stream, size) && DecodeVertexBuffer(mesh.normals, n, 12, stream, size);
+    if (compressed.is_using_colors)
+        valid = valid && ReadStream(compressed.data, offset, stream, size) && DecodeVertexBuffer(mesh.colors, n, 16, stream, size);
+
+    for (unsigned int i = 0; i < compressed.uv_layer_count; ++i) {
+        valid = valid && ReadStream(compressed.data, offset, stream, size) && DecodeVertexBuffer(mesh.tangents[i], n, 12, stream, size);
+        valid = valid && ReadStream(compressed.data, offset, stream, size) && DecodeVertexBuffer(mesh.binormals[i], n, 12, stream, size);
+        valid = valid && ReadStream(compressed.data, offset, stream, size) && DecodeVertexBuffer(mesh.uv_coordinates[i], n, 12, stream, size);
+    }
+
+    valid = valid && ReadStream(compressed.data, offset, stream, size) &&
+            DecodeIndexBuffer(mesh.index_array, compressed.index_array_size, stream, size);
+
+    return valid;
+}
+
+bool core::MeshCodec::CompressToSource(Mesh &mesh, CompressedPayloadSource &source)
+{
+    CompressedMesh compressed;
+    if (!CompressMesh(mesh, compressed))
+        return false;
+
+    // 'SetPayload' keeps the counts and releases the arrays.
+    mesh.SetPayload(&source, source.Add(compressed));
+    return true;
+}
+
+unsigned int core::MeshCodec::CompressModel(Model &model, CompressedPayloadSource &source)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < model.meshes.size(); ++i) {
+        if (model.meshes[i]->IsResident() && CompressToSource(*model.meshes[i], source))
+            ++count;
+    }
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        count += CompressModel(*model.sub_models[i], source);
+
+    if (model.arena)
+        model.arena->Release();
+    model.arena = NULL;
+    return count;
+}
+
+unsigned int core::CompressedPayloadSource::Add(CompressedMesh &compressed)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    payloads.push_back(CompressedMesh());
+    CompressedMesh &payload = payloads.back();
+    payload.vertex_number = compressed.vertex_number;
+    payload.uv_layer_count = compressed.uv_layer_count;
+    payload.index_array_size = compressed.index_array_size;
+    payload.is_using_colors = compressed.is_using_colors;
+    payload.data.swap(compressed.data);
+    compressed_size += payload.data.size();
+    return (unsigned int)(payloads.size() - 1);
+}
+
+core::GeometryBuffer *core::CompressedPayloadSource::Fetch(unsigned int payload)
+{
+    const CompressedMesh *compressed = NULL;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (payload < payloads.size())
+            compressed = &payloads[payload];
+    }
+    if (!compressed)
+        return NULL;
+
+    // A buffer in the layout of 'Mesh::Allocate', decoded through a mesh mapped on it.
+    size_t size = Mesh::GetStorageSize(compressed->vertex_number, compressed->uv_layer_count,
+                                       compressed->index_array_size, compressed->is_using_colors) -
+                  GeometryBuffer::GetAllocationSize(0);
+    GeometryBuffer *buffer = GeometryBuffer::Create(size);
+    Mesh mesh;
+    if (!mesh.Map(buffer, compressed->vertex_number, compressed->uv_layer_count, compressed->index_array_size,
+                  compressed->is_using_colors) || !MeshCodec::DecodeArrays(*compressed, mesh)) {
+        buffer->Release();
+        return NULL;
+    }
+    return buffer;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file mesh_codec.h
+ * @brief In memory compression of mesh index and vertex data.
+ */
+#ifndef MESH_CODEC_H_INCLUDED
+#define MESH_CODEC_H_INCLUDED
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "mesh.h"
+#include "model.h"
+
+namespace core {
+
+    class CompressedPayloadSource;
+
+    /**
+     * @brief A mesh whose arrays are kept compressed by 'MeshCodec', the header data (name,
+     * counts, materials, bounds, ranges and hulls) is kept as is.
+     */
+    class CompressedMesh
+    {
+    public:
+        CompressedMesh(): vertex_number(0), uv_layer_count(0), index_array_size(0), is_using_colors(false) {}
+
+        /// Returns the number of bytes used by the compressed arrays.
+        size_t GetCompressedSize(void) const
+        {
+            return data.size();
+        }
+
+        /// Returns the number of bytes the arrays occupy once decompressed.
+        size_t GetUncompressedSize(void) const
+        {
+            return Mesh::GetStorageSize(vertex_number, uv_layer_count, index_array_size, is_using_colors);
+        }
+
+    public:
+        std::string name;
+        std::vector<Material> materials;
+        unsigned int vertex_number;
+        unsigned int uv_layer_count;
+        unsigned int index_array_size;
+        bool is_using_colors;
+        math::BoundingBox bounds;
+        std::vector<MeshRange> ranges;
+        std::vector<ConvexHull> hulls;
+
+        /// The encoded streams, in 'Mesh' array order, each prefixed by its 32 bits size.
+        std::vector<unsigned char> data;
+    };
+
+    /**
+     * @brief Lossless index and vertex buffer codecs, in the spirit of meshoptimizer's.
+     * @remarks Both codecs store every element as the zigzag encoded delta with the previous one
+     * (integer delta of the float bit patterns for vertices), per channel. The bytes of the deltas
+     * are split in planes, and each plane is stored in groups of 16 bytes packed on 0, 2, 4 or 8
+     * bits. Cache ordered index buffers have small deltas and compress to about a byte per index.
+     * @remarks Decoding uses SSE2 when available and works on blocks that fit in L1.
+     */
+    class MeshCodec
+    {
+    public:
+        /// Returns the maximum encoded size of @a index_count indices.
+        static size_t GetIndexBufferBound(unsigned int index_count);
+
+        /**
+         * @brief Encodes an index buffer.
+         * @param [out] buffer The destination, should be 'GetIndexBufferBound' bytes.
+         * @param buffer_size The size of @a buffer.
+         * @param indices The indices to encode.
+         * @param index_count The number of indices.
+         * @return The number of bytes written, 0 if @a buffer is too small.
+         */
+        static size_t EncodeIndexBuffer(unsigned char *buffer, size_t buffer_size, const unsigned short *indices,
+                                        unsigned int index_count);
+
+        /**
+         * @brief Decodes an index buffer produced by 'EncodeIndexBuffer'.
+         * @param [out] destination Receives @a index_count indices.
+         * @return False if the data is malformed.
+         */
+        static bool DecodeIndexBuffer(unsigned short *destination, unsigned int index_count, const unsigned char *buffer,
+                                      size_t buffer_size);
+
+        /// Returns the maximum encoded size of @a vertex_count vertices of @a vertex_size bytes.
+        static size_t GetVertexBufferBound(unsigned int vertex_count, unsigned int vertex_size);
+
+        /**
+         * @brief Encodes a vertex buffer.
+         * @param [out] buffer The destination, should be 'GetVertexBufferBound' bytes.
+         * @param buffer_size The size of @a buffer.
+         * @param vertices The interleaved vertex data.
+         * @param vertex_count The number of vertices.
+         * @param vertex_size The size of a vertex, must be a multiple of 4 (i.e. floats).
+         * @return The number of bytes written, 0 on failure.
+         */
+        static size_t EncodeVertexBuffer(unsigned char *buffer, size_t buffer_size, const void *vertices,
+                                         unsigned int vertex_count, unsigned int vertex_size);
+
+        /**
+         * @brief Decodes a vertex buffer produced by 'EncodeVertexBuffer'.
+         * @param [out] destination Receives @a vertex_count vertices of @a vertex_size bytes.
+         * @return False if the data is malformed.
+         */
+        static bool DecodeVertexBuffer(void *destination, unsigned int vertex_count, unsigned int vertex_size,
+                                       const unsigned char *buffer, size_t buffer_size);
+
+        /**
+         * @brief Compresses all the arrays of @a mesh into @a compressed.
+         * @return False if the mesh has no geometry.
+         */
+        static bool CompressMesh(const Mesh &mesh, CompressedMesh &compressed);
+
+        /**
+         * @brief Restores the arrays of a compressed mesh into @a mesh (previous data is released).
+         * @param arena Optional arena to allocate the arrays from.
+         * @return False if the compressed data is malformed.
+         */
+        static bool DecompressMesh(const CompressedMesh &compressed, Mesh &mesh, MeshArena *arena = NULL);
+
+        /**
+         * @brief Keeps @a mesh compressed in @a source: its arrays are encoded and released, they
+         * are decoded again the first time 'Mesh::EnsureResident' is called.
+         * @return False if the mesh has no geometry, it is then left as is.
+         */
+        static bool CompressToSource(Mesh &mesh, CompressedPayloadSource &source);
+
+        /**
+         * @brief Same as above for every resident mesh of @a model and its sub models (meshes
+         * waiting for their payload are already cold). The arenas of the hierarchy are released,
+         * their memory goes with the last mesh still using them.
+         * @return The number of meshes compressed.
+         */
+        static unsigned int CompressModel(Model &model, CompressedPayloadSource &source);
+
+    private:
+        /// Decodes the arrays of @a compressed into those of @a mesh, already laid out for them.
+        static bool DecodeArrays(const CompressedMesh &compressed, Mesh &mesh);
+
+        friend class CompressedPayloadSource;
+    };
+
+    /**
+     * @brief Serves the arrays of meshes kept compressed in memory, each fetch decodes them in a
+     * heap buffer (see 'MeshCodec::CompressToSource').
+     * @remarks The compressed data lives as long as the source, that is until every mesh using it
+     * is resident.
+     */
+    class CompressedPayloadSource: public MeshPayloadSource
+    {
+    public:
+        CompressedPayloadSource(): compressed_size(0) {}
+
+        /// Takes over the data of @a compressed, returns its payload identifier.
+        unsigned int Add(CompressedMesh &compressed);
+
+        virtual GeometryBuffer *Fetch(unsigned int payload);
+
+        /// Returns the number of bytes used by the compressed arrays of all the payloads.
+        size_t GetCompressedSize(void) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return compressed_size;
+        }
+
+    protected:
+        virtual ~CompressedPayloadSource() {}
+
+    private:
+        /// Guarded by 'mutex', as is the size. The payloads never move nor change once added.
+        std::deque<CompressedMesh> payloads;
+        size_t compressed_size;
+        mutable std::mutex mutex;
+    };
+}
+
+#endif // MESH_CODEC_H_INCLUDED
@@ -0,0 +1,33 @@
+/**
+ * @file mesh_payload_source.h
+ * @brief Interface of the providers of mesh arrays loaded on first use.
+ */
+#ifndef MESH_PAYLOAD_SOURCE_H_INCLUDED
+#define MESH_PAYLOAD_SOURCE_H_INCLUDED
+
+#include "shared_storage.h"
+#include "geometry_buffer.h"
+
+namespace core {
+
+    /**
+     * @brief Provides the arrays (the payload) of meshes that were loaded without them, see
+     * 'Mesh::SetPayload'. The meshes hold a reference on their source until they are resident.
+     * @remarks Implementations must be thread safe, so that payloads can be fetched and prefetched
+     * from any thread.
+     */
+    class MeshPayloadSource: public SharedStorage
+    {
+    public:
+        /**
+         * @brief Returns the geometry of @a payload, in the layout of 'Mesh::Allocate'.
+         * @return A buffer the caller holds a reference on, or NULL on failure.
+         */
+        virtual GeometryBuffer *Fetch(unsigned int payload) = 0;
+
+        /// Hints that @a payload will be fetched soon, by default nothing is done.
+        virtual void Prefetch(unsigned int /*payload*/) {}
+    };
+}
+
+#endif // MESH_PAYLOAD_SOURCE_H_INCLUDED
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include "model.h"
+
+core::Model::Model(const Model &model): name(model.name), transform(model.transform), is_static(model.is_static),
+    release_meshes_on_destroy(true), release_models_on_destroy(true), arena(model.arena)
+{
+    for (unsigned int i = 0; i < model.meshes.size(); ++i)
+        meshes.push_back(new Mesh(*model.meshes[i]));
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        sub_models.push_back(new Model(*model.sub_models[i]));
+
+    if (arena)
+        arena->AddRef();
+}
+
+core::Model &core::Model::operator =(const Model &model)
+{
+    if (this == &model)
+        return *this;
+
+    // The copy is complete before anything is released, 'model' could be part of this hierarchy.
+    // The current hierarchy goes away with 'copy', released the same way the destructor does.
+    Model copy(model);
+    std::swap(name, copy.name);
+    std::swap(transform, copy.transform);
+    std::swap(is_static, copy.is_static);
+    meshes.swap(copy.meshes);
+    std::swap(release_meshes_on_destroy, copy.release_meshes_on_destroy);
+    sub_models.swap(copy.sub_models);
+    std::swap(release_models_on_destroy, copy.release_models_on_destroy);
+    std::swap(arena, copy.arena);
+    return *this;
+}
@@ -6,6 +6,7 @@
 #define MODEL_H_INCLUDED
 
 #include "mesh.h"
+#include "transform.h"
 #include <string>
 #include <vector>
 
@@ -14,17 +15,27 @@ namespace core {
     /**
      * @brief Holds the model class, which for example, could parent and render a mesh object or
      * another model object.
-     * @remarks Transformation data should be added to this class, including translation, rotation
-     * and scale transformations.
+     * @remarks The meshes and sub models are placed by 'transform', relative to the parent model.
      */
     class Model
     {
     public:
-        Model(): release_meshes_on_destroy(true), release_models_on_destroy(true) {}
+        Model(): is_static(true), release_meshes_on_destroy(true), release_models_on_destroy(true), arena(NULL) {}
+
+        /**
+         * @brief Copies the hierarchy, the meshes of the copy share their geometry with @a model
+         * (see 'Mesh::MakeWritable'), which makes instancing a prop cheap. The copy owns all its
+         * meshes and sub models regardless of the release flags of @a model.
+         */
+        Model(const Model &model);
+
+        /// Replaces the hierarchy with a copy of @a model, see the copy constructor.
+        Model &operator =(const Model &model);
 
         /**
          * @brief Destroys the meshes and sub models associated with the model, if the appropriate
-         * release flags indicate as such, otherwise just remove the references.
+         * release flags indicate as such, otherwise just remove the references. The mesh arena is
+         * released last, once no mesh of the hierarchy references it anymore.
          */
         virtual ~Model()
         {
@@ -40,6 +51,10 @@ namespace core {
                     delete sub_models[i];
             }
             sub_models.clear();
+
+            if (arena)
+                arena->Release();
+            arena = NULL;
         }
 
         /**
@@ -64,14 +79,43 @@ namespace core {
             return paths;
         }
 
+        /**
+         * @brief Hints that the arrays of every mesh of the hierarchy will be used soon (see
+         * 'Mesh::Prefetch'), i.e. a model about to come into view.
+         */
+        void Prefetch(void) const
+        {
+            for (unsigned int i = 0; i < meshes.size(); ++i)
+                meshes[i]->Prefetch();
+
+            for (unsigned int i = 0; i < sub_models.size(); ++i)
+                sub_models[i]->Prefetch();
+        }
+
     public:
         std::string name;
 
+        /// Transformation of the model relative to its parent, composed as matrices when walking the hierarchy.
+        math::Transform transform;
+
+        /// Whether the model never moves once loaded, which allows 'StaticBatcher' to merge it.
+        bool is_static;
+
+        /**
+         * @remarks Prefer copying meshes (which shares their geometry) over sharing 'Mesh'
+         * pointers between models and clearing the release flags.
+         */
         std::vector<Mesh *> meshes;
         bool release_meshes_on_destroy;
 
         std::vector<Model *> sub_models;
         bool release_models_on_destroy;
+
+        /**
+         * @brief Arena holding the mesh arrays of the hierarchy, usually only set on the scene
+         * root by the loader. The model holds a reference on it.
+         */
+        MeshArena *arena;
     };
 }
 
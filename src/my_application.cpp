@@ -1,7 +1,11 @@
 #include <windows.h>
 #include "oglrenderer.h"
-#include "ase_serializer.h"
+#include "frame_graph.h"
+#include "job_system.h"
 #include "model.h"
+#include "mesh_codec.h"
+#include "scene_loader.h"
+#include "static_batcher.h"
 #include "application.h"
 #include "gvector.h"
 #include "point.h"
@@ -9,6 +13,7 @@
 #include "frameratecontroller.h"
 #include "pipeline.h"
 #include "camera.h"
+#include "matrix_chain.h"
 
 // Added library for test purposes
 #include "JsonUtility.h"
@@ -17,6 +22,23 @@
 extern int client_area_width;
 extern int client_area_height;
 
+/**
+ * @brief Merges the meshes of a source level to cut down the draw calls, run by the loader workers
+ * (cooked levels are batched by the cooker). The merged geometry is then kept compressed, each
+ * mesh is decoded the first time it is drawn and the meshes never seen stay compressed.
+ */
+static core::Model *BatchScene(core::Model *scene)
+{
+    core::Model *batched = core::StaticBatcher::Build(*scene);
+    delete scene;
+
+    // The meshes hold the references on the source.
+    core::CompressedPayloadSource *source = new core::CompressedPayloadSource();
+    core::MeshCodec::CompressModel(*batched, *source);
+    source->Release();
+    return batched;
+}
+
 namespace core {
 
     /**
@@ -26,7 +48,7 @@ namespace core {
     class MyApplication: public Application
     {
     public:
-        MyApplication(): firsttime(true), x(0), y(0), dx(0), dy(0), yanglelimit(0), mousex(0), mousey(0), oldmousex(-1), oldmousey(-1) {}
+        MyApplication(): scene(NULL), scene_load(NULL), firsttime(true), x(0), y(0), dx(0), dy(0), yanglelimit(0), mousex(0), mousey(0), oldmousex(-1), oldmousey(-1) {}
         virtual ~MyApplication() {}
 
         virtual void Initialize()
@@ -34,9 +56,22 @@ namespace core {
             renderer = new OGLRenderer();
             renderer->Initialize();
 
-            serializer = new ASESerializer();
-            scene = serializer->LoadSceneFromFile(std::string("assets\\textures\\test01.ASE"));
-            renderer->LoadTextureMaps(scene->GetTexturesList());
+            // Cooked assets are served from the archive when there is one, loose files otherwise.
+            archive = PakArchive::Open("assets.pak");
+            renderer->SetArchive(archive);
+
+            // The level streams in on the job system workers, the main loop keeps running meanwhile.
+            JobSystem::Initialize();
+            loader = new SceneLoader(renderer, archive);
+            // The cooked level is read from the archive already batched, the source is parsed and
+            // batched without one.
+            std::string level("assets\\textures\\test01.scene");
+            SceneProcessor processor;
+            if (!archive || !archive->Contains(level)) {
+                level = "assets\\textures\\test01.ASE";
+                processor = BatchScene;
+            }
+            scene_load = loader->Load(level, processor);
 
             pipeline = new Pipeline();
             pipeline->SetViewport(0, 0, client_area_width, client_area_height);
@@ -54,6 +89,8 @@ namespace core {
             utils::FrameRateController::Initialize();
             utils::FrameRateController::LockFrameRateAt(60);
 
+            BuildFrameGraph();
+
 			// Ugly test code
 			TestCode();
         }
@@ -62,6 +99,46 @@ namespace core {
         {
             utils::FrameRateController::Start();
 
+            // Main thread jobs queued by the workers (see 'JobSystem') run while the graph executes.
+            frame_graph.Execute();
+
+            // The critical path of this frame shows in the title of the next one.
+            if (!scene_load)
+                renderer->SetStatus(frame_graph.GetReport());
+
+            utils::FrameRateController::End();
+        }
+
+        /**
+         * @brief Declares the work of a frame, in sequential order, with the state each step reads
+         * and writes. The camera and the view transformation are computed on the workers while the
+         * main thread uploads textures and clears the frame buffer.
+         */
+        void BuildFrameGraph(void)
+        {
+            unsigned int input = frame_graph.AddResource("input");
+            unsigned int camera_state = frame_graph.AddResource("camera");
+            unsigned int transforms = frame_graph.AddResource("transforms");
+            unsigned int level = frame_graph.AddResource("scene");
+            unsigned int render_list = frame_graph.AddResource("render list");
+
+            frame_graph.AddTask("input", std::bind(&MyApplication::UpdateInput, this), {}, {input}, JOB_MAIN_THREAD);
+            frame_graph.AddTask("loading", std::bind(&MyApplication::UpdateLoading, this), {}, {level},
+                                JOB_MAIN_THREAD);
+            frame_graph.AddTask("clear", std::bind(&OGLRenderer::PreUpdate, renderer), {}, {render_list},
+                                JOB_MAIN_THREAD);
+            frame_graph.AddTask("camera", std::bind(&MyApplication::UpdateCamera, this), {input}, {camera_state});
+            frame_graph.AddTask("view", std::bind(&MyApplication::UpdateView, this), {camera_state}, {transforms});
+            frame_graph.AddTask("scene", std::bind(&MyApplication::DrawScene, this), {level, transforms},
+                                {render_list}, JOB_MAIN_THREAD);
+            frame_graph.AddTask("grid", std::bind(&MyApplication::DrawGrid, this), {transforms}, {render_list},
+                                JOB_MAIN_THREAD);
+            frame_graph.AddTask("present", std::bind(&MyApplication::Present, this), {}, {render_list},
+                                JOB_MAIN_THREAD);
+        }
+
+        void UpdateInput(void)
+        {
             utils::Keyboard::Update();
             utils::Mouse::Update();
 
@@ -69,62 +146,105 @@ namespace core {
             if (utils::Keyboard::IsTriggered(VK_ESCAPE))
                 PostQuitMessage(0);
 
-            renderer->PreUpdate();
+            // The cursor is sampled and put back here, on the main thread like every windowing
+            // call, the camera task only reads the delta.
+            int mx, my;
+            utils::Mouse::GetPosition(mx, my);
+            mousex = mx;
+            mousey = my;
+            if (oldmousex == -1)
+                oldmousex = mx;
+            if (oldmousey == -1)
+                oldmousey = my;
+            dx = mousex - oldmousex;
+            dy = mousey - oldmousey;
+            utils::Mouse::SetPosition(oldmousex, oldmousey);
+        }
 
-            // Set the camera transformation.
-            UpdateCamera();
+        /// Sets the camera transformation.
+        void UpdateView(void)
+        {
             pipeline->SetMatrixMode(core::Pipeline::MODELVIEW);
             pipeline->LoadIdentity();
             pipeline->PostMultiply(camera->GetViewTransformation());
+        }
+
+        /**
+         * @brief Sets the model transformation and renders it, nothing is drawn while loading.
+         * @remarks The matrix pushed is popped before returning, the view transformation is left
+         * as it was for the following tasks.
+         */
+        void DrawScene(void)
+        {
+            if (!scene)
+                return;
 
-            // Set the model transformation and render it.
             pipeline->PushMatrix();
             pipeline->PreTranslate(0, 0, -300);
-            renderer->DrawModel(*scene);
+            renderer->DrawModel(*scene, *pipeline);
             pipeline->PopMatrixEmpty();
+        }
 
-            // Set the grid transformation and render it.
+        /// Sets the grid transformation and renders it.
+        void DrawGrid(void)
+        {
             pipeline->PushMatrix();
             pipeline->PreTranslate(0, -100, 0);
-            renderer->DrawGrid();
+            renderer->DrawGrid(*pipeline);
             pipeline->PopMatrixEmpty();
+        }
 
+        void Present(void)
+        {
             renderer->PostUpdate(utils::FrameRateController::GetFrameRate());
+        }
 
-            utils::FrameRateController::End();
+        /// Uploads the textures of the level being loaded and takes the scene once it is ready.
+        void UpdateLoading(void)
+        {
+            loader->Update();
+            if (!scene_load)
+                return;
+
+            if (scene_load->IsReady()) {
+                scene = scene_load->GetFuture().get();
+                if (!scene)
+                    std::cout << "Error: " << scene_load->GetPath() << " failed to load." << std::endl;
+                scene_load->Release();
+                scene_load = NULL;
+                renderer->SetStatus(std::string());
+                return;
+            }
+
+            SceneLoadProgress progress = scene_load->GetProgress();
+            char status[100];
+            sprintf(status, "loading %i%% (%u/%u)", (int)(progress.GetRatio() * 100.f), progress.objects_loaded,
+                    progress.objects_total);
+            renderer->SetStatus(status);
         }
 
         void UpdateCamera(void)
         {
-            math::Matrix4D crossup, camerarotateY, camerarotatetemp, tmpmatrix;
-            float dx, dy, d, tempangle;
+            math::Matrix4D camerarotateY, camerarotatetemp;
+            float d, tempangle;
             float speed = 10.f;
             float length;
-            int mx, my;
-            math::Vector3D tmp, tmp2;
+            math::Vector3D tmp, tmp2, up;
 
             if (utils::Keyboard::IsPressed('C')) {
                 yanglelimit = 0;
                 camera->LookAt(math::Point3D(), math::Point3D(0, 0, -100), math::Vector3D(0, 1, 0));
             }
 
-            // Handling the camera controls, first orientation, second translation.
-            utils::Mouse::GetPosition(mx, my);
-            mousex = mx;
-            mousey = my;
-            if (oldmousex == -1)
-                oldmousex = mx;
-            if (oldmousey == -1)
-                oldmousey = my;
-            dx = (float)mousex - oldmousex;
-            dy = (float)mousey - oldmousey;
-            utils::Mouse::SetPosition(oldmousex, oldmousey);
+            // Handling the camera controls, first orientation, second translation. The mouse delta
+            // comes from 'UpdateInput'.
+            float mouse_dx = (float)dx, mouse_dy = (float)dy;
 
             // Crossing the camera up vector with the opposite of the look at direction.
-            crossup = math::Matrix4D::CrossProduct(camera->upvector);
-            tmp = -camera->lookatdirection;
+            up = camera->upvector;
+            up.Normalize();
             // 'tmp' is now orthogonal to the up and lookat vector.
-            tmp = crossup * tmp;
+            tmp = up.CrossProduct(-camera->lookatdirection);
 
             // Orthogonalizing the camera up and direction vector (to avoid floating point
             // imprecision). Discard the y and the w components (preserver x and z, making it
@@ -132,20 +252,20 @@ namespace core {
             tmp.y = tmp.w = 0;
             length = sqrtf(tmp.x * tmp.x + tmp.z * tmp.z);
             if (length != 0) {
-                // Normalizes tmp and return cross product matrix.
-                crossup = math::Matrix4D::CrossProduct(tmp);
-                tmp2 = camera->upvector;
+                // Normalizes tmp and crosses it with the up vector.
+                tmp2 = tmp;
+                tmp2.Normalize();
                 // 'tmp2' is now the oppposite of the direction vector.
-                tmp2 = crossup * tmp2;
+                tmp2 = tmp2.CrossProduct(camera->upvector);
                 camera->lookatdirection = -tmp2;
             }
 
             // Create a rotation matrix on the y relative the movement of the mouse on x.
-            camerarotateY = math::Matrix4D::RotationY(-dx / 1000.f);
+            camerarotateY = math::Matrix4D::RotationY(-mouse_dx / 1000.f);
             // Limit yanglelimit to a certain range (to control x range of movement).
             tempangle = yanglelimit;
-            tempangle -= dy / 1000;
-            d = -dy / 1000;
+            tempangle -= mouse_dy / 1000;
+            d = -mouse_dy / 1000;
             if (tempangle > 0.925f)
                 d = 0.925f - yanglelimit;
             else if (tempangle < -0.925f)
@@ -155,9 +275,9 @@ namespace core {
             camerarotatetemp = math::Matrix4D::AxisAngle(tmp, d / PI * 180);
             // Switching the rotations here makes no difference, why???, it seems geometrically the
             // result is the same. Just simulate it using your thumb and index.
-            tmpmatrix = camerarotateY * camerarotatetemp;
-            camera->lookatdirection = tmpmatrix * camera->lookatdirection;
-            camera->upvector = tmpmatrix * camera->upvector;
+            // Both rotations are applied to the vectors in turn, the product is never formed.
+            camera->lookatdirection = math::Chain(camerarotateY) * camerarotatetemp * camera->lookatdirection;
+            camera->upvector = math::Chain(camerarotateY) * camerarotatetemp * camera->upvector;
 
             // Handling translations.
             if (utils::Keyboard::IsPressed('A')) {
@@ -200,20 +320,32 @@ namespace core {
         virtual void Cleanup()
         {
             utils::FrameRateController::Cleanup();
+
+            // A level still loading is canceled, the loader waits for its jobs.
+            if (scene_load)
+                scene_load->Cancel();
+            delete loader;
+            if (scene_load)
+                scene_load->Release();
+            JobSystem::Cleanup();
+
             renderer->Cleanup();
             delete renderer;
+            delete archive;
             delete scene;
-            delete serializer;
             delete pipeline;
             delete camera;
         }
 
     private:
          Model *scene;
+         SceneLoad *scene_load;
+         SceneLoader *loader;
          OGLRenderer *renderer;
-         ASESerializer *serializer;
+         PakArchive *archive;
          Pipeline *pipeline;
          Camera *camera;
+         FrameGraph frame_graph;
          bool firsttime;
          int x, y, dx, dy, mousex, mousey, oldmousex, oldmousey;
          float yanglelimit;
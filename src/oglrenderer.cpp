@@ -1,9 +1,7 @@
 #include <windows.h>
-#include <gdiplus.h>
 #include "oglrenderer.h"
 #include <GL/gl.h>
 #include <GL/glu.h>
-#include <shlwapi.h>
 
 extern HWND hWnd;
 extern HINSTANCE hInst;
@@ -66,15 +64,11 @@ void core::OGLRenderer::UpdateViewportProperties(const core::Pipeline *pipeline)
 
 void core::OGLRenderer::UpdateProjectionProperties(const core::Pipeline *pipeline)
 {
-    float left, right, bottom, top, _near, _far;
-    pipeline->GetFrustumInfo(left, right, bottom, top, _near, _far);
-
+    // The pipeline holds the same matrix glFrustum or glOrtho would build.
+    float m[16];
+    pipeline->GetProjection().ToArrayColumnMajor(m);
     glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	if (pipeline->GetProjectionType() == core::Pipeline::PERSPECTIVE)
-        glFrustum(left, right, bottom, top, _near, _far);
-    else
-        glOrtho(left, right, bottom, top, _near, _far);
+    glLoadMatrixf(m);
 }
 
 void core::OGLRenderer::PreUpdate()
@@ -88,7 +82,7 @@ void core::OGLRenderer::PostUpdate(int frametime)
     SwapBuffers(hWindowDC);
 
     static char array[100] = {0};
-    sprintf(array, "C++ Project: %ifps", frametime);
+    sprintf(array, "C++ Project: %ifps %.60s", frametime, status.c_str());
 	SetWindowText(hWnd, array);
 }
 
@@ -106,89 +100,8 @@ void core::OGLRenderer::Cleanup(void)
     ReleaseDC(hWnd, hWindowDC);
 }
 
-/**
- * @brief Given a GDI plus bitmap class, it returns the content as an RGBA buffer.
- * @param bitmap The bitmap to get the data for.
- * @param [out] width Will be filled with the width of the bitmap.
- * @param [out] height Will be filled with the height of the bitmap.
- * @todo Replace GDI plus code with native C libraries.
- * @return NULL in case of failure, or a void pointer to an RGBA buffer (each component is an
- * unsigned char).
- */
-static unsigned char *GetBitmapBuffer(Gdiplus::Bitmap &bitmap, int &width, int &height)
-{
-	width = bitmap.GetWidth();
-	height = bitmap.GetHeight();
-	Gdiplus::Rect *rect = new Gdiplus::Rect(0, 0, width, height);
-	Gdiplus::BitmapData *bitmapdata = new Gdiplus::BitmapData;
-
-	if (bitmap.LockBits(rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, bitmapdata) == 0) {
-        // Buffer that has the image data.
-        unsigned char *src = (unsigned char *)bitmapdata->Scan0;
-		int stride = bitmapdata->Stride;
-		// Buffer that will contain the copied image data.
-        unsigned char *dst = new unsigned char[width * height * 4];
-
-		// Copying the data to the destination buffer.
-		for (int j = 0; j < height; ++j) {
-			for (int i = 0; i < width; ++i) {
-				dst[(height - 1 - j) * (width * 4) + (i * 4) + 0] = src[j * stride + i * 4 + 2];
-				dst[(height - 1 - j) * (width * 4) + (i * 4) + 1] = src[j * stride + i * 4 + 1];
-				dst[(height - 1 - j) * (width * 4) + (i * 4) + 2] = src[j * stride + i * 4 + 0];
-				dst[(height - 1 - j) * (width * 4) + (i * 4) + 3] = src[j * stride + i * 4 + 3];
-			}
-		}
-
-		bitmap.UnlockBits(bitmapdata);
-
-		// Return the point to the buffer.
-		return dst;
-	}
-
-	return NULL;
-}
-
-bool core::OGLRenderer::LoadTextureMap(std::string path)
+void core::OGLRenderer::UploadTextureMap(const std::string &path, const unsigned char *buffer, int width, int height)
 {
-    std::string original_path = path;
-	std::basic_string<char>::size_type index = 0;
-
-	// If the file doesn't exist, we check in the default textures directory.
-	if (!PathFileExists(path.c_str())) {
-		std::string filename;
-		std::string fullpath;
-		std::basic_string<char>::size_type indicator = path.find_last_of("\\", path.size()) + 1;
-		filename = path.substr(indicator, path.size() - indicator);
-		char directory[1000];
-		GetCurrentDirectory(1000, directory);
-		fullpath = directory;
-		fullpath += "\\assets\\textures\\textures\\";
-		fullpath += filename;
-
-		// If the file still cannot be found return false.,
-		if (!PathFileExists(fullpath.c_str()))
-			return false;
-
-		// Update path to point to the texture path.
-		path = fullpath;
-	}
-
-	// Check if it already exists.
-	std::map<std::string, unsigned int>::iterator iter = textures.find(path);
-	if (iter != textures.end())
-        return true;
-
-    // GDI plus works with Unicode/multi-byte strings.
-	WCHAR widepathbuffer[1000];
-	MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, widepathbuffer, 1000);
-	Gdiplus::Bitmap bitmap(widepathbuffer);
-
-	// Get the texture color data, in case of failure return false.
-	int width = 0, height = 0;
-	unsigned char *buffer = GetBitmapBuffer(bitmap, width, height);
-	if (!buffer)
-        return false;
-
     // Upload the texture, generate mipmaps and set wrapping modes.
 	unsigned int n = 0;
 	glGenTextures(1, &n);
@@ -201,9 +114,21 @@ bool core::OGLRenderer::LoadTextureMap(std::string path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-    delete [] buffer;
-	textures[original_path] = n;
+	textures[path] = n;
+}
 
+bool core::OGLRenderer::LoadTextureMap(std::string path)
+{
+	// Check if it already exists.
+	if (textures.find(path) != textures.end())
+        return true;
+
+    // Packed textures are served from the archive, without any file system access.
+    TextureImage image;
+    if (!TextureCodec::Load(path, archive, image))
+        return false;
+
+    UploadTextureMap(path, image.GetPixels(), image.width, image.height);
 	return true;
 }
 
@@ -213,25 +138,36 @@ void core::OGLRenderer::LoadTextureMaps(std::vector<std::string> paths)
         LoadTextureMap(paths[i]);
 }
 
-void core::OGLRenderer::DrawGrid(void) const
+void core::OGLRenderer::UploadTextureMaps(const TextureImage *images, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i) {
+        if (images[i].GetPixels() && textures.find(images[i].path) == textures.end())
+            UploadTextureMap(images[i].path, images[i].GetPixels(), images[i].width, images[i].height);
+    }
+}
+
+void core::OGLRenderer::PushPipelineTransform(const Pipeline &pipeline) const
+{
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+
+    float m[16];
+    pipeline.GetModelView().ToArrayColumnMajor(m);
+    glLoadMatrixf(m);
+}
+
+void core::OGLRenderer::PopPipelineTransform(void) const
+{
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+void core::OGLRenderer::DrawGrid(const Pipeline &pipeline) const
 {
     const float area = 5000;
     const int amount = 100;
 
-    core::Pipeline *current_pipeline = core::Pipeline::GetCurrentPipeline();
-    // Push the current pipeline transformation.
-    if (current_pipeline) {
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glLoadIdentity();
-
-        current_pipeline->SetMatrixMode(core::Pipeline::MODELVIEW);
-        math::Matrix4D output;
-        current_pipeline->GetMatrix(output);
-        float m[16];
-        output.ToArrayColumnMajor(m);
-        glMultMatrixf(m);
-    }
+    PushPipelineTransform(pipeline);
 
     glDisable(GL_LIGHTING);
     glColor4f(0, 0, 0, 1);
@@ -248,42 +184,39 @@ void core::OGLRenderer::DrawGrid(void) const
     glEnd();
     glEnable(GL_LIGHTING);
 
-    // Pop it.
-    if (current_pipeline)
-        glPopMatrix();
+    PopPipelineTransform();
 }
 
-void core::OGLRenderer::DrawModel(const Model &model) const
+void core::OGLRenderer::DrawModel(const Model &model, Pipeline &pipeline) const
 {
-    core::Pipeline *current_pipeline = core::Pipeline::GetCurrentPipeline();
-    // Push the current pipeline transformation.
-    if (current_pipeline) {
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glLoadIdentity();
-
-        current_pipeline->SetMatrixMode(core::Pipeline::MODELVIEW);
-        math::Matrix4D output;
-        current_pipeline->GetMatrix(output);
-        float m[16];
-        output.ToArrayColumnMajor(m);
-        glMultMatrixf(m);
-    }
-
-    // Renderer all the meshes attached to the model first.
-	for (unsigned int i = 0; i < model.meshes.size(); ++i)
-		DrawMesh(*model.meshes[i]);
+    model_draws.Clear();
+    model_draws.Record(model, pipeline);
+    DrawCommands(model_draws);
+}
 
-    // Go through its child models and render those.
-    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
-        DrawModel(*model.sub_models[i]);
+void core::OGLRenderer::DrawCommands(const DrawList &list) const
+{
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+
+    // Meshes outside the view were not recorded, those drawn are made resident as they come.
+    for (unsigned int i = 0; i < list.GetCount(); ++i) {
+        const Mesh &mesh = list.GetMesh(i);
+        if (!mesh.EnsureResident())
+            continue;
+
+        glLoadMatrixf(list.GetModelView(i));
+        BindMesh(mesh);
+        const DrawRange *ranges = list.GetRanges(i);
+        for (unsigned int r = 0; r < list.GetRangeCount(i); ++r)
+            glDrawElements(GL_TRIANGLES, ranges[r].index_count, GL_UNSIGNED_SHORT, mesh.index_array + ranges[r].first_index);
+        UnbindMesh(mesh);
+    }
 
-    // Pop it.
-    if (current_pipeline)
-        glPopMatrix();
+    glPopMatrix();
 }
 
-void core::OGLRenderer::DrawMesh(const Mesh &mesh) const
+void core::OGLRenderer::BindMesh(const Mesh &mesh) const
 {
     core::Color white;
     white.r = white.g = white.b = white.a = 1.f;
@@ -299,11 +232,13 @@ void core::OGLRenderer::DrawMesh(const Mesh &mesh) const
         float shine = mesh.materials[0].shininess * 128;
         glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, &shine);
 
-        // Texturing.
+        // Texturing, textures that failed to load were never uploaded: drawn untextured.
         if (mesh.materials[0].textures.size() && mesh.materials[0].textures[0].name != "") {
-            glEnable(GL_TEXTURE_2D);
-            unsigned int id = textures.find(mesh.materials[0].textures[0].path)->second;
-            glBindTexture(GL_TEXTURE_2D, id);
+            std::map<std::string, unsigned int>::const_iterator texture = textures.find(mesh.materials[0].textures[0].path);
+            if (texture != textures.end()) {
+                glEnable(GL_TEXTURE_2D);
+                glBindTexture(GL_TEXTURE_2D, texture->second);
+            }
         }
     } else {
         glColorMaterial(GL_FRONT, GL_AMBIENT);
@@ -317,7 +252,61 @@ void core::OGLRenderer::DrawMesh(const Mesh &mesh) const
     glVertexPointer(4, GL_FLOAT, 0, mesh.vertices);
     glTexCoordPointer(3, GL_FLOAT, 0, mesh.uv_coordinates[0]);
     glNormalPointer(GL_FLOAT, 0, mesh.normals);
-    glDrawElements(GL_TRIANGLES, mesh.index_array_size, GL_UNSIGNED_SHORT, mesh.index_array);
+}
 
+void core::OGLRenderer::UnbindMesh(const Mesh &mesh) const
+{
     glDisable(GL_TEXTURE_2D);
 }
+
+void core::OGLRenderer::DrawMesh(const Mesh &mesh) const
+{
+    if (!mesh.EnsureResident())
+        return;
+
+    BindMesh(mesh);
+    glDrawElements(GL_TRIANGLES, mesh.index_array_size, GL_UNSIGNED_SHORT, mesh.index_array);
+    UnbindMesh(mesh);
+}
+
+void core::OGLRenderer::DrawInstances(const Mesh &mesh, const float *matrices, unsigned int count,
+                                      const Pipeline &pipeline) const
+{
+    if (!count || !mesh.EnsureResident())
+        return;
+
+    PushPipelineTransform(pipeline);
+    BindMesh(mesh);
+
+    // Only the instance transformation changes between draws, the base comes from the pipeline
+    // rather than being read back from OpenGL.
+    float base[16];
+    pipeline.GetModelView().ToArrayColumnMajor(base);
+    for (unsigned int i = 0; i < count; ++i) {
+        glLoadMatrixf(base);
+        glMultMatrixf(matrices + i * 16);
+        glDrawElements(GL_TRIANGLES, mesh.index_array_size, GL_UNSIGNED_SHORT, mesh.index_array);
+    }
+
+    UnbindMesh(mesh);
+    PopPipelineTransform();
+}
+
+void core::OGLRenderer::DrawMeshInstanced(const Mesh &mesh, const InstanceBuffer &instances, const Pipeline &pipeline) const
+{
+    DrawInstances(mesh, instances.GetData(), instances.GetCount(), pipeline);
+}
+
+void core::OGLRenderer::DrawMeshInstanced(const Mesh &mesh, const math::Matrix4D *transforms, unsigned int count,
+                                          const Pipeline &pipeline) const
+{
+    // Convert in small batches on the stack, no allocation per call.
+    const unsigned int batch_size = 64;
+    float matrices[batch_size * 16];
+    for (unsigned int first = 0; first < count; first += batch_size) {
+        unsigned int batch_count = (count - first < batch_size)? count - first: batch_size;
+        for (unsigned int i = 0; i < batch_count; ++i)
+            transforms[first + i].ToArrayColumnMajor(matrices + i * 16);
+        DrawInstances(mesh, matrices, batch_count, pipeline);
+    }
+}
@@ -7,6 +7,8 @@
 
 #include <map>
 #include "renderer.h"
+#include "pak_archive.h"
+#include "texture_codec.h"
 
 namespace core {
 
@@ -16,7 +18,7 @@ namespace core {
     class OGLRenderer: public Renderer
     {
     public:
-        OGLRenderer() {}
+        OGLRenderer(): archive(NULL) {}
         virtual ~OGLRenderer() {}
 
         /// Initializes the renderer.
@@ -30,8 +32,20 @@ namespace core {
          */
         virtual void LoadTextureMaps(std::vector<std::string> paths);
 
-        /// Draw a 'Model'.
-        virtual void DrawModel(const Model &model) const;
+        /**
+         * @brief Uploads @a count textures decoded ahead of time (see 'TextureCodec::Load'), those
+         * already loaded under the same path or that failed to decode are skipped.
+         */
+        virtual void UploadTextureMaps(const TextureImage *images, unsigned int count);
+
+        /**
+         * @brief Draw a 'Model' placed by the modelview of @a pipeline.
+         * @remarks Recorded into a draw list first, see 'DrawList::Record'.
+         */
+        virtual void DrawModel(const Model &model, Pipeline &pipeline) const;
+
+        /// Draws the index ranges recorded in @a list, each mesh with its own modelview loaded.
+        virtual void DrawCommands(const DrawList &list) const;
 
         /**
          * @brief Draws a mesh.
@@ -40,21 +54,59 @@ namespace core {
          */
         virtual void DrawMesh(const Mesh &mesh) const;
 
+        /**
+         * @brief Draws a mesh at each of the given transformations.
+         * @remarks Fixed function OpenGL has no instancing, the material, textures and arrays are
+         * bound once and each instance only costs a matrix load and a 'glDrawElements'.
+         */
+        virtual void DrawMeshInstanced(const Mesh &mesh, const math::Matrix4D *transforms, unsigned int count,
+                                       const Pipeline &pipeline) const;
+        /// Draws a mesh at each of the instances of @a instances, see above.
+        virtual void DrawMeshInstanced(const Mesh &mesh, const InstanceBuffer &instances, const Pipeline &pipeline) const;
+
         /// Called before rendering starts.
         virtual void PreUpdate();
         /// Called after rendering has finished.
         virtual void PostUpdate(int frametime);
 
-        /// Sets the viewport properties based on the data in the current pipeline.
+        /// Sets the viewport properties based on the data in @a pipeline.
         virtual void UpdateViewportProperties(const Pipeline *pipeline);
 
-        /// Sets the projection frustum and type based on the data in the current pipeline.
+        /// Sets the projection frustum and type based on the data in @a pipeline.
         virtual void UpdateProjectionProperties(const Pipeline *pipeline);
 
-        /// Draws a 3D grid to help with navigation.
-        void DrawGrid(void) const;
+        /// Draws a 3D grid to help with navigation, placed by the modelview of @a pipeline.
+        void DrawGrid(const Pipeline &pipeline) const;
+
+        /**
+         * @brief Makes the textures be looked up in @a _archive first (NULL to only use the file
+         * system). The archive must outlive the renderer.
+         */
+        void SetArchive(const PakArchive *_archive)
+        {
+            archive = _archive;
+        }
+
+        /// Sets a status line shown after the frame rate in the window title (loading progress...).
+        void SetStatus(const std::string &_status)
+        {
+            status = _status;
+        }
 
     private:
+        /// Pushes the modelview matrix and loads the modelview of @a pipeline in it.
+        void PushPipelineTransform(const Pipeline &pipeline) const;
+        /// Restores the modelview matrix saved by 'PushPipelineTransform'.
+        void PopPipelineTransform(void) const;
+
+        /// Sets the material, texture and vertex arrays of @a mesh.
+        void BindMesh(const Mesh &mesh) const;
+        /// Resets the state changed by 'BindMesh'.
+        void UnbindMesh(const Mesh &mesh) const;
+
+        /// Draws the instances of a mesh, @a matrices holds 16 column major floats per instance.
+        void DrawInstances(const Mesh &mesh, const float *matrices, unsigned int count, const Pipeline &pipeline) const;
+
         /**
          * @brief Loads a texture map given the file path into VRAM.
          * @param path The path to the image file.
@@ -64,9 +116,21 @@ namespace core {
          */
         virtual bool LoadTextureMap(std::string path);
 
+        /// Uploads the image of @a buffer (RGBA, bottom up) and registers it as @a path.
+        void UploadTextureMap(const std::string &path, const unsigned char *buffer, int width, int height);
+
     private:
         /// Holds the textures id list.
         std::map<std::string, unsigned int> textures;
+
+        /// Archive searched for the textures before the file system, can be NULL.
+        const PakArchive *archive;
+
+        /// Shown in the window title, see 'SetStatus'.
+        std::string status;
+
+        /// Refilled by every 'DrawModel', kept to reuse its memory.
+        mutable DrawList model_draws;
     };
 }
 
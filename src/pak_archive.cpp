@@ -0,0 +1,240 @@
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include "pak_archive.h"
+
+/// Marks an empty bucket of the hash table.
+#define PAK_EMPTY_BUCKET 0xFFFFFFFFu
+
+struct PakHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    /// Power of 2, at least twice the entry count.
+    uint32_t bucket_count;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t file_size;
+};
+
+struct PakEntry
+{
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t size;
+    /// Offset of the normalized path in the string table.
+    uint32_t path;
+    uint32_t reserved;
+};
+
+std::string core::PakArchive::NormalizePath(const std::string &path)
+{
+    std::string normalized;
+    normalized.reserve(path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        char c = path[i];
+        normalized.push_back((c == '\\')? '/': (char)tolower((unsigned char)c));
+    }
+
+    size_t start = 0;
+    while (start < normalized.size()) {
+        if (normalized[start] == '/')
+            ++start;
+        else if (normalized.compare(start, 2, "./") == 0)
+            start += 2;
+        else
+            break;
+    }
+
+    return normalized.substr(start);
+}
+
+unsigned long long core::PakArchive::Hash(const char *data, size_t size)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+core::PakArchive *core::PakArchive::Open(const std::string &file_path)
+{
+    MappedFile *file = MappedFile::Open(file_path);
+    if (!file)
+        return NULL;
+
+    PakArchive *archive = new PakArchive(file);
+    if (!archive->Validate()) {
+        delete archive;
+        return NULL;
+    }
+
+    return archive;
+}
+
+bool core::PakArchive::Validate(void)
+{
+    size_t size = file->GetSize();
+    if (size < sizeof(PakHeader))
+        return false;
+
+    const PakHeader *header = (const PakHeader *)file->GetData();
+    if (header->magic != PAK_ARCHIVE_MAGIC || header->version != PAK_ARCHIVE_VERSION || header->file_size != size)
+        return false;
+
+    // The bucket count is a power of 2 larger than the entry count, so probing always ends.
+    if (!header->bucket_count || (header->bucket_count & (header->bucket_count - 1)) || header->bucket_count <= header->entry_count)
+        return false;
+
+    uint64_t tables_size = sizeof(PakHeader) + (uint64_t)header->entry_count * sizeof(PakEntry) +
+                           (uint64_t)header->bucket_count * sizeof(uint32_t);
+    if (tables_size > size || header->strings_offset < tables_size || header->strings_offset > size ||
+        header->strings_size > size - header->strings_offset || !header->strings_size)
+        return false;
+
+    entries = file->GetData() + sizeof(PakHeader);
+    buckets = (const unsigned int *)(file->GetData() + sizeof(PakHeader) + header->entry_count * sizeof(PakEntry));
+    strings = file->GetData() + header->strings_offset;
+    strings_size = (size_t)header->strings_size;
+    entry_count = header->entry_count;
+    bucket_mask = header->bucket_count - 1;
+    if (strings[strings_size - 1] != '\0')
+        return false;
+
+    const PakEntry *table = (const PakEntry *)entries;
+    for (unsigned int i = 0; i < entry_count; ++i) {
+        if (table[i].offset > size || table[i].size > size - table[i].offset || table[i].path >= strings_size)
+            return false;
+    }
+    for (unsigned int i = 0; i <= bucket_mask; ++i) {
+        if (buckets[i] != PAK_EMPTY_BUCKET && buckets[i] >= entry_count)
+            return false;
+    }
+
+    return true;
+}
+
+bool core::PakArchive::Find(const std::string &path, const char *&data, size_t &size) const
+{
+    std::string normalized = NormalizePath(path);
+    unsigned long long hash = Hash(normalized.c_str(), normalized.size());
+
+    const PakEntry *table = (const PakEntry *)entries;
+    for (unsigned int i = (unsigned int)hash & bucket_mask, probes = 0; probes <= bucket_mask; i = (i + 1) & bucket_mask, ++probes) {
+        unsigned int index = buckets[i];
+        if (index == PAK_EMPTY_BUCKET)
+            return false;
+
+        const PakEntry &entry = table[index];
+        if (entry.hash == hash && normalized == strings + entry.path) {
+            data = file->GetData() + entry.offset;
+            size = (size_t)entry.size;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// Reads a whole file, returns false if it cannot be opened.
+static bool ReadFileContent(const std::string &file_path, std::vector<char> &content)
+{
+    std::ifstream file(file_path.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!file.is_open())
+        return false;
+
+    file.seekg(0, std::ios_base::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios_base::beg);
+    content.resize((size_t)size);
+    if (size)
+        file.read(&content[0], size);
+    return file.good() || file.eof();
+}
+
+/// Writes zeros until @a offset is a multiple of @a alignment.
+static void Pad(std::ofstream &file, uint64_t &offset, uint64_t alignment)
+{
+    static const char zeros[PAK_ARCHIVE_ALIGNMENT] = {};
+    uint64_t padding = (alignment - offset % alignment) % alignment;
+    file.write(zeros, (std::streamsize)padding);
+    offset += padding;
+}
+
+bool core::PakArchive::Write(const std::string &file_path, const std::vector<PakSource> &sources)
+{
+    std::vector<PakEntry> table(sources.size());
+    std::vector<char> string_table;
+    std::set<std::string> paths;
+    for (unsigned int i = 0; i < sources.size(); ++i) {
+        std::string normalized = NormalizePath(sources[i].path);
+        if (!paths.insert(normalized).second)
+            return false;
+
+        table[i].hash = Hash(normalized.c_str(), normalized.size());
+        table[i].path = (uint32_t)string_table.size();
+        table[i].reserved = 0;
+        string_table.insert(string_table.end(), normalized.begin(), normalized.end());
+        string_table.push_back('\0');
+    }
+    if (string_table.empty())
+        string_table.push_back('\0');
+
+    uint32_t bucket_count = 2;
+    while (bucket_count < sources.size() * 2)
+        bucket_count *= 2;
+    std::vector<uint32_t> buckets(bucket_count, PAK_EMPTY_BUCKET);
+    for (unsigned int i = 0; i < table.size(); ++i) {
+        uint32_t b = (uint32_t)table[i].hash & (bucket_count - 1);
+        while (buckets[b] != PAK_EMPTY_BUCKET)
+            b = (b + 1) & (bucket_count - 1);
+        buckets[b] = i;
+    }
+
+    PakHeader header;
+    header.magic = PAK_ARCHIVE_MAGIC;
+    header.version = PAK_ARCHIVE_VERSION;
+    header.entry_count = (uint32_t)table.size();
+    header.bucket_count = bucket_count;
+    header.strings_offset = sizeof(PakHeader) + table.size() * sizeof(PakEntry) + buckets.size() * sizeof(uint32_t);
+    header.strings_size = string_table.size();
+    header.file_size = 0;
+
+    // The entries are written one at a time, their offsets and the file size are patched at the end.
+    std::ofstream file(file_path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!file.is_open())
+        return false;
+
+    file.write((const char *)&header, sizeof(header));
+    if (!table.empty())
+        file.write((const char *)&table[0], table.size() * sizeof(PakEntry));
+    file.write((const char *)&buckets[0], buckets.size() * sizeof(uint32_t));
+    file.write(&string_table[0], string_table.size());
+
+    uint64_t offset = header.strings_offset + header.strings_size;
+    std::vector<char> content;
+    for (unsigned int i = 0; i < sources.size(); ++i) {
+        if (!ReadFileContent(sources[i].file_path, content))
+            return false;
+
+        Pad(file, offset, PAK_ARCHIVE_ALIGNMENT);
+        table[i].offset = offset;
+        table[i].size = content.size();
+        if (!content.empty())
+            file.write(&content[0], content.size());
+        offset += content.size();
+    }
+
+    header.file_size = offset;
+    file.seekp(0, std::ios_base::beg);
+    file.write((const char *)&header, sizeof(header));
+    if (!table.empty())
+        file.write((const char *)&table[0], table.size() * sizeof(PakEntry));
+    return file.good();
+}
@@ -0,0 +1,129 @@
+/**
+ * @file pak_archive.h
+ * @brief Single file asset archive.
+ */
+#ifndef PAK_ARCHIVE_H_INCLUDED
+#define PAK_ARCHIVE_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+/// Identifies an archive ('PPAK' read as a little endian integer).
+#define PAK_ARCHIVE_MAGIC 0x4B415050u
+/// Bumped whenever the layout of the archive changes, older archives are rejected.
+#define PAK_ARCHIVE_VERSION 1
+/// Alignment of the entries data in the archive (a page).
+#define PAK_ARCHIVE_ALIGNMENT 4096
+
+namespace core {
+
+    /// A file to store in an archive.
+    class PakSource
+    {
+    public:
+        PakSource() {}
+        PakSource(const std::string &_path, const std::string &_file_path): path(_path), file_path(_file_path) {}
+
+    public:
+        /// The path the asset is looked up with (see 'PakArchive::NormalizePath').
+        std::string path;
+        /// The file holding the asset data.
+        std::string file_path;
+    };
+
+    /**
+     * @brief Read only archive packing assets (meshes, textures, metadata) in one file, mapped in
+     * memory as a whole so that serving an asset costs no file system access.
+     * @remarks Layout: a header, the entries table, a hash table of the entries (open addressing
+     * on the 64 bits FNV-1a hash of the normalized path, linear probing), the string table of the
+     * paths, then the data of each entry starting on a page boundary.
+     * @remarks Lookups are O(1): one hash, usually one probe and one string comparison.
+     */
+    class PakArchive
+    {
+    public:
+        /**
+         * @brief Maps the archive at @a file_path.
+         * @return The archive, or NULL if the file is missing or is not a valid archive.
+         */
+        static PakArchive *Open(const std::string &file_path);
+
+        ~PakArchive()
+        {
+            file->Release();
+        }
+
+        /**
+         * @brief Looks up an asset.
+         * @param path The path of the asset, normalized before the lookup.
+         * @param [out] data The start of the asset data, in the mapping.
+         * @param [out] size The size of the asset in bytes.
+         * @return False if the archive does not hold @a path.
+         */
+        bool Find(const std::string &path, const char *&data, size_t &size) const;
+
+        /// Whether the archive holds @a path.
+        bool Contains(const std::string &path) const
+        {
+            const char *data;
+            size_t size;
+            return Find(path, data, size);
+        }
+
+        /// Returns the number of assets in the archive.
+        unsigned int GetEntryCount(void) const
+        {
+            return entry_count;
+        }
+
+        /// Returns the mapping, buffers pointing into the archive can hold a reference on it.
+        MappedFile *GetFile(void) const
+        {
+            return file;
+        }
+
+        /**
+         * @brief Writes an archive holding @a sources.
+         * @param file_path The archive to write.
+         * @param sources The assets, paths must be unique once normalized.
+         * @return False if a source cannot be read, a path is duplicated or the archive cannot be
+         * written.
+         */
+        static bool Write(const std::string &file_path, const std::vector<PakSource> &sources);
+
+        /**
+         * @brief Returns the form paths are stored and looked up in: lower case, forward slashes,
+         * no leading "./" or slash. "Assets\Textures\a.png" and "assets/textures/A.PNG" are the
+         * same asset.
+         */
+        static std::string NormalizePath(const std::string &path);
+
+        /// 64 bits FNV-1a hash of @a size bytes.
+        static unsigned long long Hash(const char *data, size_t size);
+
+    private:
+        PakArchive(MappedFile *_file): file(_file), entries(NULL), buckets(NULL), strings(NULL), entry_count(0),
+                                       bucket_mask(0), strings_size(0) {}
+
+        // Not copyable, the archive owns its mapping reference.
+        PakArchive(const PakArchive &);
+        PakArchive &operator =(const PakArchive &);
+
+        /// Checks the header and tables, sets the table pointers.
+        bool Validate(void);
+
+    private:
+        MappedFile *file;
+        /// The tables in the mapping, see the cpp for their records.
+        const void *entries;
+        const unsigned int *buckets;
+        const char *strings;
+        unsigned int entry_count;
+        unsigned int bucket_mask;
+        size_t strings_size;
+    };
+}
+
+#endif // PAK_ARCHIVE_H_INCLUDED
@@ -1,3 +0,0 @@
-#include "pipeline.h"
-
-core::Pipeline *core::Pipeline::instance;
@@ -8,16 +8,36 @@
 #include <cstdio>
 #include <assert.h>
 #include "matrix.h"
+#include "bbox.h"
 
 #define MODELVIEWSTACKSIZE 256
 #define PROJECTIONSTACKSIZE 10
 
 namespace core {
 
+    /// How many times the values derived from the stacks were recomputed, see 'Pipeline::GetCounters'.
+    class PipelineCounters
+    {
+    public:
+        PipelineCounters(): modelview_projection(0), inverse_modelview(0), frustum_planes(0) {}
+
+    public:
+        unsigned int modelview_projection;
+        /// The normal matrix is computed along with the inverse.
+        unsigned int inverse_modelview;
+        unsigned int frustum_planes;
+    };
+
     /**
      * @brief Holds transformation stack, this insulates the client code from dealing with a
      * specific graphics API code.
-     * @remarks Singleton class.
+     * @remarks Pipelines share no state, each view or recording thread owns its own and passes it
+     * to what draws (see 'Renderer', 'DrawList'). A pipeline is not thread safe, even the const
+     * getters below update its cache.
+     * @remarks What is derived from the stacks (model-view-projection, inverse and normal matrix,
+     * frustum planes) is cached per modelview level and only recomputed when read after the
+     * matrices it depends on changed. Pushing a level copies the cache of the one below, popping
+     * finds it as it was left.
      * @todo Add support for texture stack.
      */
     class Pipeline
@@ -33,15 +53,37 @@ namespace core {
             PERSPECTIVE
         };
 
-        Pipeline(): modelview_index(0), projection_index(0), stack_mode(MODELVIEW), projection_type(PERSPECTIVE)
-        {
-            instance = this;
-        }
+        enum FrustumPlane {
+            FRUSTUM_LEFT,
+            FRUSTUM_RIGHT,
+            FRUSTUM_BOTTOM,
+            FRUSTUM_TOP,
+            FRUSTUM_NEAR,
+            FRUSTUM_FAR,
+            FRUSTUM_PLANE_COUNT
+        };
 
-        virtual ~Pipeline()
+        Pipeline(): modelview_index(0), projection_index(0), stack_mode(MODELVIEW), projection_type(PERSPECTIVE) {}
+
+        virtual ~Pipeline() {}
+
+        /**
+         * @brief Starts over from the view of @a pipeline: its projection, viewport and the matrices
+         * at the top of its stacks, at the bottom of the stacks of this one. Meant for a recording
+         * thread to take the view it records from, without copying the whole stacks.
+         */
+        void LoadView(const Pipeline &pipeline)
         {
-            if (instance == this)
-                instance = NULL;
+            stack_mode = MODELVIEW;
+            projection_type = pipeline.projection_type;
+            pipeline.GetFrustumInfo(frustum_left, frustum_right, frustum_bottom, frustum_top, frustum_near, frustum_far);
+            pipeline.GetViewportInfo(viewport_x, viewport_y, viewport_width, viewport_height);
+
+            modelview_index = projection_index = 0;
+            modelview_stack[0] = pipeline.GetModelView();
+            projection_stack[0] = pipeline.GetProjection();
+            // Only the matrices are read, several threads can take the same view at once.
+            derived_stack[0].dirty = DERIVED_ALL;
         }
 
         /// Returns the current projection type.
@@ -83,8 +125,8 @@ namespace core {
         }
 
         /**
-         * @brief Specify the frustum dimensions, this is used by the graphics api to create the
-         * perspective projection matrix.
+         * @brief Specify the frustum dimensions and loads the perspective projection matrix at the
+         * top of the projection stack.
          * @param	right 	The right frustum clipping plane on the near plane.
          * @param	left  	The left frustum clipping plane on the near plane.
          * @param	bottom	The bottom frustum clipping plane on the near plane.
@@ -101,11 +143,13 @@ namespace core {
             frustum_top = top;
             frustum_near = _near;
             frustum_far = _far;
+            projection_stack[projection_index] = math::Matrix4D::Frustum(left, right, bottom, top, _near, _far);
+            InvalidateProjection();
         }
 
         /**
-         * @brief Specify the orthographic frustum dimensions, this is used by the graphics api to
-         * create the orthographic projection matrix.
+         * @brief Specify the orthographic frustum dimensions and loads the orthographic projection
+         * matrix at the top of the projection stack.
          * @param	right 	The right frustum clipping plane on the near plane.
          * @param	left  	The left frustum clipping plane on the near plane.
          * @param	bottom	The bottom frustum clipping plane on the near plane.
@@ -122,6 +166,8 @@ namespace core {
             frustum_top = top;
             frustum_near = _near;
             frustum_far = _far;
+            projection_stack[projection_index] = math::Matrix4D::Orthographic(left, right, bottom, top, _near, _far);
+            InvalidateProjection();
         }
 
         /// Returns the frustum data.
@@ -166,6 +212,7 @@ namespace core {
             if (stack_mode == MODELVIEW) {
                 assert(modelview_index + 1 < MODELVIEWSTACKSIZE);
                 modelview_stack[modelview_index + 1] = modelview_stack[modelview_index];
+                derived_stack[modelview_index + 1] = derived_stack[modelview_index];
                 ++modelview_index;
             } else {
                 assert(projection_index + 1 < PROJECTIONSTACKSIZE);
@@ -186,6 +233,7 @@ namespace core {
             } else {
                 assert(projection_index > 0);
                 output = projection_stack[projection_index--];
+                InvalidateProjection();
             }
         }
 
@@ -198,25 +246,20 @@ namespace core {
             } else {
                 assert(projection_index > 0);
                 --projection_index;
+                InvalidateProjection();
             }
         }
 
         /// @brief Loads the identity matrix at the top of the current stack.
         void LoadIdentity(void)
         {
-            if (stack_mode == MODELVIEW)
-                modelview_stack[modelview_index] = math::Matrix4D();
-            else
-                projection_stack[projection_index] = math::Matrix4D();
+            GetTop() = math::Matrix4D();
         }
 
         /// @brief Replaces the top matrix with the new matrix.
         void Replace(const math::Matrix4D &matrix)
         {
-            if (stack_mode == MODELVIEW)
-                modelview_stack[modelview_index] = matrix;
-            else
-                projection_stack[projection_index] = matrix;
+            GetTop() = matrix;
         }
 
         /**
@@ -227,10 +270,8 @@ namespace core {
          */
         void PostMultiply(const math::Matrix4D &matrix)
         {
-            if (stack_mode == MODELVIEW)
-                modelview_stack[modelview_index] = matrix * modelview_stack[modelview_index];
-            else
-                projection_stack[projection_index] = matrix * projection_stack[projection_index];
+            math::Matrix4D &top = GetTop();
+            top = matrix * top;
         }
 
         void PostRotateX(float angle)
@@ -248,9 +289,14 @@ namespace core {
             PostMultiply(math::Matrix4D::RotationZ(angle));
         }
 
+        /// Same as post multiplying a translation matrix, only the rows it changes are computed.
         void PostTranslate(float x, float y, float z)
         {
-            PostMultiply(math::Matrix4D::Translation(x, y, z));
+            math::Matrix4D &top = GetTop();
+            math::simd::float4 last_row = top.GetRow(3);
+            top.SetRow(0, math::simd::Add(top.GetRow(0), math::simd::Multiply(math::simd::Splat(x), last_row)));
+            top.SetRow(1, math::simd::Add(top.GetRow(1), math::simd::Multiply(math::simd::Splat(y), last_row)));
+            top.SetRow(2, math::simd::Add(top.GetRow(2), math::simd::Multiply(math::simd::Splat(z), last_row)));
         }
 
         /**
@@ -260,10 +306,8 @@ namespace core {
          */
         void PreMultiply(const math::Matrix4D &matrix)
         {
-            if (stack_mode == MODELVIEW)
-                modelview_stack[modelview_index] = modelview_stack[modelview_index] * matrix;
-            else
-                projection_stack[projection_index] = projection_stack[projection_index] * matrix;
+            math::Matrix4D &top = GetTop();
+            top = top * matrix;
         }
 
         void PreRotateX(float angle)
@@ -281,30 +325,182 @@ namespace core {
             PreMultiply(math::Matrix4D::RotationZ(angle));
         }
 
+        /// Same as pre multiplying a translation matrix, only the last column changes.
         void PreTranslate(float x, float y, float z)
         {
-            PreMultiply(math::Matrix4D::Translation(x, y, z));
+            math::Matrix4D &top = GetTop();
+            top.m03 = top.m00 * x + top.m01 * y + top.m02 * z + top.m03;
+            top.m13 = top.m10 * x + top.m11 * y + top.m12 * z + top.m13;
+            top.m23 = top.m20 * x + top.m21 * y + top.m22 * z + top.m23;
+            top.m33 = top.m30 * x + top.m31 * y + top.m32 * z + top.m33;
+        }
+
+        /// Returns the matrix at the top of the modelview stack.
+        const math::Matrix4D &GetModelView(void) const
+        {
+            return modelview_stack[modelview_index];
+        }
+
+        /// Returns the matrix at the top of the projection stack.
+        const math::Matrix4D &GetProjection(void) const
+        {
+            return projection_stack[projection_index];
+        }
+
+        /// Returns the projection times the modelview, computed once per change of either.
+        const math::Matrix4D &GetModelViewProjection(void) const
+        {
+            DerivedValues &derived = derived_stack[modelview_index];
+            if (derived.dirty & DERIVED_MODELVIEW_PROJECTION) {
+                derived.modelview_projection = projection_stack[projection_index] * modelview_stack[modelview_index];
+                derived.dirty &= ~DERIVED_MODELVIEW_PROJECTION;
+                ++counters.modelview_projection;
+            }
+            return derived.modelview_projection;
+        }
+
+        /**
+         * @brief Returns the inverse of the modelview, computed once per change of it.
+         * @remarks The modelview is assumed affine, as camera and model transformations are.
+         */
+        const math::Matrix4D &GetInverseModelView(void) const
+        {
+            return UpdateInverseModelView().inverse_modelview;
+        }
+
+        /// Returns the inverse transpose of the modelview, what transforms the normals.
+        const math::Matrix4D &GetNormalMatrix(void) const
+        {
+            return UpdateInverseModelView().normal_matrix;
+        }
+
+        /**
+         * @brief Returns the plane (a, b, c, d) of the view frustum, a point is inside the plane when
+         * a x + b y + c z + d >= 0.
+         * @remarks The planes are in the space the modelview transforms from (the space of the model
+         * being drawn), normalized so the value is a distance.
+         */
+        const float *GetFrustumPlane(FrustumPlane plane) const
+        {
+            return UpdateFrustumPlanes().frustum_planes[plane];
         }
 
         /**
-         * @brief Gets the current Pipeline reference.
-         * @remarks No checks are done for the reference validity.
+         * @brief Returns false if @a box, in the space the modelview transforms from, is entirely
+         * outside the view frustum.
+         * @remarks Conservative: a box outside the frustum but across the extension of its planes
+         * near a corner is reported visible.
          */
-        static Pipeline *GetCurrentPipeline(void)
+        bool IsBoxVisible(const math::BoundingBox &box) const
         {
-            return Pipeline::instance;
+            const DerivedValues &derived = UpdateFrustumPlanes();
+            for (int i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+                const float *plane = derived.frustum_planes[i];
+                float distance = plane[0] * box.center.x + plane[1] * box.center.y + plane[2] * box.center.z + plane[3];
+                float extent = fabsf(plane[0]) * box.maximumdistanceX + fabsf(plane[1]) * box.maximumdistanceY +
+                               fabsf(plane[2]) * box.maximumdistanceZ;
+                if (distance + extent < 0.f)
+                    return false;
+            }
+            return true;
         }
 
-        /// Set the current static instance.
-        static Pipeline *SetCurrentPipeline(Pipeline *pipeline)
+        /// Returns how many times each derived value was recomputed since the last reset.
+        const PipelineCounters &GetCounters(void) const
         {
-            instance = pipeline;
+            return counters;
+        }
+
+        void ResetCounters(void)
+        {
+            counters = PipelineCounters();
+        }
+
+    private:
+        enum DerivedFlag {
+            DERIVED_MODELVIEW_PROJECTION = 1,
+            DERIVED_INVERSE_MODELVIEW = 2,
+            DERIVED_FRUSTUM_PLANES = 4,
+            DERIVED_ALL = 7
+        };
+
+        /// Values derived from a modelview level and the top of the projection stack.
+        class DerivedValues
+        {
+        public:
+            DerivedValues(): dirty(DERIVED_ALL) {}
+
+        public:
+            math::Matrix4D modelview_projection;
+            math::Matrix4D inverse_modelview;
+            math::Matrix4D normal_matrix;
+            float frustum_planes[FRUSTUM_PLANE_COUNT][4];
+            /// 'DerivedFlag' of the values that are stale.
+            unsigned int dirty;
+        };
+
+        /// Returns the matrix at the top of the current stack for writing, what is derived from it becomes stale.
+        math::Matrix4D &GetTop(void)
+        {
+            if (stack_mode == MODELVIEW) {
+                derived_stack[modelview_index].dirty = DERIVED_ALL;
+                return modelview_stack[modelview_index];
+            }
+            InvalidateProjection();
+            return projection_stack[projection_index];
+        }
+
+        /// The projection is part of the derived values of every modelview level in use.
+        void InvalidateProjection(void)
+        {
+            for (int i = 0; i <= modelview_index; ++i)
+                derived_stack[i].dirty |= DERIVED_MODELVIEW_PROJECTION | DERIVED_FRUSTUM_PLANES;
+        }
+
+        const DerivedValues &UpdateInverseModelView(void) const
+        {
+            DerivedValues &derived = derived_stack[modelview_index];
+            if (derived.dirty & DERIVED_INVERSE_MODELVIEW) {
+                derived.inverse_modelview = modelview_stack[modelview_index].AffineInverse();
+                derived.normal_matrix = derived.inverse_modelview.Transpose();
+                derived.dirty &= ~DERIVED_INVERSE_MODELVIEW;
+                ++counters.inverse_modelview;
+            }
+            return derived;
+        }
+
+        /// Extracts the planes from the rows of the model-view-projection (Gribb and Hartmann).
+        const DerivedValues &UpdateFrustumPlanes(void) const
+        {
+            const math::Matrix4D &mvp = GetModelViewProjection();
+            DerivedValues &derived = derived_stack[modelview_index];
+            if (derived.dirty & DERIVED_FRUSTUM_PLANES) {
+                const float *rows = &mvp.m00;
+                for (int i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+                    // Left and right from the first row, bottom and top from the second, near and far from the third.
+                    const float *row = rows + (i / 2) * 4;
+                    float sign = (i % 2)? -1.f: 1.f;
+                    float *plane = derived.frustum_planes[i];
+                    for (int j = 0; j < 4; ++j)
+                        plane[j] = rows[12 + j] + sign * row[j];
+
+                    float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+                    if (length > 0.f) {
+                        for (int j = 0; j < 4; ++j)
+                            plane[j] /= length;
+                    }
+                }
+                derived.dirty &= ~DERIVED_FRUSTUM_PLANES;
+                ++counters.frustum_planes;
+            }
+            return derived;
         }
 
     private:
         StackMode stack_mode;
 
         math::Matrix4D modelview_stack[MODELVIEWSTACKSIZE];
+        mutable DerivedValues derived_stack[MODELVIEWSTACKSIZE];
         int modelview_index;
 
         math::Matrix4D projection_stack[PROJECTIONSTACKSIZE];
@@ -314,7 +510,7 @@ namespace core {
         float frustum_left, frustum_right, frustum_top, frustum_bottom, frustum_near, frustum_far;
         float viewport_x, viewport_y, viewport_width, viewport_height;
 
-        static Pipeline *instance;
+        mutable PipelineCounters counters;
 
         friend class Renderer;
     };
@@ -60,12 +60,15 @@ namespace math {
             return INTERSECT;
         }
 
-        /// Returns distance to the plane.
-        float DistanceToPlane(const Point3D &pt) const
+        /// Returns distance to the plane, see 'Precision'.
+        float DistanceToPlane(const Point3D &pt, Precision precision = DEFAULT_PRECISION) const
         {
             Vector3D am(this->position, pt);
             float dotproduct = am.DotProduct(this->normal);
-            return ((dotproduct < 0.f)? - dotproduct: dotproduct)/(this->normal.Length());
+            float distance = (dotproduct < 0.f)? - dotproduct: dotproduct;
+            if (precision == PRECISE)
+                return distance/(this->normal.Length(PRECISE));
+            return distance * ReciprocalSqrt(this->normal.LengthSquared(), FAST);
         }
 
         /**
@@ -7,6 +7,7 @@
 
 #include <math.h>
 #include <limits>
+#include "simd.h"
 
 namespace math {
 
@@ -16,15 +17,30 @@ namespace math {
     class Point3D
     {
     public:
-        Point3D(): x(0), y(0), z(0), w(1) {}
-        Point3D(float _x, float _y, float _z, float _w = 1.f): x(_x), y(_y), z(_z), w(_w) {}
-        Point3D(const Point3D &point) { *this = point; }
-        ~Point3D() {}
+        constexpr Point3D(): x(0), y(0), z(0), w(1) {}
+        constexpr Point3D(float _x, float _y, float _z, float _w = 1.f): x(_x), y(_y), z(_z), w(_w) {}
+        explicit Point3D(simd::float4 value) { simd::Store(&x, value); }
 
-        /// Distance between 2 points.
-        float Distance(const Point3D &point) const
+        /// Returns x, y, z and w in a SIMD register.
+        simd::float4 GetRegister(void) const
         {
-            return sqrtf(x * point.x + y * point.y + z * point.z);
+            return simd::Load(&x);
+        }
+
+        /// Squared distance between 2 points, compare it to squared distances to avoid the square root.
+        float DistanceSquared(const Point3D &point) const
+        {
+            simd::float4 difference = simd::Subtract(GetRegister(), point.GetRegister());
+            return simd::Dot3(difference, difference);
+        }
+
+        /// Distance between 2 points, see 'Precision'.
+        float Distance(const Point3D &point, Precision precision = DEFAULT_PRECISION) const
+        {
+            float distance_sqr = DistanceSquared(point);
+            if (precision == PRECISE)
+                return sqrtf(distance_sqr);
+            return (distance_sqr > 0.f)? distance_sqr * ReciprocalSqrt(distance_sqr, FAST): 0.f;
         }
 
         /// Equality operator.
@@ -42,7 +58,7 @@ namespace math {
         /// Overloading unary - operator.
         Point3D operator -(void) const
         {
-            return Point3D(-x, -y, -z, w);
+            return Point3D(simd::Negate3(GetRegister()));
         }
 
     public:
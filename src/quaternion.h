@@ -11,44 +11,46 @@
 
 namespace math {
 
+    class Quat;
+    static Quat operator *(float c, const Quat &quat);
+
     /// Quaternion class.
     class Quat
     {
     public:
         /// Initialize to identity quaternion.
-        Quat(): s(1.f), x(0.f), y(0.f), z(0.f) {}
-        Quat(float _s, float _x, float _y, float _z): s(_s), x(_x), y(_y), z(_z) {}
-        Quat(const Quat &quat) { *this = quat; }
-        ~Quat() {}
+        constexpr Quat(): s(1.f), x(0.f), y(0.f), z(0.f) {}
+        constexpr Quat(float _s, float _x, float _y, float _z): s(_s), x(_x), y(_y), z(_z) {}
 
         /// Adds two quaternions together and returns the result.
         Quat operator +(const Quat &quat) const
         {
-            return Quat(s + quat.s, x + quat.x, y + quat.y, z + quat.z);
+            Quat result;
+            simd::Store(&result.s, simd::Add(simd::Load(&s), simd::Load(&quat.s)));
+            return result;
         }
 
-        /// Multiply a quaternion by another and returns the result.
+        /**
+         * @brief Multiply a quaternion by another and returns the result.
+         * @remarks s = s * s' - v.v', v = s * v' + s' * v + v x v', computed in registers holding
+         * (x, y, z, s).
+         */
         Quat operator *(const Quat &quat) const
         {
-            Quat result;
-            Vector3D v0;
-            Vector3D v1(x, y, z);
-            Vector3D v2(quat.x, quat.y, quat.z);
-            // Setting the resultant quaternion.
-            result.s = s * quat.s - v1.DotProduct(v2);
-            v0 = s * v2 + quat.s * v1 + v1.CrossProduct(v2);
-            result.x = v0.x;
-            result.y = v0.y;
-            result.z = v0.z;
-            return result;
+            simd::float4 q1 = simd::Load(&s), q2 = simd::Load(&quat.s);
+            simd::float4 v1 = simd::RotateLanes(q1), v2 = simd::RotateLanes(q2);
+            simd::float4 v0 = simd::Add(simd::Add(simd::Multiply(simd::SplatX(q1), v2), simd::Multiply(simd::SplatX(q2), v1)),
+                                        simd::Cross3(v1, v2));
+
+            float values[4];
+            simd::Store(values, v0);
+            return Quat(s * quat.s - simd::Dot3(v1, v2), values[0], values[1], values[2]);
         }
 
         /// Dot product of 2 quaternions.
         float DotProduct(const Quat &quat) const
         {
-            Vector3D v1(x, y, z);
-            Vector3D v2(quat.x, quat.y, quat.z);
-            return s * quat.s + v1.DotProduct(v2);
+            return s * quat.s + simd::Dot3(simd::RotateLanes(simd::Load(&s)), simd::RotateLanes(simd::Load(&quat.s)));
         }
 
         /// Magnitude of the quaternion.
@@ -87,6 +89,56 @@ namespace math {
             *this = this->Conjugate();
         }
 
+        /**
+         * @brief Rotates @a vec by this unit quaternion, the same as multiplying it by
+         * 'ToMatrix4D()'. w is left as is.
+         * @remarks v' = v + s t + q x t with t = 2 q x v, q being the vector part.
+         */
+        Vector3D Rotate(const Vector3D &vec) const
+        {
+            simd::float4 q = simd::RotateLanes(simd::Load(&s)), v = vec.GetRegister();
+            simd::float4 t = simd::Cross3(q, v);
+            t = simd::Add(t, t);
+            // The cross products have a w of 0, w goes through.
+            return Vector3D(simd::Add(simd::Add(v, simd::Multiply(simd::Splat(s), t)), simd::Cross3(q, t)));
+        }
+
+        /// Returns the quaternion scaled to unit length, the identity if its length is 0.
+        Quat Normalized(void) const
+        {
+            float length = sqrtf(DotProduct(*this));
+            if (length <= 0.f)
+                return Quat();
+            return (1.f / length) * *this;
+        }
+
+        /**
+         * @brief Interpolates linearly from @a from to @a to by @a t and normalizes, along the
+         * shortest arc. Cheaper than 'Slerp', the angular speed is not constant.
+         */
+        static Quat Nlerp(const Quat &from, const Quat &to, float t)
+        {
+            float weight = (from.DotProduct(to) < 0.f)? -t: t;
+            return ((1.f - t) * from + weight * to).Normalized();
+        }
+
+        /// Interpolates from @a from to @a to by @a t at constant angular speed, along the shortest arc.
+        static Quat Slerp(const Quat &from, const Quat &to, float t)
+        {
+            float cosine = from.DotProduct(to), sign = 1.f;
+            if (cosine < 0.f) {
+                cosine = -cosine;
+                sign = -1.f;
+            }
+
+            // Close quaternions: the sine below vanishes, the linear interpolation is as good.
+            if (cosine > 0.9995f)
+                return Nlerp(from, to, t);
+
+            float angle = acosf(cosine), sine = sinf(angle);
+            return (sinf((1.f - t) * angle) / sine) * from + (sign * sinf(t * angle) / sine) * to;
+        }
+
         /// Converts an axis angle pair into a quaternion, angle in degrees.
         static Quat ToQuaternion(const Vector3D &W, float angle)
         {
@@ -243,10 +295,7 @@ namespace math {
     static Quat operator *(float c, const Quat &quat)
     {
         Quat result;
-        result.s = c * quat.s;
-        result.x = c * quat.x;
-        result.y = c * quat.y;
-        result.z = c * quat.z;
+        simd::Store(&result.s, simd::Multiply(simd::Splat(c), simd::Load(&quat.s)));
         return result;
     }
 }
@@ -8,10 +8,18 @@
 #include "model.h"
 #include "mesh.h"
 #include "pipeline.h"
+#include "draw_list.h"
+#include "instance_buffer.h"
+#include "texture_codec.h"
 
 namespace core {
 
-    /// Interface class for rendering.
+    /**
+     * @brief Interface class for rendering.
+     * @remarks Everything placed by the modelview takes the pipeline it is drawn with, nothing is
+     * read from a shared pipeline. The renderer itself is only used from the main thread, other
+     * threads record into 'DrawList's it then submits.
+     */
     class Renderer
     {
     public:
@@ -24,18 +32,30 @@ namespace core {
         virtual void Cleanup(void) = 0;
         /// Loads a list of texture maps.
         virtual void LoadTextureMaps(std::vector<std::string> paths) = 0;
-        /// Draw a 'Model'.
-        virtual void DrawModel(const Model &model) const = 0;
+        /// Uploads texture maps decoded ahead of time (on the main thread, the API is bound to it).
+        virtual void UploadTextureMaps(const TextureImage *images, unsigned int count) = 0;
+        /// Draw a 'Model' placed by the modelview of @a pipeline, which is left as it was.
+        virtual void DrawModel(const Model &model, Pipeline &pipeline) const = 0;
+        /// Draws the meshes recorded in @a list, in order, only their recorded index ranges.
+        virtual void DrawCommands(const DrawList &list) const = 0;
         /// Draw a 'Mesh'
         virtual void DrawMesh(const Mesh &mesh) const = 0;
+        /**
+         * @brief Draws @a mesh once per transformation in @a transforms (relative to the modelview of
+         * @a pipeline). The material and geometry state is set up once for all instances.
+         */
+        virtual void DrawMeshInstanced(const Mesh &mesh, const math::Matrix4D *transforms, unsigned int count,
+                                       const Pipeline &pipeline) const = 0;
+        /// Draws @a mesh once per instance of @a instances, see above.
+        virtual void DrawMeshInstanced(const Mesh &mesh, const InstanceBuffer &instances, const Pipeline &pipeline) const = 0;
         /// Called before rendering starts.
         virtual void PreUpdate() = 0;
         /// Called after rendering has finished.
         virtual void PostUpdate(int frametime) = 0;
 
-        /// Sets the viewport properties based on the data in the current pipeline.
+        /// Sets the viewport properties based on the data in @a pipeline.
         virtual void UpdateViewportProperties(const Pipeline *pipeline) = 0;
-        /// Sets the projection frustum and type based on the data in the current pipeline.
+        /// Sets the projection frustum and type based on the data in @a pipeline.
         virtual void UpdateProjectionProperties(const Pipeline *pipeline) = 0;
     };
 }
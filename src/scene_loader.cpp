@@ -0,0 +1,200 @@
+#include <windows.h>
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include "scene_loader.h"
+#include "ase_serializer.h"
+#include "binary_serializer.h"
+#include "pak_archive.h"
+
+/// Returns the size of a file in bytes, 0 if it does not exist.
+static unsigned long long GetSourceFileSize(const std::string &file_path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesEx(file_path.c_str(), GetFileExInfoStandard, &attributes))
+        return 0;
+    return ((unsigned long long)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+}
+
+/// Returns whether @a path has the extension @a extension (lower case, without the dot).
+static bool HasExtension(const std::string &path, const char *extension)
+{
+    std::string::size_type dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+
+    std::string suffix = path.substr(dot + 1);
+    for (unsigned int i = 0; i < suffix.size(); ++i)
+        suffix[i] = (char)tolower((unsigned char)suffix[i]);
+    return suffix == extension;
+}
+
+core::SceneLoad::SceneLoad(const std::string &_path, const SceneProcessor &_processor):
+    path(_path), processor(_processor), state(SCENE_LOAD_PARSING), canceled(false), failed(false),
+    bytes_loaded(0), bytes_total(0), objects_loaded(0), objects_total(1), scene(NULL), uploaded_textures(0)
+{
+    future = promise.get_future().share();
+}
+
+core::SceneLoad::~SceneLoad()
+{
+}
+
+core::SceneLoadProgress core::SceneLoad::GetProgress(void) const
+{
+    SceneLoadProgress progress;
+    progress.bytes_loaded = bytes_loaded.load(std::memory_order_relaxed);
+    progress.bytes_total = bytes_total.load(std::memory_order_relaxed);
+    progress.objects_loaded = objects_loaded.load(std::memory_order_relaxed);
+    progress.objects_total = objects_total.load(std::memory_order_relaxed);
+    return progress;
+}
+
+core::SceneLoader::~SceneLoader()
+{
+    for (unsigned int i = 0; i < loads.size(); ++i)
+        loads[i]->Cancel();
+
+    // The jobs return early once canceled, whatever they left behind is released here.
+    while (!loads.empty()) {
+        JobSystem::Wait(loads.back()->jobs);
+        Finish(loads.back(), SCENE_LOAD_CANCELED);
+    }
+}
+
+core::SceneLoad *core::SceneLoader::Load(const std::string &path, const SceneProcessor &processor)
+{
+    SceneLoad *load = new SceneLoad(path, processor);
+    const char *data;
+    size_t size;
+    if (archive && archive->Find(path, data, size))
+        load->bytes_total = size;
+    else
+        load->bytes_total = GetSourceFileSize(path);
+
+    // One reference for the caller, one for the loader until the load is finalized.
+    load->AddRef();
+    loads.push_back(load);
+    JobSystem::Schedule(std::bind(&SceneLoader::Parse, this, load), &load->jobs);
+    return load;
+}
+
+void core::SceneLoader::Parse(SceneLoad *load)
+{
+    if (load->IsCanceled())
+        return;
+
+    // Binary scenes are loaded with lazy payloads: only the hierarchy is read here, the mesh arrays
+    // are copied out of the mapping when first drawn (see 'DrawList::Record').
+    Model *scene;
+    const char *data;
+    size_t size;
+    if (HasExtension(load->path, "ase")) {
+        ASESerializer serializer;
+        scene = serializer.LoadSceneFromFile(load->path);
+    } else if (archive && archive->Find(load->path, data, size)) {
+        BinarySerializer serializer(std::string(), true);
+        scene = serializer.LoadSceneFromMemory(archive->GetFile(), data, size);
+    } else {
+        BinarySerializer serializer(std::string(), true);
+        scene = serializer.LoadSceneFromFile(load->path);
+    }
+
+    load->bytes_loaded.fetch_add(load->bytes_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    load->objects_loaded.fetch_add(1, std::memory_order_relaxed);
+    if (scene && load->processor)
+        scene = load->processor(scene);
+    if (!scene) {
+        load->failed = true;
+        return;
+    }
+    load->scene = scene;
+
+    // Each texture is decoded once, whatever the number of materials using it.
+    std::vector<std::string> paths = scene->GetTexturesList();
+    std::set<std::string> unique_paths;
+    for (unsigned int i = 0; i < paths.size(); ++i) {
+        if (paths[i].empty() || !unique_paths.insert(paths[i]).second)
+            continue;
+
+        TextureImage image;
+        image.path = paths[i];
+        load->textures.push_back(image);
+        load->texture_sizes.push_back(TextureCodec::GetSourceSize(paths[i], archive));
+        load->bytes_total.fetch_add(load->texture_sizes.back(), std::memory_order_relaxed);
+    }
+    load->objects_total.fetch_add((unsigned int)load->textures.size(), std::memory_order_relaxed);
+
+    load->state = SCENE_LOAD_DECODING;
+    for (unsigned int i = 0; i < load->textures.size(); ++i)
+        JobSystem::Schedule(std::bind(&SceneLoader::Decode, this, load, i), &load->jobs);
+}
+
+void core::SceneLoader::Decode(SceneLoad *load, unsigned int index)
+{
+    if (load->IsCanceled())
+        return;
+
+    // A missing texture is not fatal, the meshes using it are drawn untextured.
+    TextureImage &image = load->textures[index];
+    std::string path = image.path;
+    if (!TextureCodec::Load(path, archive, image)) {
+        image = TextureImage();
+        image.path = path;
+    }
+
+    load->bytes_loaded.fetch_add(load->texture_sizes[index], std::memory_order_relaxed);
+    load->objects_loaded.fetch_add(1, std::memory_order_relaxed);
+}
+
+void core::SceneLoader::Update(unsigned int max_uploads)
+{
+    for (unsigned int i = 0; i < loads.size();) {
+        SceneLoad *load = loads[i];
+
+        // Jobs still running for the load.
+        if (!load->jobs.IsDone()) {
+            ++i;
+            continue;
+        }
+
+        if (load->IsCanceled()) {
+            Finish(load, SCENE_LOAD_CANCELED);
+            continue;
+        }
+        if (load->failed) {
+            Finish(load, SCENE_LOAD_FAILED);
+            continue;
+        }
+
+        load->state = SCENE_LOAD_UPLOADING;
+        unsigned int count = std::min(max_uploads, (unsigned int)load->textures.size() - load->uploaded_textures);
+        if (count) {
+            renderer->UploadTextureMaps(&load->textures[load->uploaded_textures], count);
+            load->uploaded_textures += count;
+            max_uploads -= count;
+        }
+
+        if (load->uploaded_textures == load->textures.size()) {
+            Finish(load, SCENE_LOAD_DONE);
+            continue;
+        }
+        ++i;
+    }
+}
+
+void core::SceneLoader::Finish(SceneLoad *load, SceneLoadState state)
+{
+    if (state != SCENE_LOAD_DONE) {
+        delete load->scene;
+        load->scene = NULL;
+    }
+
+    // The pixels are uploaded, only the scene is handed over.
+    std::vector<TextureImage>().swap(load->textures);
+    load->state = state;
+    load->promise.set_value(load->scene);
+
+    loads.erase(std::find(loads.begin(), loads.end(), load));
+    load->Release();
+}
@@ -0,0 +1,214 @@
+/**
+ * @file scene_loader.h
+ * @brief Loads scenes and their textures in the background.
+ */
+#ifndef SCENE_LOADER_H_INCLUDED
+#define SCENE_LOADER_H_INCLUDED
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+#include "job_system.h"
+#include "model.h"
+#include "renderer.h"
+#include "shared_storage.h"
+#include "texture_codec.h"
+
+namespace core {
+
+    class PakArchive;
+
+    /// Steps of a scene load.
+    enum SceneLoadState
+    {
+        /// Reading and parsing the scene file.
+        SCENE_LOAD_PARSING,
+        /// Decoding the textures of the scene.
+        SCENE_LOAD_DECODING,
+        /// Waiting for the main thread to upload the textures.
+        SCENE_LOAD_UPLOADING,
+        /// The scene is available from the future.
+        SCENE_LOAD_DONE,
+        /// The scene or one of the worker steps failed, the future holds NULL.
+        SCENE_LOAD_FAILED,
+        /// Canceled before completion, the future holds NULL.
+        SCENE_LOAD_CANCELED
+    };
+
+    /// Snapshot of the progress of a load, totals grow once the scene tells what it refers to.
+    class SceneLoadProgress
+    {
+    public:
+        SceneLoadProgress(): bytes_loaded(0), bytes_total(0), objects_loaded(0), objects_total(0) {}
+
+        /// Returns the completion ratio in [0, 1], by bytes.
+        float GetRatio(void) const
+        {
+            return bytes_total? (float)((double)bytes_loaded / bytes_total): 0.f;
+        }
+
+    public:
+        /// Bytes of the scene file and the texture files processed so far, and in total.
+        unsigned long long bytes_loaded;
+        unsigned long long bytes_total;
+        /// Objects (the scene, then each texture) processed so far, and in total.
+        unsigned int objects_loaded;
+        unsigned int objects_total;
+    };
+
+    /**
+     * @brief Runs on a worker thread once the scene is parsed, returns the scene to keep (the
+     * parsed one, or a replacement after deleting it), NULL to fail the load.
+     */
+    typedef std::function<Model *(Model *scene)> SceneProcessor;
+
+    /**
+     * @brief Handle on a load started by 'SceneLoader::Load', shared by the caller and the loader.
+     * @remarks Reference counted, the caller releases its reference with 'Release' when done with
+     * it. Once the future is ready the scene belongs to the caller.
+     */
+    class SceneLoad: public SharedStorage
+    {
+    public:
+        /// Returns the future of the scene, ready once the load is done, failed or canceled.
+        std::shared_future<Model *> GetFuture(void) const
+        {
+            return future;
+        }
+
+        /// Returns whether the future is ready (does not block).
+        bool IsReady(void) const
+        {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        /// Returns the current step of the load.
+        SceneLoadState GetState(void) const
+        {
+            return state.load(std::memory_order_acquire);
+        }
+
+        /// Returns the progress of the load.
+        SceneLoadProgress GetProgress(void) const;
+
+        /**
+         * @brief Asks the load to stop, the workers finish their current step and the future is
+         * satisfied with NULL by the next 'SceneLoader::Update'. Does nothing once the load is done.
+         */
+        void Cancel(void)
+        {
+            canceled.store(true, std::memory_order_release);
+        }
+
+        /// Returns the path of the scene file.
+        const std::string &GetPath(void) const
+        {
+            return path;
+        }
+
+    private:
+        friend class SceneLoader;
+
+        SceneLoad(const std::string &_path, const SceneProcessor &_processor);
+        virtual ~SceneLoad();
+
+        bool IsCanceled(void) const
+        {
+            return canceled.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::string path;
+        SceneProcessor processor;
+        std::promise<Model *> promise;
+        std::shared_future<Model *> future;
+
+        std::atomic<SceneLoadState> state;
+        std::atomic<bool> canceled;
+        /// Set by a worker when a step fails.
+        std::atomic<bool> failed;
+        /// Jobs queued or running for this load, finalized by the main thread at 0.
+        JobCounter jobs;
+
+        std::atomic<unsigned long long> bytes_loaded;
+        std::atomic<unsigned long long> bytes_total;
+        std::atomic<unsigned int> objects_loaded;
+        std::atomic<unsigned int> objects_total;
+
+        /// Written by the parsing task, then read only until the load is finalized.
+        Model *scene;
+        std::vector<TextureImage> textures;
+        std::vector<size_t> texture_sizes;
+        /// Textures uploaded so far, uploads are spread over frames.
+        unsigned int uploaded_textures;
+    };
+
+    /**
+     * @brief Loads scenes without blocking the main loop: the scene file is parsed and its
+     * textures decoded by job system workers, the textures are then uploaded by the main thread, a
+     * few per frame, from 'Update'.
+     * @remarks The scene format is chosen by extension: ASE files go through 'ASESerializer',
+     * anything else through 'BinarySerializer', with lazy payloads. Binary scenes and textures are
+     * found like the renderer finds textures, in the archive first.
+     * @remarks 'Load', 'Update' and the destructor must be called from the main thread.
+     */
+    class SceneLoader
+    {
+    public:
+        /**
+         * @param _renderer Receives the textures.
+         * @param _archive Archive the scenes and textures are looked up in, can be NULL. Must outlive
+         * the loader, the scenes read from it hold a reference on its mapping.
+         */
+        SceneLoader(Renderer *_renderer, const PakArchive *_archive): renderer(_renderer), archive(_archive) {}
+
+        /// Cancels the pending loads and waits for their jobs.
+        ~SceneLoader();
+
+        /**
+         * @brief Starts loading the scene at @a path.
+         * @param path The scene file, relative to the project directory.
+         * @param processor Optional work done on the parsed scene on a worker thread.
+         * @return The load, with a reference for the caller.
+         */
+        SceneLoad *Load(const std::string &path, const SceneProcessor &processor = SceneProcessor());
+
+        /**
+         * @brief Advances the loads: uploads decoded textures and satisfies the futures of the
+         * finished loads. Called once per frame.
+         * @param max_uploads Maximum number of textures uploaded in this call, to bound the frame
+         * time.
+         */
+        void Update(unsigned int max_uploads = 4);
+
+        /// Returns whether any load is still running.
+        bool IsBusy(void) const
+        {
+            return !loads.empty();
+        }
+
+    private:
+        // Not copyable, owns its loads.
+        SceneLoader(const SceneLoader &);
+        SceneLoader &operator =(const SceneLoader &);
+
+        /// Job: reads the scene, runs the processor and queues the texture decodes.
+        void Parse(SceneLoad *load);
+
+        /// Job: decodes the texture at @a index.
+        void Decode(SceneLoad *load, unsigned int index);
+
+        /// Main thread: satisfies the future of @a load and drops the loader reference.
+        void Finish(SceneLoad *load, SceneLoadState state);
+
+    private:
+        Renderer *renderer;
+        const PakArchive *archive;
+        /// Loads not finalized yet, touched by the main thread only.
+        std::vector<SceneLoad *> loads;
+    };
+}
+
+#endif // SCENE_LOADER_H_INCLUDED
@@ -0,0 +1,61 @@
+/**
+ * @file shared_storage.h
+ * @brief Base class for reference counted memory owners.
+ */
+#ifndef SHARED_STORAGE_H_INCLUDED
+#define SHARED_STORAGE_H_INCLUDED
+
+#include <atomic>
+
+namespace core {
+
+    /**
+     * @brief Intrusive, thread safe reference count. The object is created with a count of 1
+     * (owned by its creator) and destroyed when the last reference is released.
+     * @remarks Derived classes that do not live on the heap (placed in an arena or a mapped file)
+     * override 'Destroy'.
+     */
+    class SharedStorage
+    {
+    public:
+        SharedStorage(): reference_count(1) {}
+
+        /// Adds a reference to the object.
+        void AddRef(void) const
+        {
+            reference_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Removes a reference, the object is destroyed when no references are left.
+        void Release(void) const
+        {
+            if (reference_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                const_cast<SharedStorage *>(this)->Destroy();
+        }
+
+        /// Returns the current number of references (only meaningful as a hint across threads).
+        int GetReferenceCount(void) const
+        {
+            return reference_count.load(std::memory_order_acquire);
+        }
+
+    protected:
+        virtual ~SharedStorage() {}
+
+        /// Called when the last reference is released.
+        virtual void Destroy(void)
+        {
+            delete this;
+        }
+
+    private:
+        // Not copyable, references are shared through the pointer.
+        SharedStorage(const SharedStorage &);
+        SharedStorage &operator =(const SharedStorage &);
+
+    private:
+        mutable std::atomic<int> reference_count;
+    };
+}
+
+#endif // SHARED_STORAGE_H_INCLUDED
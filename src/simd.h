@@ -0,0 +1,370 @@
+/**
+ * @file simd.h
+ * @brief 4 float registers backing the math types: SSE, NEON or a scalar fallback.
+ */
+#ifndef SIMD_H_INCLUDED
+#define SIMD_H_INCLUDED
+
+#include <math.h>
+
+// The backend is chosen at compile time, defining MATH_SIMD_SCALAR forces the portable one.
+#if !defined(MATH_SIMD_SCALAR) && !defined(MATH_SIMD_SSE) && !defined(MATH_SIMD_NEON)
+#   if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#       define MATH_SIMD_SSE
+#   elif defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64)
+#       define MATH_SIMD_NEON
+#   else
+#       define MATH_SIMD_SCALAR
+#   endif
+#endif
+
+#if defined(MATH_SIMD_SSE)
+#   include <xmmintrin.h>
+#   define MATH_SIMD_BACKEND "sse"
+#elif defined(MATH_SIMD_NEON)
+#   include <arm_neon.h>
+#   define MATH_SIMD_BACKEND "neon"
+#else
+#   define MATH_SIMD_BACKEND "scalar"
+#endif
+
+namespace math {
+
+    /**
+     * @brief Operations on 4 floats at once, used by 'Vector3D', 'Point3D', 'Quat' and 'Matrix4D'.
+     * @remarks Every operation is done lane by lane in the same order as the scalar code, so
+     * the three backends give bit identical results (IEEE single precision, no fused multiply
+     * add). Horizontal sums in particular add x, y then z.
+     * @remarks Loads and stores are unaligned: the math types keep their natural alignment, they
+     * are stored in vectors and mapped files that do not guarantee 16 bytes. On aligned data the
+     * unaligned instructions cost the same.
+     */
+    namespace simd {
+
+#if defined(MATH_SIMD_SSE)
+        typedef __m128 float4;
+
+        inline float4 Load(const float *values) { return _mm_loadu_ps(values); }
+        inline void Store(float *values, float4 a) { _mm_storeu_ps(values, a); }
+        inline float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+        inline float4 Splat(float value) { return _mm_set1_ps(value); }
+        inline float4 Add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+        inline float4 Subtract(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+        inline float4 Multiply(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+        inline float4 Divide(float4 a, float4 b) { return _mm_div_ps(a, b); }
+        inline float GetX(float4 a) { return _mm_cvtss_f32(a); }
+        /// Estimates of 1 / sqrt(a) and 1 / a, relative error under 1.5 * 2^-12.
+        inline float4 ReciprocalSqrtEstimate(float4 a) { return _mm_rsqrt_ps(a); }
+        inline float4 ReciprocalEstimate(float4 a) { return _mm_rcp_ps(a); }
+
+        /// Returns (-x, -y, -z, w).
+        inline float4 Negate3(float4 a)
+        {
+            return _mm_xor_ps(a, _mm_setr_ps(-0.f, -0.f, -0.f, 0.f));
+        }
+
+        /// Returns (y, z, w, x).
+        inline float4 RotateLanes(float4 a)
+        {
+            return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 3, 2, 1));
+        }
+
+        /// Returns (x, x, x, x).
+        inline float4 SplatX(float4 a)
+        {
+            return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0));
+        }
+
+        /// Returns x * x' + y * y' + z * z', summed in that order.
+        inline float Dot3(float4 a, float4 b)
+        {
+            __m128 product = _mm_mul_ps(a, b);
+            __m128 sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2)));
+            return _mm_cvtss_f32(sum);
+        }
+
+        /// Returns the cross product of the xyz lanes, w is 0.
+        inline float4 Cross3(float4 a, float4 b)
+        {
+            __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 b_zxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+            __m128 a_zxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+            __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 cross = _mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx));
+            return _mm_shuffle_ps(cross, _mm_unpackhi_ps(cross, _mm_setzero_ps()), _MM_SHUFFLE(3, 0, 1, 0));
+        }
+
+        /// Returns (a[X], a[Y], b[Z], b[W]).
+        template <int X, int Y, int Z, int W>
+        inline float4 Shuffle(float4 a, float4 b)
+        {
+            return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        /// Transposes the 4 by 4 matrix of rows @a r0 to @a r3 in place.
+        inline void Transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3)
+        {
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        }
+#elif defined(MATH_SIMD_NEON)
+        typedef float32x4_t float4;
+
+        inline float4 Load(const float *values) { return vld1q_f32(values); }
+        inline void Store(float *values, float4 a) { vst1q_f32(values, a); }
+        inline float4 Set(float x, float y, float z, float w)
+        {
+            float values[4] = { x, y, z, w };
+            return vld1q_f32(values);
+        }
+        inline float4 Splat(float value) { return vdupq_n_f32(value); }
+        inline float4 Add(float4 a, float4 b) { return vaddq_f32(a, b); }
+        inline float4 Subtract(float4 a, float4 b) { return vsubq_f32(a, b); }
+        inline float4 Multiply(float4 a, float4 b) { return vmulq_f32(a, b); }
+        inline float GetX(float4 a) { return vgetq_lane_f32(a, 0); }
+        /// Estimates of 1 / sqrt(a) and 1 / a, relative error under 2^-8.
+        inline float4 ReciprocalSqrtEstimate(float4 a) { return vrsqrteq_f32(a); }
+        inline float4 ReciprocalEstimate(float4 a) { return vrecpeq_f32(a); }
+
+        inline float4 Divide(float4 a, float4 b)
+        {
+#if defined(__aarch64__) || defined(_M_ARM64)
+            return vdivq_f32(a, b);
+#else
+            // ARMv7 only has a reciprocal estimate, the exact quotient is computed by lane.
+            float x[4], y[4];
+            vst1q_f32(x, a);
+            vst1q_f32(y, b);
+            return Set(x[0] / y[0], x[1] / y[1], x[2] / y[2], x[3] / y[3]);
+#endif
+        }
+
+        /// Returns (-x, -y, -z, w).
+        inline float4 Negate3(float4 a)
+        {
+            return vsetq_lane_f32(vgetq_lane_f32(a, 3), vnegq_f32(a), 3);
+        }
+
+        /// Returns (y, z, w, x).
+        inline float4 RotateLanes(float4 a)
+        {
+            return vextq_f32(a, a, 1);
+        }
+
+        /// Returns (x, x, x, x).
+        inline float4 SplatX(float4 a)
+        {
+            return vdupq_lane_f32(vget_low_f32(a), 0);
+        }
+
+        /// Returns x * x' + y * y' + z * z', summed in that order.
+        inline float Dot3(float4 a, float4 b)
+        {
+            float32x4_t product = vmulq_f32(a, b);
+            return (vgetq_lane_f32(product, 0) + vgetq_lane_f32(product, 1)) + vgetq_lane_f32(product, 2);
+        }
+
+        /// Returns the cross product of the xyz lanes, w is 0.
+        inline float4 Cross3(float4 a, float4 b)
+        {
+            // (y, z, x, y) and (z, x, y, x) of each operand.
+            float32x2_t a_xy = vget_low_f32(a), a_zw = vget_high_f32(a);
+            float32x2_t b_xy = vget_low_f32(b), b_zw = vget_high_f32(b);
+            float32x4_t a_yzx = vcombine_f32(vext_f32(a_xy, a_zw, 1), a_xy);
+            float32x4_t b_yzx = vcombine_f32(vext_f32(b_xy, b_zw, 1), b_xy);
+            float32x4_t a_zxy = vcombine_f32(vset_lane_f32(vget_lane_f32(a_xy, 0), a_zw, 1), vrev64_f32(a_xy));
+            float32x4_t b_zxy = vcombine_f32(vset_lane_f32(vget_lane_f32(b_xy, 0), b_zw, 1), vrev64_f32(b_xy));
+            float32x4_t cross = vsubq_f32(vmulq_f32(a_yzx, b_zxy), vmulq_f32(a_zxy, b_yzx));
+            return vsetq_lane_f32(0.f, cross, 3);
+        }
+
+        /// Returns (a[X], a[Y], b[Z], b[W]).
+        template <int X, int Y, int Z, int W>
+        inline float4 Shuffle(float4 a, float4 b)
+        {
+            return Set(vgetq_lane_f32(a, X), vgetq_lane_f32(a, Y), vgetq_lane_f32(b, Z), vgetq_lane_f32(b, W));
+        }
+
+        /// Transposes the 4 by 4 matrix of rows @a r0 to @a r3 in place.
+        inline void Transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3)
+        {
+            float32x4x2_t r01 = vtrnq_f32(r0, r1), r23 = vtrnq_f32(r2, r3);
+            r0 = vcombine_f32(vget_low_f32(r01.val[0]), vget_low_f32(r23.val[0]));
+            r1 = vcombine_f32(vget_low_f32(r01.val[1]), vget_low_f32(r23.val[1]));
+            r2 = vcombine_f32(vget_high_f32(r01.val[0]), vget_high_f32(r23.val[0]));
+            r3 = vcombine_f32(vget_high_f32(r01.val[1]), vget_high_f32(r23.val[1]));
+        }
+#else
+        /// Portable register, the compiler is free to vectorize it.
+        class float4
+        {
+        public:
+            float v[4];
+        };
+
+        inline float4 Set(float x, float y, float z, float w)
+        {
+            float4 a;
+            a.v[0] = x;
+            a.v[1] = y;
+            a.v[2] = z;
+            a.v[3] = w;
+            return a;
+        }
+
+        inline float4 Load(const float *values) { return Set(values[0], values[1], values[2], values[3]); }
+        inline float4 Splat(float value) { return Set(value, value, value, value); }
+        inline float GetX(float4 a) { return a.v[0]; }
+
+        inline void Store(float *values, float4 a)
+        {
+            for (int i = 0; i < 4; ++i)
+                values[i] = a.v[i];
+        }
+
+        inline float4 Add(float4 a, float4 b)
+        {
+            return Set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]);
+        }
+
+        inline float4 Subtract(float4 a, float4 b)
+        {
+            return Set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]);
+        }
+
+        inline float4 Multiply(float4 a, float4 b)
+        {
+            return Set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]);
+        }
+
+        inline float4 Divide(float4 a, float4 b)
+        {
+            return Set(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]);
+        }
+
+        /// Without estimate instructions the exact values are used.
+        inline float4 ReciprocalSqrtEstimate(float4 a)
+        {
+            return Set(1.f / sqrtf(a.v[0]), 1.f / sqrtf(a.v[1]), 1.f / sqrtf(a.v[2]), 1.f / sqrtf(a.v[3]));
+        }
+
+        inline float4 ReciprocalEstimate(float4 a)
+        {
+            return Divide(Splat(1.f), a);
+        }
+
+        /// Returns (-x, -y, -z, w).
+        inline float4 Negate3(float4 a)
+        {
+            return Set(-a.v[0], -a.v[1], -a.v[2], a.v[3]);
+        }
+
+        /// Returns (y, z, w, x).
+        inline float4 RotateLanes(float4 a)
+        {
+            return Set(a.v[1], a.v[2], a.v[3], a.v[0]);
+        }
+
+        /// Returns (x, x, x, x).
+        inline float4 SplatX(float4 a)
+        {
+            return Splat(a.v[0]);
+        }
+
+        /// Returns x * x' + y * y' + z * z', summed in that order.
+        inline float Dot3(float4 a, float4 b)
+        {
+            return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2];
+        }
+
+        /// Returns the cross product of the xyz lanes, w is 0.
+        inline float4 Cross3(float4 a, float4 b)
+        {
+            return Set(a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2],
+                       a.v[0] * b.v[1] - a.v[1] * b.v[0], 0.f);
+        }
+
+        /// Returns (a[X], a[Y], b[Z], b[W]).
+        template <int X, int Y, int Z, int W>
+        inline float4 Shuffle(float4 a, float4 b)
+        {
+            return Set(a.v[X], a.v[Y], b.v[Z], b.v[W]);
+        }
+
+        /// Transposes the 4 by 4 matrix of rows @a r0 to @a r3 in place.
+        inline void Transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3)
+        {
+            float4 t0 = Set(r0.v[0], r1.v[0], r2.v[0], r3.v[0]);
+            float4 t1 = Set(r0.v[1], r1.v[1], r2.v[1], r3.v[1]);
+            float4 t2 = Set(r0.v[2], r1.v[2], r2.v[2], r3.v[2]);
+            r3 = Set(r0.v[3], r1.v[3], r2.v[3], r3.v[3]);
+            r0 = t0;
+            r1 = t1;
+            r2 = t2;
+        }
+#endif
+
+        /// Returns (a[X], a[Y], a[Z], a[W]).
+        template <int X, int Y, int Z, int W>
+        inline float4 Swizzle(float4 a)
+        {
+            return Shuffle<X, Y, Z, W>(a, a);
+        }
+
+        /// Returns 1 / sqrt(a): the estimate refined by one Newton-Raphson step, y (3 - a y^2) / 2.
+        inline float4 ReciprocalSqrtFast(float4 a)
+        {
+            float4 y = ReciprocalSqrtEstimate(a);
+            float4 half_a_y2 = Multiply(Multiply(Splat(0.5f), a), Multiply(y, y));
+            return Multiply(y, Subtract(Splat(1.5f), half_a_y2));
+        }
+
+        /// Returns 1 / a: the estimate refined by one Newton-Raphson step, y (2 - a y).
+        inline float4 ReciprocalFast(float4 a)
+        {
+            float4 y = ReciprocalEstimate(a);
+            return Multiply(y, Subtract(Splat(2.f), Multiply(a, y)));
+        }
+    }
+
+    /**
+     * @brief Precision of the operations that take one. 'PRECISE' rounds like sqrtf and the
+     * division. 'FAST' refines the reciprocal estimates of the processor with one Newton-Raphson
+     * step: relative error under 2^-21 (1/sqrt) and 2^-22 (1/x) on SSE, and a few times that on
+     * NEON. 0 and infinities are not handled.
+     * @remarks The estimates differ between processor vendors: 'FAST' results must not end up in
+     * files or be compared across machines.
+     * @remarks Recent x86 cores take the square root and the division about as fast as the
+     * refinement, the bench project tells whether 'FAST' pays off on a target.
+     */
+    enum Precision
+    {
+        PRECISE,
+        FAST
+    };
+
+    /// Default of the functions taking a 'Precision', defining MATH_FAST_MATH makes it 'FAST'.
+#if defined(MATH_FAST_MATH)
+    const Precision DEFAULT_PRECISION = FAST;
+#else
+    const Precision DEFAULT_PRECISION = PRECISE;
+#endif
+
+    /// Returns 1 / sqrtf(@a value).
+    inline float ReciprocalSqrt(float value, Precision precision = DEFAULT_PRECISION)
+    {
+        if (precision == PRECISE)
+            return 1.f / sqrtf(value);
+        return simd::GetX(simd::ReciprocalSqrtFast(simd::Splat(value)));
+    }
+
+    /// Returns 1 / @a value.
+    inline float Reciprocal(float value, Precision precision = DEFAULT_PRECISION)
+    {
+        if (precision == PRECISE)
+            return 1.f / value;
+        return simd::GetX(simd::ReciprocalFast(simd::Splat(value)));
+    }
+}
+
+#endif // SIMD_H_INCLUDED
@@ -30,7 +30,6 @@ namespace math {
          */
         Classify ClassifyToSphere(const Sphere &sphere) const
         {
-            LineSegment3D o1o2(center, sphere.center);
             float r1 = radius;
             float r2 = sphere.radius;;
             float r1plusr2 = r1 + r2;
@@ -38,8 +37,7 @@ namespace math {
             float r1minusr2 = r1 - r2;
             float r1minusr2square = r1minusr2 * r1minusr2;
             float r2minusr1 = r2 - r1;
-            float length = o1o2.Length();
-            float length_sqr = length * length;
+            float length_sqr = Vector3D(center, sphere.center).LengthSquared();
 
             if (EQUALTO(r1plusr2square, length_sqr, std::numeric_limits<float>::epsilon()) || EQUALTO(r1minusr2square, length_sqr, std::numeric_limits<float>::epsilon()))
                 return TANGENT;
@@ -47,9 +45,10 @@ namespace math {
                 return INTERSECT;
             if ((center == sphere.center) && EQUALTO(radius, sphere.radius, std::numeric_limits<float>::epsilon()))
                 return COINCIDENT;
-            if (length < r2minusr1)
+            // Squared lengths compare like the lengths as long as both sides are positive.
+            if (r2minusr1 > 0.f && length_sqr < r2minusr1 * r2minusr1)
                 return C1INSIDEC2;
-            if (length < r1minusr2)
+            if (r1minusr2 > 0.f && length_sqr < r1minusr2square)
                 return C2INSIDEC1;
             if (r1plusr2square < length_sqr)
                 return DISJOINT;
@@ -66,10 +65,10 @@ namespace math {
          */
         Classify ClassifyToSphere(const Line3D &line, Point3D &intersection_point0, Point3D &intersection_point1) const
         {
-            Vector3D PC(line.position, center);
-            float A = line.direction.Length() * line.direction.Length();
+            Vector3D PC(center, line.position);
+            float A = line.direction.LengthSquared();
             float B = 2 * (line.direction.DotProduct(PC));
-            float C = PC.Length() * PC.Length() - radius * radius;
+            float C = PC.LengthSquared() - radius * radius;
             float delta = B * B - 4 * A * C;
 
             /*two intersection points exists*/
@@ -86,7 +85,7 @@ namespace math {
 
                 return INTERSECT;
             } else if(ISZERO(delta, std::numeric_limits<float>::epsilon())) {
-                float t = (-B/2*A);
+                float t = -B/(2 * A);
 
                 intersection_point0.x = line.direction.x * t + line.position.x;
                 intersection_point0.y = line.direction.y * t + line.position.y;
@@ -106,10 +105,12 @@ namespace math {
          */
         Classify ClassifyToSphere(const Point3D &pt) const
         {
-            Vector3D pc(pt, this->center);
-            if (pc.Length() > this->radius)
+            // Compared squared, the radius is not negative.
+            float length_sqr = Vector3D(pt, this->center).LengthSquared();
+            float radius_sqr = this->radius * this->radius;
+            if (length_sqr > radius_sqr)
                 return OUTSIDE;
-            else if (pc.Length() < this->radius)
+            else if (length_sqr < radius_sqr)
                 return INSIDE;
 
             return ON;
@@ -0,0 +1,313 @@
+#include <cstdio>
+#include <cfloat>
+#include <algorithm>
+#include <map>
+#include "static_batcher.h"
+#include "transform_batch.h"
+
+/// A mesh to merge, with its world transformation.
+struct BatchSource
+{
+    const core::Mesh *mesh;
+    math::Matrix4D transform;
+};
+
+/// Sources that share the same materials.
+struct BatchGroup
+{
+    const std::vector<core::Material> *materials;
+    std::vector<BatchSource> sources;
+};
+
+/**
+ * @brief Adds @a placed to @a output, @a world being its world transformation and its own
+ * transformation being relative to the last model of @a path (the models from the root down).
+ * @remarks When @a world has a shear (a non uniform scale under a rotation), which a
+ * 'math::Transform' cannot hold, the chain of @a path is copied instead and @a placed keeps its
+ * transformation.
+ */
+static void AddPlaced(core::Model *placed, const math::Matrix4D &world, const std::vector<const core::Model *> &path,
+                      core::Model &output)
+{
+    if (math::Transform::TryFromMatrix4D(world, placed->transform)) {
+        output.sub_models.push_back(placed);
+        return;
+    }
+
+    core::Model *parent = &output;
+    for (unsigned int i = 0; i < path.size(); ++i) {
+        core::Model *link = new core::Model();
+        link->name = path[i]->name;
+        link->transform = path[i]->transform;
+        link->is_static = path[i]->is_static;
+        parent->sub_models.push_back(link);
+        parent = link;
+    }
+    parent->sub_models.push_back(placed);
+}
+
+/// Number of meshes of the hierarchy referencing each geometry buffer.
+typedef std::map<const core::GeometryBuffer *, unsigned int> GeometryUsers;
+
+/**
+ * @brief Counts the meshes of @a model and its sub models using each geometry buffer, the static
+ * meshes are made resident first (a payload source shares the buffer between meshes of a blob).
+ */
+static void CountGeometryUsers(const core::Model &model, GeometryUsers &users)
+{
+    for (unsigned int i = 0; i < model.meshes.size(); ++i) {
+        const core::Mesh *mesh = model.meshes[i];
+        if (model.is_static)
+            mesh->EnsureResident();
+        if (mesh->GetGeometry())
+            ++users[mesh->GetGeometry()];
+    }
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        CountGeometryUsers(*model.sub_models[i], users);
+}
+
+/**
+ * @brief Walks the hierarchy, collecting the meshes that can be merged in @a groups; everything
+ * else is copied as a sub model of @a output.
+ * @remarks Meshes sharing their geometry with other meshes (see 'GeometryDeduplicator') are kept
+ * too: merging them would copy the shared vertices once per user.
+ * @remarks The transformations are composed as matrices, composing 'math::Transform' loses the
+ * shear of a non uniform scale under a rotation. @a path holds the ancestors of @a model.
+ */
+static void CollectSources(const core::Model &model, const math::Matrix4D &parent_matrix, unsigned int max_mesh_vertices,
+                           const GeometryUsers &users, std::vector<const core::Model *> &path, std::vector<BatchGroup> &groups,
+                           core::Model &output)
+{
+    math::Matrix4D world_matrix = parent_matrix * model.transform.ToMatrix4D();
+
+    if (!model.is_static) {
+        AddPlaced(new core::Model(model), world_matrix, path, output);
+        return;
+    }
+
+    path.push_back(&model);
+    for (unsigned int i = 0; i < model.meshes.size(); ++i) {
+        const core::Mesh *mesh = model.meshes[i];
+        if (!mesh->EnsureResident() || !mesh->vertices || !mesh->index_array)
+            continue;
+
+        GeometryUsers::const_iterator users_of = users.find(mesh->GetGeometry());
+        bool shared = users_of != users.end() && users_of->second > 1;
+        if (mesh->vertex_number > max_mesh_vertices || shared) {
+            core::Model *kept = new core::Model();
+            kept->name = mesh->name;
+            kept->meshes.push_back(new core::Mesh(*mesh));
+            AddPlaced(kept, world_matrix, path, output);
+            continue;
+        }
+
+        BatchSource source;
+        source.mesh = mesh;
+        source.transform = world_matrix;
+
+        unsigned int j = 0;
+        while (j < groups.size() && *groups[j].materials != mesh->materials)
+            ++j;
+        if (j == groups.size()) {
+            groups.push_back(BatchGroup());
+            groups[j].materials = &mesh->materials;
+        }
+        groups[j].sources.push_back(source);
+    }
+
+    for (unsigned int i = 0; i < model.sub_models.size(); ++i)
+        CollectSources(*model.sub_models[i], world_matrix, max_mesh_vertices, users, path, groups, output);
+    path.pop_back();
+}
+
+/// Fills @a count values of @a components floats with @a value.
+static void FillArray(float *destination, unsigned int count, unsigned int components, float value)
+{
+    std::fill(destination, destination + count * components, value);
+}
+
+/**
+ * @brief Appends @a hull transformed by @a matrix to @a hulls, @a normal_matrix being the inverse
+ * transpose of @a matrix.
+ * @remarks The planes stay outward and unit length, a mirroring @a matrix flips the winding of
+ * the triangles back.
+ */
+static void AddTransformedHull(const core::ConvexHull &hull, const math::Matrix4D &matrix, const math::Matrix4D &normal_matrix,
+                               bool mirrored, std::vector<core::ConvexHull> &hulls)
+{
+    hulls.push_back(core::ConvexHull());
+    core::ConvexHull &transformed = hulls.back();
+
+    transformed.vertices.resize(hull.GetVertexCount() * 3);
+    if (hull.GetVertexCount())
+        math::TransformPoints(matrix, &hull.vertices[0], 3, &transformed.vertices[0], 3, hull.GetVertexCount());
+
+    transformed.indices = hull.indices;
+    if (mirrored) {
+        for (unsigned int j = 0; j + 2 < transformed.indices.size(); j += 3)
+            std::swap(transformed.indices[j + 1], transformed.indices[j + 2]);
+    }
+
+    // n.p + d = 0 becomes n'.p' + d - n'.t = 0 with n' the normal through the inverse transpose.
+    math::Vector3D translation(matrix.m03, matrix.m13, matrix.m23);
+    transformed.planes.resize(hull.GetPlaneCount() * 4);
+    for (unsigned int j = 0; j < transformed.planes.size(); j += 4) {
+        math::Vector3D normal = normal_matrix * math::Vector3D(hull.planes[j], hull.planes[j + 1], hull.planes[j + 2]);
+        float d = hull.planes[j + 3] - (normal.x * translation.x + normal.y * translation.y + normal.z * translation.z);
+        float length = normal.Length(math::PRECISE);
+        if (length > 0.f) {
+            normal = normal * (1.f / length);
+            d /= length;
+        }
+        transformed.planes[j] = normal.x;
+        transformed.planes[j + 1] = normal.y;
+        transformed.planes[j + 2] = normal.z;
+        transformed.planes[j + 3] = d;
+    }
+}
+
+/// Merges the @a count sources at @a sources into a single mesh allocated from @a arena.
+static core::Mesh *MergeSources(const BatchSource *sources, unsigned int count, core::MeshArena *arena)
+{
+    unsigned int vertex_number = 0, index_array_size = 0, uv_layer_count = 0;
+    bool use_colors = false;
+    for (unsigned int i = 0; i < count; ++i) {
+        const core::Mesh *mesh = sources[i].mesh;
+        vertex_number += mesh->vertex_number;
+        index_array_size += mesh->index_array_size;
+        uv_layer_count = std::max(uv_layer_count, mesh->uv_layer_count);
+        use_colors = use_colors || (mesh->is_using_colors && mesh->colors);
+    }
+
+    core::Mesh *merged = new core::Mesh();
+    merged->Allocate(vertex_number, uv_layer_count, index_array_size, use_colors, arena);
+    merged->materials = sources[0].mesh->materials;
+
+    unsigned int first_vertex = 0, first_index = 0;
+    for (unsigned int i = 0; i < count; ++i) {
+        const core::Mesh *mesh = sources[i].mesh;
+        const math::Matrix4D &matrix = sources[i].transform;
+        // Normals go through the inverse transpose to stay perpendicular under non uniform scales.
+        math::Matrix4D normal_matrix = matrix.AffineInverse().Transpose();
+        unsigned int n = mesh->vertex_number;
+
+        core::MeshRange range;
+        range.name = mesh->name;
+        range.first_vertex = first_vertex;
+        range.vertex_count = n;
+        range.first_index = first_index;
+        range.index_count = mesh->index_array_size;
+        range.first_hull = (unsigned int)merged->hulls.size();
+        range.hull_count = (unsigned int)mesh->hulls.size();
+
+        float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        float *vertices = merged->vertices + first_vertex * 4;
+        math::TransformPoints(matrix, mesh->vertices, 4, vertices, 4, n);
+        for (unsigned int j = 0; j < n; ++j) {
+            const float *point = vertices + j * 4;
+            minimum[0] = std::min(minimum[0], point[0]); maximum[0] = std::max(maximum[0], point[0]);
+            minimum[1] = std::min(minimum[1], point[1]); maximum[1] = std::max(maximum[1], point[1]);
+            minimum[2] = std::min(minimum[2], point[2]); maximum[2] = std::max(maximum[2], point[2]);
+        }
+
+        range.bounds.center = math::Point3D((minimum[0] + maximum[0]) / 2, (minimum[1] + maximum[1]) / 2,
+                                            (minimum[2] + maximum[2]) / 2);
+        range.bounds.maximumdistanceX = (maximum[0] - minimum[0]) / 2;
+        range.bounds.maximumdistanceY = (maximum[1] - minimum[1]) / 2;
+        range.bounds.maximumdistanceZ = (maximum[2] - minimum[2]) / 2;
+
+        // Cooked files must not depend on the processor that cooked them, no estimates here.
+        math::TransformDirections(normal_matrix, mesh->normals, merged->normals + first_vertex * 3, n, true, math::PRECISE);
+
+        if (use_colors) {
+            if (mesh->is_using_colors && mesh->colors)
+                std::copy(mesh->colors, mesh->colors + n * 4, merged->colors + first_vertex * 4);
+            else
+                FillArray(merged->colors + first_vertex * 4, n, 4, 1.f);
+        }
+
+        // Layers the source does not have are left zeroed.
+        for (unsigned int l = 0; l < uv_layer_count; ++l) {
+            if (l < mesh->uv_layer_count) {
+                math::TransformDirections(matrix, mesh->tangents[l], merged->tangents[l] + first_vertex * 3, n, true,
+                                          math::PRECISE);
+                math::TransformDirections(matrix, mesh->binormals[l], merged->binormals[l] + first_vertex * 3, n, true,
+                                          math::PRECISE);
+                std::copy(mesh->uv_coordinates[l], mesh->uv_coordinates[l] + n * 3, merged->uv_coordinates[l] + first_vertex * 3);
+            } else {
+                FillArray(merged->tangents[l] + first_vertex * 3, n, 3, 0.f);
+                FillArray(merged->binormals[l] + first_vertex * 3, n, 3, 0.f);
+                FillArray(merged->uv_coordinates[l] + first_vertex * 3, n, 3, 0.f);
+            }
+        }
+
+        // A mirroring transformation flips the winding, swap 2 corners to keep the front faces.
+        bool mirrored = matrix.determinant() < 0.f;
+        unsigned short *indices = merged->index_array + first_index;
+        for (unsigned int j = 0; j < mesh->index_array_size; ++j)
+            indices[j] = (unsigned short)(mesh->index_array[j] + first_vertex);
+        if (mirrored) {
+            for (unsigned int j = 0; j + 2 < mesh->index_array_size; j += 3)
+                std::swap(indices[j + 1], indices[j + 2]);
+        }
+
+        for (unsigned int h = 0; h < mesh->hulls.size(); ++h)
+            AddTransformedHull(mesh->hulls[h], matrix, normal_matrix, mirrored, merged->hulls);
+
+        merged->ranges.push_back(range);
+        first_vertex += n;
+        first_index += mesh->index_array_size;
+    }
+
+    merged->ComputeBounds();
+    return merged;
+}
+
+core::Model *core::StaticBatcher::Build(const Model &scene, unsigned int max_mesh_vertices)
+{
+    if (max_mesh_vertices > STATIC_BATCH_MAX_VERTICES)
+        max_mesh_vertices = STATIC_BATCH_MAX_VERTICES;
+
+    Model *output = new Model();
+    output->name = scene.name;
+
+    GeometryUsers users;
+    CountGeometryUsers(scene, users);
+
+    std::vector<BatchGroup> groups;
+    std::vector<const Model *> path;
+    CollectSources(scene, math::Matrix4D(), max_mesh_vertices, users, path, groups, *output);
+
+    // The merged meshes are allocated from a single arena.
+    size_t storage_size = 0;
+    for (unsigned int i = 0; i < groups.size(); ++i) {
+        for (unsigned int j = 0; j < groups[i].sources.size(); ++j) {
+            const Mesh *mesh = groups[i].sources[j].mesh;
+            storage_size += Mesh::GetStorageSize(mesh->vertex_number, mesh->uv_layer_count, mesh->index_array_size,
+                                                 mesh->is_using_colors);
+        }
+    }
+    output->arena = new MeshArena();
+    output->arena->Reserve(storage_size);
+
+    for (unsigned int i = 0; i < groups.size(); ++i) {
+        const std::vector<BatchSource> &sources = groups[i].sources;
+        unsigned int first = 0, batch = 0;
+        while (first < sources.size()) {
+            // Take as many sources as fit in the index range.
+            unsigned int last = first, vertex_number = 0;
+            while (last < sources.size() && vertex_number + sources[last].mesh->vertex_number <= STATIC_BATCH_MAX_VERTICES)
+                vertex_number += sources[last++].mesh->vertex_number;
+
+            Mesh *merged = MergeSources(&sources[first], last - first, output->arena);
+            char suffix[32];
+            sprintf(suffix, "_batch%u_%u", i, batch++);
+            merged->name = (merged->materials.size()? merged->materials[0].name: std::string("default")) + suffix;
+            output->meshes.push_back(merged);
+            first = last;
+        }
+    }
+
+    return output;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file static_batcher.h
+ * @brief Merges the static meshes of a scene into as few meshes as possible.
+ */
+#ifndef STATIC_BATCHER_H_INCLUDED
+#define STATIC_BATCHER_H_INCLUDED
+
+#include "model.h"
+
+/// Meshes with more vertices are not worth merging, they are already expensive enough to draw alone.
+#define STATIC_BATCH_MAX_MESH_VERTICES 4096
+/// Largest vertex count of a merged mesh, all indices must fit in an unsigned short.
+#define STATIC_BATCH_MAX_VERTICES 65536
+
+namespace core {
+
+    /**
+     * @brief Load time batching pass: static meshes sharing the same materials are merged into a
+     * combined mesh with their transformations applied, which turns thousands of small props into
+     * a handful of draw calls.
+     * @remarks A merged mesh is split whenever it would exceed STATIC_BATCH_MAX_VERTICES. Each merged
+     * mesh lists its sources in 'Mesh::ranges', so they can still be culled or picked individually,
+     * and holds their collision hulls in its own space.
+     * @remarks Meshes sharing their geometry with others are not merged, they stay shared.
+     */
+    class StaticBatcher
+    {
+    public:
+        /**
+         * @brief Builds the batched version of @a scene, which is left untouched.
+         * @param scene The hierarchy to batch.
+         * @param max_mesh_vertices Meshes with more vertices are kept as they are (sharing their
+         * geometry with @a scene), like the meshes whose geometry is shared.
+         * @return A new model: its meshes are the merged meshes (already in world space), its sub
+         * models hold copies of the dynamic models and of the meshes that were not merged, placed
+         * by their world transformation (under copies of their parents when it has a shear). The
+         * caller owns it.
+         */
+        static Model *Build(const Model &scene, unsigned int max_mesh_vertices = STATIC_BATCH_MAX_MESH_VERTICES);
+    };
+}
+
+#endif // STATIC_BATCHER_H_INCLUDED
@@ -0,0 +1,151 @@
+#include <windows.h>
+#include <gdiplus.h>
+#include <shlwapi.h>
+#include "texture_codec.h"
+#include "pak_archive.h"
+
+unsigned char *core::TextureCodec::Decode(Gdiplus::Bitmap &bitmap, int &width, int &height)
+{
+	width = bitmap.GetWidth();
+	height = bitmap.GetHeight();
+	Gdiplus::Rect *rect = new Gdiplus::Rect(0, 0, width, height);
+	Gdiplus::BitmapData *bitmapdata = new Gdiplus::BitmapData;
+	unsigned char *dst = NULL;
+
+	if (bitmap.LockBits(rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, bitmapdata) == 0) {
+        // Buffer that has the image data.
+        unsigned char *src = (unsigned char *)bitmapdata->Scan0;
+		int stride = bitmapdata->Stride;
+		// Buffer that will contain the copied image data.
+        dst = new unsigned char[width * height * 4];
+
+		// Copying the data to the destination buffer.
+		for (int j = 0; j < height; ++j) {
+			for (int i = 0; i < width; ++i) {
+				dst[(height - 1 - j) * (width * 4) + (i * 4) + 0] = src[j * stride + i * 4 + 2];
+				dst[(height - 1 - j) * (width * 4) + (i * 4) + 1] = src[j * stride + i * 4 + 1];
+				dst[(height - 1 - j) * (width * 4) + (i * 4) + 2] = src[j * stride + i * 4 + 0];
+				dst[(height - 1 - j) * (width * 4) + (i * 4) + 3] = src[j * stride + i * 4 + 3];
+			}
+		}
+
+		bitmap.UnlockBits(bitmapdata);
+	}
+
+	delete rect;
+	delete bitmapdata;
+	return dst;
+}
+
+unsigned char *core::TextureCodec::Decode(const char *data, size_t size, int &width, int &height)
+{
+    // GDI plus decodes from a stream, the memory is wrapped without touching the disk.
+    IStream *stream = SHCreateMemStream((const BYTE *)data, (UINT)size);
+    if (!stream)
+        return NULL;
+
+    unsigned char *buffer = NULL;
+    {
+        Gdiplus::Bitmap bitmap(stream);
+        buffer = Decode(bitmap, width, height);
+    }
+    stream->Release();
+    return buffer;
+}
+
+const unsigned char *core::TextureCodec::GetCookedPixels(const char *data, size_t size, int &width, int &height)
+{
+    if (size < sizeof(CookedTextureHeader))
+        return NULL;
+
+    const CookedTextureHeader *header = (const CookedTextureHeader *)data;
+    if (header->magic != COOKED_TEXTURE_MAGIC || header->version != COOKED_TEXTURE_VERSION ||
+        !header->width || !header->height || header->width > 65536 || header->height > 65536 ||
+        (unsigned long long)header->width * header->height * 4 > size - sizeof(CookedTextureHeader))
+        return NULL;
+
+    width = (int)header->width;
+    height = (int)header->height;
+    return (const unsigned char *)(data + sizeof(CookedTextureHeader));
+}
+
+bool core::TextureCodec::Locate(const std::string &path, const PakArchive *archive, const char *&data, size_t &size,
+                                std::string &file_path)
+{
+    std::basic_string<char>::size_type indicator = path.find_last_of("\\/") + 1;
+    std::string filename = path.substr(indicator);
+
+    data = NULL;
+    size = 0;
+    if (archive && (archive->Find(path, data, size) || archive->Find("assets\\textures\\textures\\" + filename, data, size)))
+        return true;
+
+	// If the file doesn't exist, we check in the default textures directory.
+    file_path = path;
+	if (!PathFileExists(file_path.c_str())) {
+		char directory[1000];
+		GetCurrentDirectory(1000, directory);
+		file_path = directory;
+		file_path += "\\assets\\textures\\textures\\";
+		file_path += filename;
+
+		// If the file still cannot be found return false.
+		if (!PathFileExists(file_path.c_str()))
+			return false;
+	}
+
+    return true;
+}
+
+bool core::TextureCodec::Load(const std::string &path, const PakArchive *archive, TextureImage &image)
+{
+    const char *data;
+    size_t size;
+    std::string file_path;
+    if (!Locate(path, archive, data, size, file_path))
+        return false;
+
+    image.path = path;
+    image.mapped_pixels = NULL;
+    image.storage.clear();
+
+    unsigned char *buffer = NULL;
+    if (data) {
+        // Cooked textures are used in place, anything else is decoded.
+        image.mapped_pixels = GetCookedPixels(data, size, image.width, image.height);
+        if (image.mapped_pixels)
+            return true;
+
+        buffer = Decode(data, size, image.width, image.height);
+    }
+    else {
+        // GDI plus works with Unicode/multi-byte strings.
+        WCHAR widepathbuffer[1000];
+        MultiByteToWideChar(CP_ACP, 0, file_path.c_str(), -1, widepathbuffer, 1000);
+        Gdiplus::Bitmap bitmap(widepathbuffer);
+        buffer = Decode(bitmap, image.width, image.height);
+    }
+
+    if (!buffer)
+        return false;
+
+    image.storage.assign(buffer, buffer + (size_t)image.width * image.height * 4);
+    delete [] buffer;
+    return true;
+}
+
+size_t core::TextureCodec::GetSourceSize(const std::string &path, const PakArchive *archive)
+{
+    const char *data;
+    size_t size;
+    std::string file_path;
+    if (!Locate(path, archive, data, size, file_path))
+        return 0;
+    if (data)
+        return size;
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesEx(file_path.c_str(), GetFileExInfoStandard, &attributes))
+        return 0;
+    return (size_t)attributes.nFileSizeLow + ((size_t)attributes.nFileSizeHigh << 16 << 16);
+}
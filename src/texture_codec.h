@@ -0,0 +1,114 @@
+/**
+ * @file texture_codec.h
+ * @brief Texture decoding and the cooked texture format.
+ */
+#ifndef TEXTURE_CODEC_H_INCLUDED
+#define TEXTURE_CODEC_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// Identifies a cooked texture ('PTEX' read as a little endian integer).
+#define COOKED_TEXTURE_MAGIC 0x58455450u
+/// Bumped whenever the layout of a cooked texture changes, older textures are decoded again.
+#define COOKED_TEXTURE_VERSION 1
+
+namespace Gdiplus {
+    class Bitmap;
+}
+
+namespace core {
+
+    class PakArchive;
+
+    /**
+     * @brief Header of a cooked texture, followed by the pixels: RGBA, one byte per component,
+     * rows bottom up (the layout OpenGL uploads as is).
+     */
+    class CookedTextureHeader
+    {
+    public:
+        unsigned int magic;
+        unsigned int version;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    /// A decoded texture, ready to be uploaded.
+    class TextureImage
+    {
+    public:
+        TextureImage(): width(0), height(0), mapped_pixels(NULL) {}
+
+        /// Returns the pixels: RGBA, one byte per component, rows bottom up.
+        const unsigned char *GetPixels(void) const
+        {
+            return mapped_pixels? mapped_pixels: (storage.empty()? NULL: &storage[0]);
+        }
+
+    public:
+        /// The path the texture was requested with, the renderer registers it under it.
+        std::string path;
+        int width;
+        int height;
+        /// Cooked textures point straight into the archive, which must outlive the image.
+        const unsigned char *mapped_pixels;
+        /// The decoded pixels otherwise.
+        std::vector<unsigned char> storage;
+    };
+
+    /**
+     * @brief Turns image files into the RGBA buffers the renderer uploads.
+     * @remarks Decoding goes through GDI plus, which must be started by the caller.
+     */
+    class TextureCodec
+    {
+    public:
+        /**
+         * @brief Given a GDI plus bitmap class, it returns the content as an RGBA buffer.
+         * @param bitmap The bitmap to get the data for.
+         * @param [out] width Will be filled with the width of the bitmap.
+         * @param [out] height Will be filled with the height of the bitmap.
+         * @todo Replace GDI plus code with native C libraries.
+         * @return NULL in case of failure, or an RGBA buffer (rows bottom up) to free with delete [].
+         */
+        static unsigned char *Decode(Gdiplus::Bitmap &bitmap, int &width, int &height);
+
+        /**
+         * @brief Decodes an image file (png, jpg, bmp...) held in memory.
+         * @return NULL in case of failure, or an RGBA buffer (rows bottom up) to free with delete [].
+         */
+        static unsigned char *Decode(const char *data, size_t size, int &width, int &height);
+
+        /**
+         * @brief Returns the pixels of a cooked texture held in memory, without any copy.
+         * @return NULL if @a data is not a valid cooked texture.
+         */
+        static const unsigned char *GetCookedPixels(const char *data, size_t size, int &width, int &height);
+
+        /**
+         * @brief Finds and decodes a texture, in @a archive first, then on disk. Either way the
+         * path is tried as is, then as a file name in the default textures directory.
+         * @param path The path of the texture.
+         * @param archive The archive to look in, can be NULL.
+         * @param [out] image The texture, cooked ones are not copied.
+         * @remarks Thread safe, so textures can be decoded on worker threads and uploaded later.
+         * @return False if the texture cannot be found or decoded.
+         */
+        static bool Load(const std::string &path, const PakArchive *archive, TextureImage &image);
+
+        /// Returns the size in bytes of the file 'Load' would read for @a path, 0 if there is none.
+        static size_t GetSourceSize(const std::string &path, const PakArchive *archive);
+
+    private:
+        /**
+         * @brief Resolves @a path to the archive data when it is archived, to a file otherwise.
+         * @return False if the texture cannot be found.
+         */
+        static bool Locate(const std::string &path, const PakArchive *archive, const char *&data, size_t &size,
+                           std::string &file_path);
+    };
+}
+
+#endif // TEXTURE_CODEC_H_INCLUDED
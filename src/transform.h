@@ -0,0 +1,179 @@
+/**
+ * @file transform.h
+ * @brief Transformation stored as a translation, a rotation and a scale.
+ */
+#ifndef TRANSFORM_H_INCLUDED
+#define TRANSFORM_H_INCLUDED
+
+#include <math.h>
+#include "matrix.h"
+#include "quaternion.h"
+
+/**
+ * Largest difference allowed between a matrix and its decomposition, relative to the longest column
+ * for the rotation and scale, to the largest translation for the translation.
+ */
+#define TRANSFORM_DECOMPOSE_TOLERANCE 1e-4f
+
+namespace math {
+
+    /**
+     * @brief Scales, then rotates, then translates: 48 bytes instead of the 64 of a 'Matrix4D', and
+     * interpolates without distortion. A storage form: hierarchies are composed as matrices (see
+     * 'DrawList::Record'), composing transforms is no faster than composing matrices and the
+     * result still needs 'ToMatrix4D' (see the bench).
+     * @remarks The scale can be non uniform, but composition and inversion are only exact when the
+     * scale of the parent (respectively of the transform inverted) is uniform: a non uniform scale
+     * followed by a rotation is a shear, which this form cannot hold.
+     * @remarks The rotation is a unit quaternion.
+     */
+    class Transform
+    {
+    public:
+        /// Identity.
+        constexpr Transform(): translation(0.f, 0.f, 0.f), rotation(), scale(1.f, 1.f, 1.f) {}
+        constexpr Transform(const Vector3D &_translation, const Quat &_rotation,
+                            const Vector3D &_scale = Vector3D(1.f, 1.f, 1.f)):
+            translation(_translation), rotation(_rotation), scale(_scale) {}
+
+        /**
+         * @brief Decomposes an affine matrix without shear: the scales are the lengths of the
+         * columns, a mirroring matrix gets a negative x scale.
+         */
+        static Transform FromMatrix4D(const Matrix4D &matrix)
+        {
+            Transform result;
+            result.translation = Vector3D(matrix.m03, matrix.m13, matrix.m23);
+
+            Vector3D x(matrix.m00, matrix.m10, matrix.m20), y(matrix.m01, matrix.m11, matrix.m21),
+                     z(matrix.m02, matrix.m12, matrix.m22);
+            // Precise lengths, the decomposition must not depend on MATH_FAST_MATH.
+            float sx = x.Length(PRECISE), sy = y.Length(PRECISE), sz = z.Length(PRECISE);
+            if (x.CrossProduct(y).DotProduct(z) < 0.f)
+                sx = -sx;
+            result.scale = Vector3D(sx, sy, sz);
+            if (sx == 0.f || sy == 0.f || sz == 0.f)
+                return result;
+
+            Matrix4D rotation;
+            rotation.m00 = x.x / sx; rotation.m01 = y.x / sy; rotation.m02 = z.x / sz;
+            rotation.m10 = x.y / sx; rotation.m11 = y.y / sy; rotation.m12 = z.y / sz;
+            rotation.m20 = x.z / sx; rotation.m21 = y.z / sy; rotation.m22 = z.z / sz;
+            // 'Quat::ToQuaternion' reads matrices transposed compared to 'Quat::ToMatrix4D'.
+            result.rotation = Quat::ToQuaternion(rotation.Transpose()).Normalized();
+            return result;
+        }
+
+        /**
+         * @brief Decomposes @a matrix like 'FromMatrix4D' into @a result, only if the decomposition
+         * is exact.
+         * @return false, leaving @a result as it was, if @a matrix is not affine or holds a shear: the
+         * recomposed matrix then differs by more than @a tolerance. The rotation and scale part is
+         * compared relative to its longest column and the translation relative to itself, so that a
+         * large translation does not hide a shear.
+         */
+        static bool TryFromMatrix4D(const Matrix4D &matrix, Transform &result, float tolerance = TRANSFORM_DECOMPOSE_TOLERANCE)
+        {
+            Transform decomposed = FromMatrix4D(matrix);
+            Matrix4D recomposed = decomposed.ToMatrix4D();
+            const float *expected = &matrix.m00, *actual = &recomposed.m00;
+
+            float longest_column = fmaxf(fabsf(decomposed.scale.x), fmaxf(fabsf(decomposed.scale.y), fabsf(decomposed.scale.z)));
+            float largest_translation = fmaxf(1.f, fmaxf(fabsf(matrix.m03), fmaxf(fabsf(matrix.m13), fabsf(matrix.m23))));
+            for (unsigned int i = 0; i < 16; ++i) {
+                unsigned int row = i / 4, column = i % 4;
+                float bound = tolerance;
+                if (row < 3)
+                    bound *= (column < 3)? longest_column: largest_translation;
+                if (!(fabsf(expected[i] - actual[i]) <= bound))
+                    return false;
+            }
+
+            result = decomposed;
+            return true;
+        }
+
+        /// Returns the matrix applying the scale, the rotation then the translation.
+        Matrix4D ToMatrix4D(void) const
+        {
+            Matrix4D matrix = rotation.ToMatrix4D();
+            simd::float4 factors = simd::Set(scale.x, scale.y, scale.z, 1.f);
+            for (unsigned int i = 0; i < 3; ++i)
+                matrix.SetRow(i, simd::Multiply(matrix.GetRow(i), factors));
+            matrix.m03 = translation.x;
+            matrix.m13 = translation.y;
+            matrix.m23 = translation.z;
+            return matrix;
+        }
+
+        /// Transforms a direction, the translation does not apply.
+        Vector3D TransformVector(const Vector3D &vec) const
+        {
+            return rotation.Rotate(Vector3D(simd::Multiply(vec.GetRegister(), simd::Set(scale.x, scale.y, scale.z, 1.f))));
+        }
+
+        Point3D TransformPoint(const Point3D &point) const
+        {
+            Vector3D moved = TransformVector(Vector3D(point.x, point.y, point.z)) + translation;
+            return Point3D(moved.x, moved.y, moved.z, point.w);
+        }
+
+        /// Returns the transform applying @a child, then this one (this one is the parent).
+        Transform operator *(const Transform &child) const
+        {
+            Vector3D child_translation = TransformVector(child.translation);
+            return Transform(child_translation + translation, rotation * child.rotation,
+                             Vector3D(simd::Multiply(scale.GetRegister(), child.scale.GetRegister())));
+        }
+
+        /// Returns the inverse transform, exact if the scale is uniform.
+        Transform Inverse(void) const
+        {
+            Transform inverse;
+            inverse.rotation = rotation.Conjugate();
+            inverse.scale = Vector3D(1.f / scale.x, 1.f / scale.y, 1.f / scale.z);
+            Vector3D moved = inverse.rotation.Rotate(translation);
+            inverse.translation = -Vector3D(simd::Multiply(moved.GetRegister(), inverse.scale.GetRegister()));
+            return inverse;
+        }
+
+        bool HasUniformScale(void) const
+        {
+            return scale.x == scale.y && scale.y == scale.z;
+        }
+
+        /// Interpolates from @a from to @a to by @a t, the rotation with 'Quat::Nlerp'.
+        static Transform Nlerp(const Transform &from, const Transform &to, float t)
+        {
+            return Transform(from.translation + (to.translation - from.translation) * t,
+                             Quat::Nlerp(from.rotation, to.rotation, t), from.scale + (to.scale - from.scale) * t);
+        }
+
+        /// Interpolates from @a from to @a to by @a t, the rotation with 'Quat::Slerp'.
+        static Transform Slerp(const Transform &from, const Transform &to, float t)
+        {
+            return Transform(from.translation + (to.translation - from.translation) * t,
+                             Quat::Slerp(from.rotation, to.rotation, t), from.scale + (to.scale - from.scale) * t);
+        }
+
+        /// Interpolates @a count pairs of transforms by @a t, for animation poses.
+        static void Nlerp(const Transform *from, const Transform *to, float t, Transform *destination, unsigned int count)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+                destination[i] = Nlerp(from[i], to[i], t);
+        }
+
+        static void Slerp(const Transform *from, const Transform *to, float t, Transform *destination, unsigned int count)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+                destination[i] = Slerp(from[i], to[i], t);
+        }
+
+    public:
+        Vector3D translation;
+        Quat rotation;
+        Vector3D scale;
+    };
+}
+
+#endif // TRANSFORM_H_INCLUDED
@@ -0,0 +1,159 @@
+#include <functional>
+#include "transform_batch.h"
+#include "job_system.h"
+
+/// Elements per job, smaller batches run on the calling thread.
+static const unsigned int POINT_GRAIN = 8192;
+static const unsigned int MATRIX_GRAIN = 2048;
+
+/// Calls @a body on [0, @a count), split across the workers when @a count is over @a grain.
+static void RunBatch(unsigned int count, unsigned int grain, const std::function<void(unsigned int, unsigned int)> &body)
+{
+    if (count <= grain)
+        body(0, count);
+    else
+        core::JobSystem::ParallelFor(0, count, grain, body);
+}
+
+/// The columns of a matrix, so that a transformation is 4 multiply-adds of broadcast components.
+class MatrixColumns
+{
+public:
+    MatrixColumns(const math::Matrix4D &matrix)
+    {
+        c0 = matrix.GetRow(0);
+        c1 = matrix.GetRow(1);
+        c2 = matrix.GetRow(2);
+        c3 = matrix.GetRow(3);
+        math::simd::Transpose(c0, c1, c2, c3);
+    }
+
+    /// Same summation order as 'Matrix4D * Point3D'.
+    math::simd::float4 Transform(math::simd::float4 v) const
+    {
+        math::simd::float4 result = math::simd::Multiply(c0, math::simd::Swizzle<0, 0, 0, 0>(v));
+        result = math::simd::Add(result, math::simd::Multiply(c1, math::simd::Swizzle<1, 1, 1, 1>(v)));
+        result = math::simd::Add(result, math::simd::Multiply(c2, math::simd::Swizzle<2, 2, 2, 2>(v)));
+        return math::simd::Add(result, math::simd::Multiply(c3, math::simd::Swizzle<3, 3, 3, 3>(v)));
+    }
+
+    /// Same as 'Transform' with w = 0.
+    math::simd::float4 TransformDirection(math::simd::float4 v) const
+    {
+        math::simd::float4 result = math::simd::Multiply(c0, math::simd::Swizzle<0, 0, 0, 0>(v));
+        result = math::simd::Add(result, math::simd::Multiply(c1, math::simd::Swizzle<1, 1, 1, 1>(v)));
+        return math::simd::Add(result, math::simd::Multiply(c2, math::simd::Swizzle<2, 2, 2, 2>(v)));
+    }
+
+private:
+    math::simd::float4 c0, c1, c2, c3;
+};
+
+/// Writes the first 3 lanes of @a value.
+static void Store3(float *destination, math::simd::float4 value)
+{
+    float lanes[4];
+    math::simd::Store(lanes, value);
+    destination[0] = lanes[0];
+    destination[1] = lanes[1];
+    destination[2] = lanes[2];
+}
+
+/// Renormalizes the non zero @a directions with one reciprocal square root estimate for the 4 of them, w is garbage.
+static void NormalizeFast(math::simd::float4 directions[4])
+{
+    math::simd::float4 x = directions[0], y = directions[1], z = directions[2], w = directions[3];
+    math::simd::Transpose(x, y, z, w);
+    math::simd::float4 length_sqr = math::simd::Add(math::simd::Multiply(x, x), math::simd::Multiply(y, y));
+    length_sqr = math::simd::Add(length_sqr, math::simd::Multiply(z, z));
+
+    // The estimate of 0 is infinite, zero directions are scaled by 0 instead.
+    float lengths_sqr[4], inverses[4];
+    math::simd::Store(lengths_sqr, length_sqr);
+    math::simd::Store(inverses, math::simd::ReciprocalSqrtFast(length_sqr));
+    for (unsigned int i = 0; i < 4; ++i)
+        inverses[i] = (lengths_sqr[i] > 0.f)? inverses[i]: 0.f;
+
+    math::simd::float4 inverse = math::simd::Load(inverses);
+    x = math::simd::Multiply(x, inverse);
+    y = math::simd::Multiply(y, inverse);
+    z = math::simd::Multiply(z, inverse);
+    math::simd::Transpose(x, y, z, w);
+    directions[0] = x;
+    directions[1] = y;
+    directions[2] = z;
+    directions[3] = w;
+}
+
+void math::TransformPoints(const Matrix4D &matrix, const float *source, unsigned int source_stride, float *destination,
+                           unsigned int destination_stride, unsigned int count)
+{
+    MatrixColumns columns(matrix);
+    RunBatch(count, POINT_GRAIN, [&](unsigned int first, unsigned int last) {
+        const float *s = source + (size_t)first * source_stride;
+        float *d = destination + (size_t)first * destination_stride;
+        for (unsigned int i = first; i < last; ++i, s += source_stride, d += destination_stride) {
+            simd::float4 point = (source_stride == 4)? simd::Load(s): simd::Set(s[0], s[1], s[2], 1.f);
+            point = columns.Transform(point);
+            if (destination_stride == 4)
+                simd::Store(d, point);
+            else
+                Store3(d, point);
+        }
+    });
+}
+
+void math::TransformDirections(const Matrix4D &matrix, const float *source, float *destination, unsigned int count,
+                               bool normalize, Precision precision)
+{
+    MatrixColumns columns(matrix);
+    RunBatch(count, POINT_GRAIN, [&](unsigned int first, unsigned int last) {
+        unsigned int i = first;
+
+        // 4 directions are loaded before any is stored, the arrays may be the same.
+        if (normalize && precision == FAST) {
+            for (; i + 4 <= last; i += 4) {
+                simd::float4 directions[4];
+                for (unsigned int j = 0; j < 4; ++j) {
+                    const float *s = source + (size_t)(i + j) * 3;
+                    directions[j] = columns.TransformDirection(simd::Set(s[0], s[1], s[2], 0.f));
+                }
+                NormalizeFast(directions);
+                for (unsigned int j = 0; j < 4; ++j)
+                    Store3(destination + (size_t)(i + j) * 3, directions[j]);
+            }
+        }
+
+        for (; i < last; ++i) {
+            const float *s = source + (size_t)i * 3;
+            Vector3D direction(columns.TransformDirection(simd::Set(s[0], s[1], s[2], 0.f)));
+            if (normalize && direction.LengthSquared() > 0.f)
+                direction.Normalize(precision);
+            Store3(destination + (size_t)i * 3, direction.GetRegister());
+        }
+    });
+}
+
+void math::MultiplyMatrices(const Matrix4D *left, const Matrix4D *right, Matrix4D *destination, unsigned int count)
+{
+    RunBatch(count, MATRIX_GRAIN, [&](unsigned int first, unsigned int last) {
+        for (unsigned int i = first; i < last; ++i)
+            destination[i] = left[i] * right[i];
+    });
+}
+
+void math::MultiplyMatrices(const Matrix4D &left, const Matrix4D *right, Matrix4D *destination, unsigned int count)
+{
+    RunBatch(count, MATRIX_GRAIN, [&](unsigned int first, unsigned int last) {
+        for (unsigned int i = first; i < last; ++i)
+            destination[i] = left * right[i];
+    });
+}
+
+void math::InverseTransposeMatrices(const Matrix4D *source, Matrix4D *destination, unsigned int count)
+{
+    RunBatch(count, MATRIX_GRAIN, [&](unsigned int first, unsigned int last) {
+        for (unsigned int i = first; i < last; ++i)
+            destination[i] = source[i].AffineInverse().Transpose();
+    });
+}
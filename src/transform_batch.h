@@ -0,0 +1,48 @@
+/**
+ * @file transform_batch.h
+ * @brief Transformations of whole arrays of points, directions and matrices.
+ */
+#ifndef TRANSFORM_BATCH_H_INCLUDED
+#define TRANSFORM_BATCH_H_INCLUDED
+
+#include "matrix.h"
+
+namespace math {
+
+    /**
+     * @brief Transforms @a count points by @a matrix.
+     * @param source_stride Floats per source point: 4 (the 'Mesh::vertices' layout) or 3, w is 1.
+     * @param destination_stride Floats per destination point, 4 or 3 (w is dropped).
+     * @remarks @a source and @a destination may be the same array if the strides match.
+     * @remarks Gives the same values as 'Matrix4D * Point3D' on each point.
+     */
+    void TransformPoints(const Matrix4D &matrix, const float *source, unsigned int source_stride, float *destination,
+                         unsigned int destination_stride, unsigned int count);
+
+    /**
+     * @brief Transforms @a count directions of 3 floats (the normal, tangent and bi-normal layout)
+     * by @a matrix, the translation is ignored.
+     * @param normalize Renormalizes the results of non zero length.
+     * @param precision Precision of the renormalization, see 'Precision'.
+     * @remarks @a source and @a destination may be the same array.
+     */
+    void TransformDirections(const Matrix4D &matrix, const float *source, float *destination, unsigned int count,
+                             bool normalize, Precision precision = DEFAULT_PRECISION);
+
+    /// Computes destination[i] = left[i] * right[i] for @a count matrices.
+    void MultiplyMatrices(const Matrix4D *left, const Matrix4D *right, Matrix4D *destination, unsigned int count);
+
+    /**
+     * @brief Computes destination[i] = left * right[i] for @a count matrices, the concatenation of
+     * a parent with its children.
+     */
+    void MultiplyMatrices(const Matrix4D &left, const Matrix4D *right, Matrix4D *destination, unsigned int count);
+
+    /**
+     * @brief Computes the normal matrices, the inverse transpose, of @a count affine matrices.
+     * @remarks @a source and @a destination may be the same array.
+     */
+    void InverseTransposeMatrices(const Matrix4D *source, Matrix4D *destination, unsigned int count);
+}
+
+#endif // TRANSFORM_BATCH_H_INCLUDED
@@ -0,0 +1,734 @@
+/**
+ * @file wide.h
+ * @brief Structure of arrays math types, N vectors, matrices or quaternions processed at once.
+ */
+#ifndef WIDE_H_INCLUDED
+#define WIDE_H_INCLUDED
+
+#include <math.h>
+#include "simd.h"
+#include "matrix.h"
+#include "quaternion.h"
+
+#if defined(MATH_SIMD_SSE) && (defined(__AVX__) || defined(__AVX512F__))
+#   include <immintrin.h>
+#endif
+
+/// Widest lane count the compiler targets, for kernels written once for every instruction set.
+#if defined(MATH_SIMD_SSE) && defined(__AVX512F__)
+#   define MATH_WIDE_LANES 16
+#elif defined(MATH_SIMD_SSE) && defined(__AVX__)
+#   define MATH_WIDE_LANES 8
+#else
+#   define MATH_WIDE_LANES 4
+#endif
+
+namespace math {
+
+    namespace simd {
+
+        /**
+         * @brief Operations on N floats, the portable version: plain loops the compiler is free to
+         * vectorize. Specialized below for the lane counts the target has registers for.
+         * @remarks Masks hold one flag per lane. 'Min' and 'Max' return @a b when a lane is NaN,
+         * like the SSE instructions.
+         */
+        template <int N>
+        class Lanes
+        {
+        public:
+            class Register
+            {
+            public:
+                float v[N];
+            };
+
+            class Mask
+            {
+            public:
+                bool v[N];
+            };
+
+            static Register Splat(float value)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = value;
+                return r;
+            }
+
+            static Register Load(const float *values)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = values[i];
+                return r;
+            }
+
+            static void Store(float *values, const Register &a)
+            {
+                for (int i = 0; i < N; ++i)
+                    values[i] = a.v[i];
+            }
+
+            static Register Add(const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = a.v[i] + b.v[i];
+                return r;
+            }
+
+            static Register Subtract(const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = a.v[i] - b.v[i];
+                return r;
+            }
+
+            static Register Multiply(const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = a.v[i] * b.v[i];
+                return r;
+            }
+
+            static Register Divide(const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = a.v[i] / b.v[i];
+                return r;
+            }
+
+            static Register Min(const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = (a.v[i] < b.v[i])? a.v[i]: b.v[i];
+                return r;
+            }
+
+            static Register Max(const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = (a.v[i] > b.v[i])? a.v[i]: b.v[i];
+                return r;
+            }
+
+            static Register Sqrt(const Register &a)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = sqrtf(a.v[i]);
+                return r;
+            }
+
+            static Register Negate(const Register &a)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = -a.v[i];
+                return r;
+            }
+
+            static Mask Less(const Register &a, const Register &b)
+            {
+                Mask m;
+                for (int i = 0; i < N; ++i)
+                    m.v[i] = a.v[i] < b.v[i];
+                return m;
+            }
+
+            static Mask LessEqual(const Register &a, const Register &b)
+            {
+                Mask m;
+                for (int i = 0; i < N; ++i)
+                    m.v[i] = a.v[i] <= b.v[i];
+                return m;
+            }
+
+            static Mask Equal(const Register &a, const Register &b)
+            {
+                Mask m;
+                for (int i = 0; i < N; ++i)
+                    m.v[i] = a.v[i] == b.v[i];
+                return m;
+            }
+
+            static Mask And(const Mask &a, const Mask &b)
+            {
+                Mask m;
+                for (int i = 0; i < N; ++i)
+                    m.v[i] = a.v[i] && b.v[i];
+                return m;
+            }
+
+            static Mask Or(const Mask &a, const Mask &b)
+            {
+                Mask m;
+                for (int i = 0; i < N; ++i)
+                    m.v[i] = a.v[i] || b.v[i];
+                return m;
+            }
+
+            static Mask Not(const Mask &a)
+            {
+                Mask m;
+                for (int i = 0; i < N; ++i)
+                    m.v[i] = !a.v[i];
+                return m;
+            }
+
+            /// Returns one bit per lane, lane 0 in the lowest bit.
+            static unsigned int GetBits(const Mask &a)
+            {
+                unsigned int bits = 0;
+                for (int i = 0; i < N; ++i)
+                    bits |= (a.v[i]? 1u: 0u) << i;
+                return bits;
+            }
+
+            /// Returns @a a in the lanes where @a m is set, @a b elsewhere.
+            static Register Select(const Mask &m, const Register &a, const Register &b)
+            {
+                Register r;
+                for (int i = 0; i < N; ++i)
+                    r.v[i] = m.v[i]? a.v[i]: b.v[i];
+                return r;
+            }
+        };
+
+#if defined(MATH_SIMD_SSE)
+        /// 4 lanes in an SSE register, masks are registers of all set or all clear lanes.
+        template <>
+        class Lanes<4>
+        {
+        public:
+            typedef __m128 Register;
+            typedef __m128 Mask;
+
+            static Register Splat(float value) { return _mm_set1_ps(value); }
+            static Register Load(const float *values) { return _mm_loadu_ps(values); }
+            static void Store(float *values, Register a) { _mm_storeu_ps(values, a); }
+            static Register Add(Register a, Register b) { return _mm_add_ps(a, b); }
+            static Register Subtract(Register a, Register b) { return _mm_sub_ps(a, b); }
+            static Register Multiply(Register a, Register b) { return _mm_mul_ps(a, b); }
+            static Register Divide(Register a, Register b) { return _mm_div_ps(a, b); }
+            static Register Min(Register a, Register b) { return _mm_min_ps(a, b); }
+            static Register Max(Register a, Register b) { return _mm_max_ps(a, b); }
+            static Register Sqrt(Register a) { return _mm_sqrt_ps(a); }
+            static Register Negate(Register a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+            static Mask Less(Register a, Register b) { return _mm_cmplt_ps(a, b); }
+            static Mask LessEqual(Register a, Register b) { return _mm_cmple_ps(a, b); }
+            static Mask Equal(Register a, Register b) { return _mm_cmpeq_ps(a, b); }
+            static Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+            static Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+            static Mask Not(Mask a) { return _mm_xor_ps(a, _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps())); }
+            static unsigned int GetBits(Mask a) { return (unsigned int)_mm_movemask_ps(a); }
+            static Register Select(Mask m, Register a, Register b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        };
+#endif
+
+#if defined(MATH_SIMD_SSE) && defined(__AVX__)
+        /// 8 lanes in an AVX register.
+        template <>
+        class Lanes<8>
+        {
+        public:
+            typedef __m256 Register;
+            typedef __m256 Mask;
+
+            static Register Splat(float value) { return _mm256_set1_ps(value); }
+            static Register Load(const float *values) { return _mm256_loadu_ps(values); }
+            static void Store(float *values, Register a) { _mm256_storeu_ps(values, a); }
+            static Register Add(Register a, Register b) { return _mm256_add_ps(a, b); }
+            static Register Subtract(Register a, Register b) { return _mm256_sub_ps(a, b); }
+            static Register Multiply(Register a, Register b) { return _mm256_mul_ps(a, b); }
+            static Register Divide(Register a, Register b) { return _mm256_div_ps(a, b); }
+            static Register Min(Register a, Register b) { return _mm256_min_ps(a, b); }
+            static Register Max(Register a, Register b) { return _mm256_max_ps(a, b); }
+            static Register Sqrt(Register a) { return _mm256_sqrt_ps(a); }
+            static Register Negate(Register a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.f)); }
+            static Mask Less(Register a, Register b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static Mask LessEqual(Register a, Register b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+            static Mask Equal(Register a, Register b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+            static Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+            static Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+            static Mask Not(Mask a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+            static unsigned int GetBits(Mask a) { return (unsigned int)_mm256_movemask_ps(a); }
+            static Register Select(Mask m, Register a, Register b) { return _mm256_blendv_ps(b, a, m); }
+        };
+#endif
+
+#if defined(MATH_SIMD_SSE) && defined(__AVX512F__)
+        /// 16 lanes in an AVX-512 register, masks are mask registers.
+        template <>
+        class Lanes<16>
+        {
+        public:
+            typedef __m512 Register;
+            typedef __mmask16 Mask;
+
+            static Register Splat(float value) { return _mm512_set1_ps(value); }
+            static Register Load(const float *values) { return _mm512_loadu_ps(values); }
+            static void Store(float *values, Register a) { _mm512_storeu_ps(values, a); }
+            static Register Add(Register a, Register b) { return _mm512_add_ps(a, b); }
+            static Register Subtract(Register a, Register b) { return _mm512_sub_ps(a, b); }
+            static Register Multiply(Register a, Register b) { return _mm512_mul_ps(a, b); }
+            static Register Divide(Register a, Register b) { return _mm512_div_ps(a, b); }
+            static Register Min(Register a, Register b) { return _mm512_min_ps(a, b); }
+            static Register Max(Register a, Register b) { return _mm512_max_ps(a, b); }
+            static Register Sqrt(Register a) { return _mm512_sqrt_ps(a); }
+
+            // The float xor needs AVX-512DQ, the sign is flipped with the integer one.
+            static Register Negate(Register a)
+            {
+                return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32((int)0x80000000)));
+            }
+
+            static Mask Less(Register a, Register b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+            static Mask LessEqual(Register a, Register b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+            static Mask Equal(Register a, Register b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+            static Mask And(Mask a, Mask b) { return (Mask)(a & b); }
+            static Mask Or(Mask a, Mask b) { return (Mask)(a | b); }
+            static Mask Not(Mask a) { return (Mask)~a; }
+            static unsigned int GetBits(Mask a) { return (unsigned int)a; }
+            static Register Select(Mask m, Register a, Register b) { return _mm512_mask_blend_ps(m, b, a); }
+        };
+#endif
+    }
+
+    template <int N> class FloatxN;
+
+    /// One flag per lane, the result of comparing 'FloatxN' values.
+    template <int N>
+    class MaskxN
+    {
+        typedef simd::Lanes<N> Ops;
+
+    public:
+        explicit MaskxN(typename Ops::Mask _value): value(_value) {}
+
+        MaskxN operator &(const MaskxN &mask) const { return MaskxN(Ops::And(value, mask.value)); }
+        MaskxN operator |(const MaskxN &mask) const { return MaskxN(Ops::Or(value, mask.value)); }
+        MaskxN operator !(void) const { return MaskxN(Ops::Not(value)); }
+
+        /// Returns one bit per lane, lane 0 in the lowest bit.
+        unsigned int GetBits(void) const
+        {
+            return Ops::GetBits(value);
+        }
+
+        /// Returns whether any lane is set.
+        bool Any(void) const
+        {
+            return GetBits() != 0;
+        }
+
+        /// Returns whether every lane is set.
+        bool All(void) const
+        {
+            return GetBits() == (1u << N) - 1;
+        }
+
+        typename Ops::Mask GetRegister(void) const
+        {
+            return value;
+        }
+
+    private:
+        typename Ops::Mask value;
+    };
+
+    /**
+     * @brief N floats, one per lane: the component type of the wide vectors.
+     * @remarks Arithmetic is per lane, with the same rounding as the scalar code as long as the
+     * compiler does not fuse multiply-adds (the default of /fp:precise). Reductions go through the
+     * lanes in order.
+     */
+    template <int N>
+    class FloatxN
+    {
+        typedef simd::Lanes<N> Ops;
+
+    public:
+        enum { LANES = N };
+
+        FloatxN(): value(Ops::Splat(0.f)) {}
+        /// Every lane set to @a scalar, lets scalars mix with wide values.
+        FloatxN(float scalar): value(Ops::Splat(scalar)) {}
+        explicit FloatxN(typename Ops::Register _value): value(_value) {}
+
+        /// Loads N contiguous floats, no alignment required.
+        static FloatxN Load(const float *values)
+        {
+            return FloatxN(Ops::Load(values));
+        }
+
+        void Store(float *values) const
+        {
+            Ops::Store(values, value);
+        }
+
+        float GetLane(unsigned int index) const
+        {
+            float values[N];
+            Store(values);
+            return values[index];
+        }
+
+        typename Ops::Register GetRegister(void) const
+        {
+            return value;
+        }
+
+        FloatxN operator +(const FloatxN &a) const { return FloatxN(Ops::Add(value, a.value)); }
+        FloatxN operator -(const FloatxN &a) const { return FloatxN(Ops::Subtract(value, a.value)); }
+        FloatxN operator *(const FloatxN &a) const { return FloatxN(Ops::Multiply(value, a.value)); }
+        FloatxN operator /(const FloatxN &a) const { return FloatxN(Ops::Divide(value, a.value)); }
+        FloatxN operator -(void) const { return FloatxN(Ops::Negate(value)); }
+
+        FloatxN &operator +=(const FloatxN &a) { value = Ops::Add(value, a.value); return *this; }
+        FloatxN &operator -=(const FloatxN &a) { value = Ops::Subtract(value, a.value); return *this; }
+        FloatxN &operator *=(const FloatxN &a) { value = Ops::Multiply(value, a.value); return *this; }
+
+        MaskxN<N> operator <(const FloatxN &a) const { return MaskxN<N>(Ops::Less(value, a.value)); }
+        MaskxN<N> operator <=(const FloatxN &a) const { return MaskxN<N>(Ops::LessEqual(value, a.value)); }
+        MaskxN<N> operator >(const FloatxN &a) const { return MaskxN<N>(Ops::Less(a.value, value)); }
+        MaskxN<N> operator >=(const FloatxN &a) const { return MaskxN<N>(Ops::LessEqual(a.value, value)); }
+        MaskxN<N> operator ==(const FloatxN &a) const { return MaskxN<N>(Ops::Equal(value, a.value)); }
+
+        /// Returns @a a in the lanes where @a mask is set, @a b elsewhere.
+        static FloatxN Select(const MaskxN<N> &mask, const FloatxN &a, const FloatxN &b)
+        {
+            return FloatxN(Ops::Select(mask.GetRegister(), a.value, b.value));
+        }
+
+        static FloatxN Min(const FloatxN &a, const FloatxN &b) { return FloatxN(Ops::Min(a.value, b.value)); }
+        static FloatxN Max(const FloatxN &a, const FloatxN &b) { return FloatxN(Ops::Max(a.value, b.value)); }
+        static FloatxN Sqrt(const FloatxN &a) { return FloatxN(Ops::Sqrt(a.value)); }
+
+        /// Returns the sum of the lanes.
+        float ReduceAdd(void) const
+        {
+            float values[N];
+            Store(values);
+            float sum = values[0];
+            for (int i = 1; i < N; ++i)
+                sum += values[i];
+            return sum;
+        }
+
+        /// Returns the smallest lane.
+        float ReduceMin(void) const
+        {
+            float values[N];
+            Store(values);
+            float minimum = values[0];
+            for (int i = 1; i < N; ++i)
+                minimum = (values[i] < minimum)? values[i]: minimum;
+            return minimum;
+        }
+
+        /// Returns the largest lane.
+        float ReduceMax(void) const
+        {
+            float values[N];
+            Store(values);
+            float maximum = values[0];
+            for (int i = 1; i < N; ++i)
+                maximum = (values[i] > maximum)? values[i]: maximum;
+            return maximum;
+        }
+
+    private:
+        typename Ops::Register value;
+    };
+
+    template <int N>
+    FloatxN<N> operator *(float scalar, const FloatxN<N> &a)
+    {
+        return FloatxN<N>(scalar) * a;
+    }
+
+    /// N 'Vector3D', one per lane, w is not carried.
+    template <int N>
+    class Vec3xN
+    {
+    public:
+        Vec3xN() {}
+        Vec3xN(const FloatxN<N> &_x, const FloatxN<N> &_y, const FloatxN<N> &_z): x(_x), y(_y), z(_z) {}
+        /// Every lane set to @a vec.
+        explicit Vec3xN(const Vector3D &vec): x(vec.x), y(vec.y), z(vec.z) {}
+
+        /**
+         * @brief Loads N vectors of 3 floats from an array of structures.
+         * @param stride Floats from a vector to the next, 3 for the normal layout, 4 for vertices.
+         */
+        static Vec3xN LoadAoS(const float *values, unsigned int stride)
+        {
+            float lanes[3][N];
+            for (int i = 0; i < N; ++i) {
+                lanes[0][i] = values[i * stride + 0];
+                lanes[1][i] = values[i * stride + 1];
+                lanes[2][i] = values[i * stride + 2];
+            }
+            return Vec3xN(FloatxN<N>::Load(lanes[0]), FloatxN<N>::Load(lanes[1]), FloatxN<N>::Load(lanes[2]));
+        }
+
+        /// Stores the N vectors in an array of structures, the floats past the 3rd are left as is.
+        void StoreAoS(float *values, unsigned int stride) const
+        {
+            float lanes[3][N];
+            x.Store(lanes[0]);
+            y.Store(lanes[1]);
+            z.Store(lanes[2]);
+            for (int i = 0; i < N; ++i) {
+                values[i * stride + 0] = lanes[0][i];
+                values[i * stride + 1] = lanes[1][i];
+                values[i * stride + 2] = lanes[2][i];
+            }
+        }
+
+        Vector3D GetLane(unsigned int index) const
+        {
+            return Vector3D(x.GetLane(index), y.GetLane(index), z.GetLane(index));
+        }
+
+        Vec3xN operator +(const Vec3xN &vec) const { return Vec3xN(x + vec.x, y + vec.y, z + vec.z); }
+        Vec3xN operator -(const Vec3xN &vec) const { return Vec3xN(x - vec.x, y - vec.y, z - vec.z); }
+        Vec3xN operator -(void) const { return Vec3xN(-x, -y, -z); }
+        Vec3xN operator *(const FloatxN<N> &scale) const { return Vec3xN(x * scale, y * scale, z * scale); }
+
+        Vec3xN &operator +=(const Vec3xN &vec) { x += vec.x; y += vec.y; z += vec.z; return *this; }
+        Vec3xN &operator -=(const Vec3xN &vec) { x -= vec.x; y -= vec.y; z -= vec.z; return *this; }
+        Vec3xN &operator *=(const FloatxN<N> &scale) { x *= scale; y *= scale; z *= scale; return *this; }
+
+        FloatxN<N> DotProduct(const Vec3xN &vec) const
+        {
+            return x * vec.x + y * vec.y + z * vec.z;
+        }
+
+        Vec3xN CrossProduct(const Vec3xN &vec) const
+        {
+            return Vec3xN(y * vec.z - z * vec.y, z * vec.x - x * vec.z, x * vec.y - y * vec.x);
+        }
+
+        FloatxN<N> Length(void) const
+        {
+            return FloatxN<N>::Sqrt(DotProduct(*this));
+        }
+
+        void Normalize(void)
+        {
+            FloatxN<N> length = Length();
+            x = x / length;
+            y = y / length;
+            z = z / length;
+        }
+
+        /// Returns @a a in the lanes where @a mask is set, @a b elsewhere.
+        static Vec3xN Select(const MaskxN<N> &mask, const Vec3xN &a, const Vec3xN &b)
+        {
+            return Vec3xN(FloatxN<N>::Select(mask, a.x, b.x), FloatxN<N>::Select(mask, a.y, b.y),
+                          FloatxN<N>::Select(mask, a.z, b.z));
+        }
+
+    public:
+        FloatxN<N> x, y, z;
+    };
+
+    /// N 'Matrix4D', one per lane, the element of row i and column j is m[i][j].
+    template <int N>
+    class Mat4xN
+    {
+    public:
+        /// Identity in every lane.
+        Mat4xN()
+        {
+            for (int i = 0; i < 4; ++i)
+                m[i][i] = 1.f;
+        }
+
+        /// Every lane set to @a matrix.
+        explicit Mat4xN(const Matrix4D &matrix)
+        {
+            const float *elements = &matrix.m00;
+            for (int i = 0; i < 16; ++i)
+                m[i / 4][i % 4] = elements[i];
+        }
+
+        /// Loads the N matrices at @a matrices.
+        static Mat4xN LoadAoS(const Matrix4D *matrices)
+        {
+            Mat4xN result;
+            float lanes[N];
+            for (int e = 0; e < 16; ++e) {
+                for (int i = 0; i < N; ++i)
+                    lanes[i] = (&matrices[i].m00)[e];
+                result.m[e / 4][e % 4] = FloatxN<N>::Load(lanes);
+            }
+            return result;
+        }
+
+        void StoreAoS(Matrix4D *matrices) const
+        {
+            float lanes[N];
+            for (int e = 0; e < 16; ++e) {
+                m[e / 4][e % 4].Store(lanes);
+                for (int i = 0; i < N; ++i)
+                    (&matrices[i].m00)[e] = lanes[i];
+            }
+        }
+
+        Matrix4D GetLane(unsigned int index) const
+        {
+            Matrix4D matrix;
+            for (int e = 0; e < 16; ++e)
+                (&matrix.m00)[e] = m[e / 4][e % 4].GetLane(index);
+            return matrix;
+        }
+
+        /// Same summation order as 'Matrix4D::operator *'.
+        Mat4xN operator *(const Mat4xN &matrix) const
+        {
+            Mat4xN result;
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j)
+                    result.m[i][j] = m[i][0] * matrix.m[0][j] + m[i][1] * matrix.m[1][j] + m[i][2] * matrix.m[2][j] +
+                                     m[i][3] * matrix.m[3][j];
+            }
+            return result;
+        }
+
+        /// Transforms points (w = 1), the projective w is dropped.
+        Vec3xN<N> TransformPoint(const Vec3xN<N> &point) const
+        {
+            return Vec3xN<N>(m[0][0] * point.x + m[0][1] * point.y + m[0][2] * point.z + m[0][3],
+                             m[1][0] * point.x + m[1][1] * point.y + m[1][2] * point.z + m[1][3],
+                             m[2][0] * point.x + m[2][1] * point.y + m[2][2] * point.z + m[2][3]);
+        }
+
+        /// Transforms directions (w = 0).
+        Vec3xN<N> TransformVector(const Vec3xN<N> &vec) const
+        {
+            return Vec3xN<N>(m[0][0] * vec.x + m[0][1] * vec.y + m[0][2] * vec.z,
+                             m[1][0] * vec.x + m[1][1] * vec.y + m[1][2] * vec.z,
+                             m[2][0] * vec.x + m[2][1] * vec.y + m[2][2] * vec.z);
+        }
+
+        Mat4xN Transpose(void) const
+        {
+            Mat4xN result;
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j)
+                    result.m[i][j] = m[j][i];
+            }
+            return result;
+        }
+
+    public:
+        FloatxN<N> m[4][4];
+    };
+
+    /// N 'Quat', one per lane.
+    template <int N>
+    class QuatxN
+    {
+    public:
+        /// Identity in every lane.
+        QuatxN(): s(1.f) {}
+        QuatxN(const FloatxN<N> &_s, const FloatxN<N> &_x, const FloatxN<N> &_y, const FloatxN<N> &_z):
+            s(_s), x(_x), y(_y), z(_z) {}
+        /// Every lane set to @a quat.
+        explicit QuatxN(const Quat &quat): s(quat.s), x(quat.x), y(quat.y), z(quat.z) {}
+
+        /// Loads the N quaternions at @a quats.
+        static QuatxN LoadAoS(const Quat *quats)
+        {
+            float lanes[4][N];
+            for (int i = 0; i < N; ++i) {
+                lanes[0][i] = quats[i].s;
+                lanes[1][i] = quats[i].x;
+                lanes[2][i] = quats[i].y;
+                lanes[3][i] = quats[i].z;
+            }
+            return QuatxN(FloatxN<N>::Load(lanes[0]), FloatxN<N>::Load(lanes[1]), FloatxN<N>::Load(lanes[2]),
+                          FloatxN<N>::Load(lanes[3]));
+        }
+
+        void StoreAoS(Quat *quats) const
+        {
+            for (int i = 0; i < N; ++i)
+                quats[i] = GetLane(i);
+        }
+
+        Quat GetLane(unsigned int index) const
+        {
+            return Quat(s.GetLane(index), x.GetLane(index), y.GetLane(index), z.GetLane(index));
+        }
+
+        QuatxN operator +(const QuatxN &quat) const
+        {
+            return QuatxN(s + quat.s, x + quat.x, y + quat.y, z + quat.z);
+        }
+
+        /// Same as 'Quat::operator *': s = s * s' - v.v', v = s * v' + s' * v + v x v'.
+        QuatxN operator *(const QuatxN &quat) const
+        {
+            Vec3xN<N> v1(x, y, z), v2(quat.x, quat.y, quat.z);
+            Vec3xN<N> v = v2 * s + v1 * quat.s + v1.CrossProduct(v2);
+            return QuatxN(s * quat.s - v1.DotProduct(v2), v.x, v.y, v.z);
+        }
+
+        QuatxN operator *(const FloatxN<N> &c) const
+        {
+            return QuatxN(s * c, x * c, y * c, z * c);
+        }
+
+        FloatxN<N> DotProduct(const QuatxN &quat) const
+        {
+            return s * quat.s + (x * quat.x + y * quat.y + z * quat.z);
+        }
+
+        FloatxN<N> Length(void) const
+        {
+            return FloatxN<N>::Sqrt(s * s + x * x + y * y + z * z);
+        }
+
+        QuatxN Inverse(void) const
+        {
+            FloatxN<N> l = s * s + x * x + y * y + z * z;
+            return QuatxN(s / l, -x / l, -y / l, -z / l);
+        }
+
+        /// The quaternions must be unitary, see 'Quat::Conjugate'.
+        QuatxN Conjugate(void) const
+        {
+            return QuatxN(s, -x, -y, -z);
+        }
+
+        /// Returns @a a in the lanes where @a mask is set, @a b elsewhere.
+        static QuatxN Select(const MaskxN<N> &mask, const QuatxN &a, const QuatxN &b)
+        {
+            return QuatxN(FloatxN<N>::Select(mask, a.s, b.s), FloatxN<N>::Select(mask, a.x, b.x),
+                          FloatxN<N>::Select(mask, a.y, b.y), FloatxN<N>::Select(mask, a.z, b.z));
+        }
+
+    public:
+        FloatxN<N> s, x, y, z;
+    };
+
+    /// The wide types at the widest lane count of the target.
+    typedef FloatxN<MATH_WIDE_LANES> FloatxW;
+    typedef MaskxN<MATH_WIDE_LANES> MaskxW;
+    typedef Vec3xN<MATH_WIDE_LANES> Vec3xW;
+    typedef Mat4xN<MATH_WIDE_LANES> Mat4xW;
+    typedef QuatxN<MATH_WIDE_LANES> QuatxW;
+}
+
+#endif // WIDE_H_INCLUDED